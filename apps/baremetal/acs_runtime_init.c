@@ -26,7 +26,6 @@
 
 extern uint64_t  g_el3_param_magic;
 extern uint64_t  g_el3_param_addr;
-extern rule_test_map_t rule_test_map[RULE_ID_SENTINEL];
 
 /* === Build-time module list support (ACS_ENABLED_MODULE_LIST) === */
 #if ACS_HAS_ENABLED_MODULE_LIST
@@ -36,22 +35,6 @@ const uint32_t acs_build_module_count =
 #endif
 
 #ifdef COMPILE_RB_EXE
-static bool
-acs_list_contains(const uint32_t *list, uint32_t count, uint32_t value)
-{
-  uint32_t i;
-
-  if (list == NULL || count == 0)
-      return false;
-
-  for (i = 0; i < count; i++) {
-      if (list[i] == value)
-          return true;
-  }
-
-  return false;
-}
-
 static uint32_t
 acs_clamp_level_for_arch(uint32_t requested_level)
 {
@@ -80,67 +63,6 @@ acs_clamp_level_for_arch(uint32_t requested_level)
 
   return requested_level;
 }
-
-bool
-acs_is_module_enabled(uint32_t module_base)
-{
-    const acs_run_request_t *ctx = acs_get_run_request();
-    RULE_ID_e rule;
-    /* Runtime / EL3 / CLI override has highest priority */
-    if (ctx->num_skip_modules)
-      if (acs_list_contains(ctx->skip_modules, ctx->num_skip_modules, module_base))
-        return false;
-
-    if (ctx->rule_count == 0 && ctx->num_modules == 0)
-      return true;  /* No overrides: enable everything */
-
-    if (ctx->num_modules) {
-        if (acs_list_contains(ctx->execute_modules, ctx->num_modules, module_base))
-          return true;
-    }
-
-    for (uint32_t i = 0; i < ctx->rule_count; i++)
-    {
-      rule = ctx->rule_list[i];
-
-      if (rule < 0 || rule >= RULE_ID_SENTINEL)
-        continue;
-
-      if (rule_test_map[rule].module_id == module_base)
-        return true;
-    }
-
-    return false;
-}
-#else
-bool
-acs_is_module_enabled(uint32_t module_base)
-{
-    uint32_t i;
-
-    /* Explicit module include list */
-    if (g_num_modules) {
-        for (i = 0; i < g_num_modules; i++) {
-            if (g_execute_modules[i] == module_base)
-                return true;
-        }
-    }
-
-    /* Explicit test list */
-    if (g_num_tests) {
-        for (i = 0; i < g_num_tests; i++) {
-            if ((g_execute_tests[i] >= module_base) &&
-                (g_execute_tests[i] < module_base + 100))
-                return true;
-        }
-    }
-
-    /* No filters: enable all */
-    if (g_num_modules == 0 && g_num_tests == 0)
-        return true;
-
-    return false;
-}
 #endif
 
 void
@@ -169,9 +91,13 @@ acs_load_execution_policy_defaults(acs_execution_policy_t *policy)
       policy->timeout_pass = defaults->timeout_pass;
       policy->timeout_fail = defaults->timeout_fail;
       policy->timer_timeout_us = defaults->timer_timeout_us;
+      policy->timeout_scale = defaults->timeout_scale;
       policy->crypto_support = defaults->crypto_support;
       policy->sys_last_lvl_cache = defaults->sys_last_lvl_cache;
       policy->el1skiptrap_mask = defaults->el1skiptrap_mask;
+      policy->pe_pool = defaults->pe_pool;
+      policy->pe_fanout = defaults->pe_fanout;
+      policy->pcie_pruned_scan = defaults->pcie_pruned_scan;
   }
 
   platform_defaults = acs_get_platform_execution_policy_defaults();
@@ -185,6 +111,9 @@ acs_load_execution_policy_defaults(acs_execution_policy_t *policy)
   policy->crypto_support = platform_defaults->crypto_support;
   policy->sys_last_lvl_cache = platform_defaults->sys_last_lvl_cache;
   policy->el1skiptrap_mask = platform_defaults->el1skiptrap_mask;
+  policy->pe_pool = platform_defaults->pe_pool;
+  policy->pe_fanout = platform_defaults->pe_fanout;
+  policy->pcie_pruned_scan = platform_defaults->pcie_pruned_scan;
 
   if (platform_defaults->timeout_pass != 0u)
       policy->timeout_pass = platform_defaults->timeout_pass;
@@ -192,6 +121,8 @@ acs_load_execution_policy_defaults(acs_execution_policy_t *policy)
       policy->timeout_fail = platform_defaults->timeout_fail;
   if (platform_defaults->timer_timeout_us != 0u)
       policy->timer_timeout_us = platform_defaults->timer_timeout_us;
+  if (platform_defaults->timeout_scale != 0u)
+      policy->timeout_scale = platform_defaults->timeout_scale;
 }
 
 void
@@ -24,7 +24,6 @@
 void acs_load_run_request_defaults(acs_run_request_t *ctx);
 void acs_load_execution_policy_defaults(acs_execution_policy_t *policy);
 void acs_apply_el3_params(acs_run_request_t *ctx, acs_execution_policy_t *policy);
-bool acs_is_module_enabled(uint32_t module_base);
 void acs_apply_compile_params(acs_run_request_t *ctx, acs_execution_policy_t *policy);
 
 #endif /* __ACS_RUNTIME_INIT_H__ */
@@ -244,6 +244,9 @@ ShellAppMainbsa()
     val_pe_context_save(AA64ReadSp(), (uint64_t)branch_label);
     val_pe_initialize_default_exception_handler(val_pe_default_esr);
 
+    /* Capture PE ID registers once for all PE tests */
+    if (acs_is_module_enabled(PE))
+        val_pe_id_snapshot_create();
 
     if ((ctx->rule_count > 0 && ctx->rule_list != NULL) || (ctx->arch_selection != ARCH_NONE)) {
             /* Merge arch rules if any, then apply CLI filters (-skip, -m, -skipmodule) */
@@ -252,6 +252,10 @@ ShellAppMainpcbsa(void)
     createSmbiosInfoTable();
     val_allocate_shared_mem();
 
+    /* Capture PE ID registers once for all PE tests */
+    if (acs_is_module_enabled(PE))
+        val_pe_id_snapshot_create();
+
 
     if ((ctx->rule_count > 0 && ctx->rule_list != NULL) || (ctx->arch_selection != ARCH_NONE)) {
         /* Merge arch rules if any, then apply CLI filters (-skip, -m, -skipmodule) */
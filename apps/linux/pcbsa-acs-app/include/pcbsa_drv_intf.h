@@ -33,6 +33,44 @@
 #define DRV_STATUS_AVAILABLE     0x10000000
 #define DRV_STATUS_PENDING       0x40000000
 
+#define PCBSA_IOCTL_MAGIC          'P'
+
+/*
+ * Command channel on /dev/pcbsa_acs.
+ * PCBSA_IOCTL_SUBMIT_CMD applies a command or queues it on the driver. Once the
+ * last queued command completes, the descriptor polls readable (POLLIN) and
+ * read() returns its status record, blocking until then. Driver messages are
+ * written to a ring mapped from offset 0 of the descriptor; POLLPRI is raised
+ * while it holds unread messages. Drivers without the channel fail the ioctls
+ * with ENOTTY and the app falls back to /proc/pcbsa.
+ */
+#define PCBSA_IOCTL_SUBMIT_CMD       _IOW(PCBSA_IOCTL_MAGIC, 0x02, pcbsa_drv_cmd_u_t)
+#define PCBSA_IOCTL_MSG_RING_INFO    _IOR(PCBSA_IOCTL_MAGIC, 0x03, pcbsa_msg_ring_info_u_t)
+
+typedef struct pcbsa_drv_cmd_u {
+    uint32_t api_num;
+    uint32_t num_pe;
+    uint32_t level;
+    uint32_t reserved;
+    uint64_t arg0;     /* status (DRV_STATUS_*) in a completion record */
+    uint64_t arg1;     /* result in a completion record */
+    uint64_t arg2;
+} pcbsa_drv_cmd_u_t;
+
+typedef struct pcbsa_msg_ring_info_u {
+    uint32_t map_size;  /* bytes to mmap, ring header included */
+    uint32_t reserved;
+} pcbsa_msg_ring_info_u_t;
+
+/* Head and tail are free running byte counts, data_size is a power of two */
+typedef struct pcbsa_msg_ring {
+    uint32_t head;      /* advanced by the driver as messages are written */
+    uint32_t tail;      /* advanced by the app as messages are printed */
+    uint32_t data_size;
+    uint32_t reserved;
+    char     data[];
+} pcbsa_msg_ring_t;
+
 
 /* Function Prototypes */
 
@@ -53,4 +91,6 @@ int call_drv_wait_for_completion(void);
 
 int read_from_proc_pcbsa_msg(void);
 
+void call_drv_close(void);
+
 #endif
@@ -18,20 +18,153 @@
 
 #include <stdio.h>
 #include <string.h>
-
+#include <stdbool.h>
 #include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "pcbsa_drv_intf.h"
 
+/* Status poll interval when the driver only offers /proc/pcbsa */
+#define PCBSA_DRV_PROC_POLL_US  1000
+
 typedef
-struct __PCBSA_DRV_PARMS__ {
+struct __PCBSA_DRV_PARMS__
+{
     unsigned int    api_num;
     unsigned int    num_pe;
     unsigned int    level;
     unsigned long   arg0;
     unsigned long   arg1;
     unsigned long   arg2;
-} pcbsa_drv_parms_t;
+}pcbsa_drv_parms_t;
+
+/* /dev/pcbsa_acs is opened once and kept for the whole run */
+static struct {
+    bool            opened;     /* open attempted */
+    int             fd;
+    bool            cmd_chan;   /* driver implements the command channel */
+    pcbsa_msg_ring_t *ring;
+    size_t          ring_map_size;
+} g_drv_chan = { .fd = -1 };
+
+static void
+drv_chan_open(void)
+{
+    pcbsa_msg_ring_info_u_t info = {0};
+    pcbsa_msg_ring_t *ring;
+
+    if (g_drv_chan.opened)
+        return;
+
+    g_drv_chan.opened = true;
+    g_drv_chan.fd = open("/dev/pcbsa_acs", O_RDWR | O_CLOEXEC);
+    if (g_drv_chan.fd < 0)
+        return;
+
+    /* Older drivers only take commands through /proc/pcbsa */
+    if (ioctl(g_drv_chan.fd, PCBSA_IOCTL_MSG_RING_INFO, &info) < 0)
+        return;
+
+    if (info.map_size <= sizeof(pcbsa_msg_ring_t))
+        return;
+
+    ring = mmap(NULL, info.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_drv_chan.fd, 0);
+    if (ring == MAP_FAILED) {
+        perror("mmap /dev/pcbsa_acs");
+        return;
+    }
+
+    if ((ring->data_size == 0) || (ring->data_size & (ring->data_size - 1)) ||
+        (ring->data_size > info.map_size - sizeof(pcbsa_msg_ring_t))) {
+        fprintf(stderr, "Error: invalid message ring size 0x%x\n", ring->data_size);
+        munmap(ring, info.map_size);
+        return;
+    }
+
+    g_drv_chan.ring = ring;
+    g_drv_chan.ring_map_size = info.map_size;
+    g_drv_chan.cmd_chan = true;
+}
+
+void
+call_drv_close(void)
+{
+    if (g_drv_chan.ring)
+        munmap(g_drv_chan.ring, g_drv_chan.ring_map_size);
 
+    if (g_drv_chan.fd >= 0)
+        close(g_drv_chan.fd);
+
+    memset(&g_drv_chan, 0, sizeof(g_drv_chan));
+    g_drv_chan.fd = -1;
+}
+
+/* Print the messages the driver has added to the ring since the last call */
+static void
+drv_msg_ring_drain(void)
+{
+    pcbsa_msg_ring_t *ring = g_drv_chan.ring;
+    uint32_t head, tail, off, len;
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    tail = ring->tail;
+
+    /* Driver lapped the reader, only the newest data_size bytes are intact */
+    if ((head - tail) > ring->data_size)
+        tail = head - ring->data_size;
+
+    while (tail != head) {
+        off = tail & (ring->data_size - 1);
+        len = head - tail;
+        if (len > ring->data_size - off)
+            len = ring->data_size - off;
+
+        fwrite(&ring->data[off], 1, len, stdout);
+        tail += len;
+    }
+
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    fflush(stdout);
+}
+
+static int
+drv_send_cmd(const pcbsa_drv_cmd_u_t *cmd)
+{
+    FILE             *fd = NULL;
+    pcbsa_drv_parms_t test_params;
+
+    drv_chan_open();
+    if (g_drv_chan.cmd_chan) {
+        if (ioctl(g_drv_chan.fd, PCBSA_IOCTL_SUBMIT_CMD, cmd) < 0) {
+            perror("ioctl PCBSA_IOCTL_SUBMIT_CMD");
+            return 1;
+        }
+        return 0;
+    }
+
+    fd = fopen("/proc/pcbsa", "rw+");
+    if (fd == NULL) {
+        printf("fopen failed\n");
+        return 1;
+    }
+
+    test_params.api_num  = cmd->api_num;
+    test_params.num_pe   = cmd->num_pe;
+    test_params.level    = cmd->level;
+    test_params.arg0     = cmd->arg0;
+    test_params.arg1     = cmd->arg1;
+    test_params.arg2     = cmd->arg2;
+
+    fwrite(&test_params, 1, sizeof(test_params), fd);
+
+    fclose(fd);
+
+    return 0;
+}
 
 int
 call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned long int *arg2)
@@ -59,16 +192,68 @@ call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned l
   return test_params.api_num;
 }
 
+static int
+drv_chan_wait_for_completion(void)
+{
+  struct pollfd pfd;
+  pcbsa_drv_cmd_u_t done;
+  ssize_t len;
+
+  pfd.fd = g_drv_chan.fd;
+  pfd.events = POLLIN | POLLPRI;
+
+  /* Sleep until the driver has messages or the command completes */
+  do {
+    pfd.revents = 0;
+    if (poll(&pfd, 1, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("poll /dev/pcbsa_acs");
+      return 1;
+    }
+
+    if (pfd.revents & POLLPRI)
+      drv_msg_ring_drain();
+
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+      fprintf(stderr, "Error: /dev/pcbsa_acs closed by the driver\n");
+      return 1;
+    }
+  } while (!(pfd.revents & POLLIN));
+
+  do {
+    len = read(g_drv_chan.fd, &done, sizeof(done));
+  } while ((len < 0) && (errno == EINTR));
+
+  if (len != sizeof(done)) {
+    perror("read /dev/pcbsa_acs");
+    return 1;
+  }
+
+  /* Messages written just before completion */
+  drv_msg_ring_drain();
+
+  return done.arg1;
+}
+
 int
-call_drv_wait_for_completion()
+call_drv_wait_for_completion(void)
 {
   unsigned long int arg0, arg1, arg2;
 
+  drv_chan_open();
+  if (g_drv_chan.cmd_chan)
+    return drv_chan_wait_for_completion();
+
   arg0 = DRV_STATUS_PENDING;
 
   while (arg0 == DRV_STATUS_PENDING) {
     call_drv_get_status(&arg0, &arg1, &arg2);
     read_from_proc_pcbsa_msg();
+
+    /* /proc/pcbsa has no completion event, poll without taking a CPU from the tests */
+    if (arg0 == DRV_STATUS_PENDING)
+      usleep(PCBSA_DRV_PROC_POLL_US);
   }
 
   return arg1;
@@ -78,25 +263,14 @@ call_drv_wait_for_completion()
 int
 call_drv_init_test_env(unsigned int print_level)
 {
-    FILE             *fd = NULL;
-    pcbsa_drv_parms_t test_params;
+    pcbsa_drv_cmd_u_t cmd = {0};
     int status = 0;
 
-    fd = fopen("/proc/pcbsa", "rw+");
+    cmd.api_num  = PCBSA_CREATE_INFO_TABLES;
+    cmd.arg1     = print_level;
 
-    if (fd == NULL)
-    {
-        printf("fopen failed\n");
+    if (drv_send_cmd(&cmd))
         return 1;
-    }
-
-    test_params.api_num  = PCBSA_CREATE_INFO_TABLES;
-    test_params.arg1     = print_level;
-    test_params.arg2     = 0;
-
-    fwrite(&test_params, 1, sizeof(test_params), fd);
-
-    fclose(fd);
 
     status = call_drv_wait_for_completion();
 
@@ -104,28 +278,18 @@ call_drv_init_test_env(unsigned int print_level)
 }
 
 int
-call_drv_clean_test_env()
+call_drv_clean_test_env(void)
 {
-    FILE             *fd = NULL;
-    pcbsa_drv_parms_t test_params;
+    pcbsa_drv_cmd_u_t cmd = {0};
 
-    fd = fopen("/proc/pcbsa", "rw+");
+    cmd.api_num  = PCBSA_FREE_INFO_TABLES;
 
-    if (fd == NULL)
-    {
-        printf("fopen failed\n");
+    if (drv_send_cmd(&cmd))
         return 1;
-    }
-
-    test_params.api_num  = PCBSA_FREE_INFO_TABLES;
-    test_params.arg1     = 0;
-    test_params.arg2     = 0;
 
-    fwrite(&test_params, 1, sizeof(test_params), fd);
-
-    fclose(fd);
+    /* Last command of the run */
+    call_drv_close();
 
-    call_drv_wait_for_completion();
     return 0;
 }
 
@@ -133,83 +297,61 @@ int
 call_drv_execute_test(unsigned int api_num, unsigned int num_pe,
   unsigned int level, unsigned int print_level, unsigned long int test_input)
 {
-    FILE             *fd = NULL;
-    pcbsa_drv_parms_t test_params;
+    pcbsa_drv_cmd_u_t cmd = {0};
 
-    fd = fopen("/proc/pcbsa", "rw+");
-
-    if (fd == NULL)
-    {
-        printf("fopen failed\n");
-        return 1;
-    }
-
-    test_params.api_num  = api_num;
-    test_params.num_pe   = num_pe;
-    test_params.level    = level;
-    test_params.arg0     = test_input;
-    test_params.arg1     = print_level;
-    test_params.arg2     = 0;
-
-    fwrite(&test_params, 1, sizeof(test_params), fd);
-
-    fclose(fd);
-    return 0;
+    cmd.api_num  = api_num;
+    cmd.num_pe   = num_pe;
+    cmd.level    = level;
+    cmd.arg0     = test_input;
+    cmd.arg1     = print_level;
+    cmd.arg2     = 0;
 
+    return drv_send_cmd(&cmd);
 }
 
 int
 call_update_skip_list(unsigned int api_num, uint32_t *p_skip_test_num)
 {
-    FILE             *fd = NULL;
-    pcbsa_drv_parms_t test_params;
-
-    fd = fopen("/proc/pcbsa", "rw+");
-
-    if (fd == NULL)
-    {
-        printf("fopen failed\n");
-        return 1;
-    }
-
-    test_params.api_num  = api_num;
-    test_params.num_pe   = 0;
-    test_params.level    = 0;
-    test_params.arg0     = p_skip_test_num[0];
-    test_params.arg1     = p_skip_test_num[1];
-    test_params.arg2     = p_skip_test_num[2];
-
-    fwrite(&test_params, 1, sizeof(test_params), fd);
+    pcbsa_drv_cmd_u_t cmd = {0};
 
-    fclose(fd);
-    return 0;
+    cmd.api_num  = api_num;
+    cmd.arg0     = p_skip_test_num[0];
+    cmd.arg1     = p_skip_test_num[1];
+    cmd.arg2     = p_skip_test_num[2];
 
+    return drv_send_cmd(&cmd);
 }
 
 typedef struct __PCBSA_MSG__ {
     char string[92];
     unsigned long data;
-} pcbsa_msg_parms_t;
+}pcbsa_msg_parms_t;
 
 int read_from_proc_pcbsa_msg(void)
 {
+
   char buf_msg[sizeof(pcbsa_msg_parms_t)];
 
   FILE  *fd = NULL;
-  pcbsa_msg_parms_t msg_params;
 
-  fd = fopen("/proc/pcbsa_msg", "r");
+  drv_chan_open();
+  if (g_drv_chan.cmd_chan) {
+    drv_msg_ring_drain();
+    return 0;
+  }
 
-  if (fd == NULL) {
+  fd = fopen("/proc/pcbsa_msg", "r");
+  if (NULL == fd) {
     printf("fopen failed\n");
     return 1;
   }
 
   /* Print Until buffer is empty */
-
-  while (fread(buf_msg, sizeof(buf_msg), 1, fd))
+  while(fread(buf_msg,sizeof(buf_msg),1,fd)){
     printf("%s", buf_msg);
+  }
 
   fclose(fd);
+
   return 0;
 }
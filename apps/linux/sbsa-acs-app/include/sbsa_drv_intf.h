@@ -17,6 +17,7 @@
 
 #ifndef __SBSA_DRV_INTF_H__
 #define __SBSA_DRV_INTF_H__
+#include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -50,6 +51,87 @@ typedef struct sbsa_array_update_u {
     uint64_t user_buf; /* userspace pointer to u32 buffer */
 } sbsa_array_update_u_t;
 
+/*
+ * Command channel on /dev/sbsa_acs.
+ * SBSA_IOCTL_SUBMIT_CMD applies a command or queues it on the driver. Once the
+ * last queued command completes, the descriptor polls readable (POLLIN) and
+ * read() returns its status record, blocking until then. Driver messages are
+ * written to a ring mapped from offset 0 of the descriptor; POLLPRI is raised
+ * while it holds unread messages. Drivers without the channel fail the ioctls
+ * with ENOTTY and the app falls back to /proc/sbsa.
+ */
+#define SBSA_IOCTL_SUBMIT_CMD       _IOW(SBSA_IOCTL_MAGIC, 0x02, sbsa_drv_cmd_u_t)
+#define SBSA_IOCTL_MSG_RING_INFO    _IOR(SBSA_IOCTL_MAGIC, 0x03, sbsa_msg_ring_info_u_t)
+
+typedef struct sbsa_drv_cmd_u {
+    uint32_t api_num;
+    uint32_t num_pe;
+    uint32_t level;
+    uint32_t reserved;
+    uint64_t arg0;     /* status (DRV_STATUS_*) in a completion record */
+    uint64_t arg1;     /* result in a completion record */
+    uint64_t arg2;
+} sbsa_drv_cmd_u_t;
+
+typedef struct sbsa_msg_ring_info_u {
+    uint32_t map_size;  /* bytes to mmap, ring header included */
+    uint32_t reserved;
+} sbsa_msg_ring_info_u_t;
+
+/*
+ * Head and tail are free running byte counts, data_size is a power of two.
+ * The result ring below uses the same layout.
+ */
+typedef struct sbsa_msg_ring {
+    uint32_t head;      /* advanced by the driver as messages are written */
+    uint32_t tail;      /* advanced by the app as messages are printed */
+    uint32_t data_size;
+    uint32_t reserved;
+    char     data[];
+} sbsa_msg_ring_t;
+
+/*
+ * Batched run on the command channel.
+ * SBSA_IOCTL_RUN_BATCH takes the run settings, rule list and skip list as one
+ * versioned blob and runs the whole selection, completing like a submitted
+ * command. The driver appends one sbsa_rule_result_u_t per executed rule to
+ * the result ring and raises POLLPRI while it holds unread records.
+ */
+#define SBSA_IOCTL_RUN_BATCH          _IOW(SBSA_IOCTL_MAGIC, 0x04, sbsa_batch_submit_u_t)
+#define SBSA_IOCTL_RESULT_RING_INFO   _IOR(SBSA_IOCTL_MAGIC, 0x05, sbsa_result_ring_info_u_t)
+
+#define SBSA_BATCH_VERSION            1U
+
+typedef struct sbsa_batch_hdr_u {
+    uint32_t version;            /* SBSA_BATCH_VERSION */
+    uint32_t size;               /* header and both lists, in bytes */
+    uint32_t print_level;
+    uint32_t level_filter_mode;
+    uint32_t level_value;
+    uint32_t sw_view[3];
+    uint32_t rule_count;         /* 0 runs the default rule list */
+    uint32_t skip_count;
+    uint32_t rule_ids[];         /* rule_count rule IDs then skip_count rule IDs */
+} sbsa_batch_hdr_u_t;
+
+typedef struct sbsa_batch_submit_u {
+    uint64_t user_buf;           /* userspace pointer to sbsa_batch_hdr_u_t */
+    uint32_t size;
+    uint32_t reserved;
+} sbsa_batch_submit_u_t;
+
+typedef struct sbsa_result_ring_info_u {
+    uint64_t map_offset;         /* mmap offset of the result ring */
+    uint32_t map_size;
+    uint32_t reserved;
+} sbsa_result_ring_info_u_t;
+
+typedef struct sbsa_rule_result_u {
+    uint32_t rule_id;
+    uint32_t status;             /* test state in [31:28], status code in [15:0] */
+    uint64_t time_ns;            /* rule execution time */
+} sbsa_rule_result_u_t;
+
 /* Function Prototypes */
 
 int
@@ -71,6 +153,13 @@ call_drv_wait_for_completion(void);
 
 int read_from_proc_sbsa_msg(void);
 
+void call_drv_close(void);
+
+/* Run a batch, writing one CSV line per rule to results if not NULL */
+int call_drv_run_batch(const sbsa_batch_hdr_u_t *batch, FILE *results);
+
+bool call_drv_batch_supported(void);
+
 /* Helper: send a u32 array to the driver via ioctl */
 int sbsa_send_array_u32(uint32_t hint, const uint32_t *arr, uint32_t count);
 
@@ -40,6 +40,10 @@ unsigned int  g_sw_view[3] = {1, 1, 1}; //Operating System, Hypervisor, Platform
 static RULE_ID_e g_skip_rule_buf[RULE_ID_LIST_MAX];
 static unsigned int g_skip_rule_count;
 
+/* Rule list parsed from -r, empty runs the default list */
+static RULE_ID_e g_rule_buf[RULE_ID_LIST_MAX];
+static unsigned int g_rule_count;
+
 /*  Helpers for rule parsing  */
 static int sizeof_char_ptr(const char *tok)
 {
@@ -97,6 +101,56 @@ cleanup_test_environment()
     call_drv_clean_test_env();
 }
 
+/* Hand the rule and skip lists to a driver without batched runs */
+static void
+send_rule_lists(void)
+{
+    if (g_rule_count > 0) {
+        if (sbsa_send_array_u32(RULE_LIST, (const uint32_t *)g_rule_buf, g_rule_count) != 0) {
+            fprintf(stderr, "Warning: failed to send rule list to driver\n");
+        }
+    }
+
+    if (g_skip_rule_count > 0) {
+        const uint32_t *u32_list = (const uint32_t *)&g_skip_rule_buf[0];
+        if (sbsa_send_array_u32(SKIP_RULE_LIST, u32_list, g_skip_rule_count) != 0) {
+            fprintf(stderr, "Warning: failed to send skip rule list to driver\n");
+        }
+    }
+}
+
+/* Submit the whole selection and its settings in a single batch */
+static int
+run_tests_batch(unsigned int print_level, uint32_t level_filter_mode, uint32_t level_value,
+                FILE *results)
+{
+    sbsa_batch_hdr_u_t *batch;
+    uint32_t size;
+    int status;
+
+    size = sizeof(*batch) + (g_rule_count + g_skip_rule_count) * sizeof(uint32_t);
+    batch = calloc(1, size);
+    if (!batch) {
+        fprintf(stderr, "Error: no memory for batch\n");
+        return -1;
+    }
+
+    batch->version = SBSA_BATCH_VERSION;
+    batch->size = size;
+    batch->print_level = print_level;
+    batch->level_filter_mode = level_filter_mode;
+    batch->level_value = level_value;
+    memcpy(batch->sw_view, g_sw_view, sizeof(batch->sw_view));
+    batch->rule_count = g_rule_count;
+    batch->skip_count = g_skip_rule_count;
+    memcpy(&batch->rule_ids[0], g_rule_buf, g_rule_count * sizeof(uint32_t));
+    memcpy(&batch->rule_ids[g_rule_count], g_skip_rule_buf, g_skip_rule_count * sizeof(uint32_t));
+
+    status = call_drv_run_batch(batch, results);
+    free(batch);
+    return status;
+}
+
 void print_help(){
     printf ("\nUsage: Sbsa [-v <n>] | [-l <n>] | [--only <n>] | [-r <rule_id>[,<rule_id>...]] | "
         "[--fr] | [--skip <rule_id>[,<rule_id>...]]\n"
@@ -110,6 +164,7 @@ void print_help(){
         "--fr    Run future requirement tests (FR); use without -l\n"
         "--skip  Rules to skip as comma-separated RULE IDs (e.g. B_PE_01,B_PE_02) [no spaces]\n"
         "--skip-dp-nic-ms Skip PCIe tests for DisplayPort, Network, Mass Storage devices and Unclassified devices\n"
+        "--results <file> Write per-rule results and timing as CSV\n"
     );
 }
 
@@ -124,6 +179,8 @@ main (int argc, char **argv)
     uint32_t level_filter_mode = LVL_FILTER_MAX;  /* LEVEL_FILTER_MODE_e */
     uint32_t level_value = SBSA_LEVEL_3;          /* Default SBSA level */
     const unsigned int num_skip = 3;
+    FILE *results_fp = NULL;
+    bool batch_run;
     struct option long_opt[] =
     {
       {"skip", required_argument, NULL, 'n'},
@@ -132,6 +189,7 @@ main (int argc, char **argv)
       {"only", required_argument, NULL, 'o'},
       {"fr", no_argument, NULL, 'f'},
       {"rules", required_argument, NULL, 'r'},
+      {"results", required_argument, NULL, 'j'},
       {NULL, 0, NULL, 0}
     };
 
@@ -183,10 +241,8 @@ main (int argc, char **argv)
          }
          free(arg);
          if (rule_count_tmp > 0) {
-             if (sbsa_send_array_u32(RULE_LIST, (const uint32_t *)rule_buf_tmp, rule_count_tmp)
-                 != 0) {
-                 fprintf(stderr, "Warning: failed to send rule list to driver\n");
-             }
+             memcpy(g_rule_buf, rule_buf_tmp, rule_count_tmp * sizeof(RULE_ID_e));
+             g_rule_count = rule_count_tmp;
          }
          break;
        }
@@ -214,15 +270,13 @@ main (int argc, char **argv)
              skip_list_append((RULE_ID_e)rid);
           }
          free(arg);
-         /* Send skip rule list to driver now that --skip parsing is complete */
-         if (g_skip_rule_count > 0) {
-             const uint32_t *u32_list = (const uint32_t *)&g_skip_rule_buf[0];
-             if (sbsa_send_array_u32(SKIP_RULE_LIST, u32_list, g_skip_rule_count) != 0) {
-                 fprintf(stderr, "Warning: failed to send skip rule list to driver\n");
-             }
-         }
          break;
        }
+       case 'j':
+         results_fp = fopen(optarg, "w");
+         if (!results_fp)
+             perror(optarg);
+         break;
        case '?':
          if (isprint (optopt))
            fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -244,6 +298,14 @@ main (int argc, char **argv)
 
     printf("(Print level is %2d)\n\n", print_level);
 
+    /* Older drivers take the rule lists ahead of the run */
+    batch_run = call_drv_batch_supported();
+    if (!batch_run) {
+        send_rule_lists();
+        if (results_fp)
+            fprintf(stderr, "Warning: driver does not report per-rule results\n");
+    }
+
     printf(" Gathering system information....\n");
     status = initialize_test_environment(print_level, pcie_skip_dp_nic_ms);
     if (status) {
@@ -252,8 +314,15 @@ main (int argc, char **argv)
     }
 
     /* Trigger rule-based run */
-    call_drv_execute_test(RUN_TESTS, 0, 0, print_level, 0, level_filter_mode, level_value);
-    (void)call_drv_wait_for_completion();
+    if (batch_run) {
+        (void)run_tests_batch(print_level, level_filter_mode, level_value, results_fp);
+    } else {
+        call_drv_execute_test(RUN_TESTS, 0, 0, print_level, 0, level_filter_mode, level_value);
+        (void)call_drv_wait_for_completion();
+    }
+
+    if (results_fp)
+        fclose(results_fp);
 
     printf("\n                    *** SBSA tests complete ***\n\n");
     cleanup_test_environment();
@@ -20,10 +20,20 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include "sbsa_drv_intf.h"
+#include "rule_based_execution_enum.h"
+
+/* Status poll interval when the driver only offers /proc/sbsa */
+#define SBSA_DRV_PROC_POLL_US  1000
+
+/* Rule ID string map (defined in val/src/rule_enum_string_map.c) */
+extern char *rule_id_string[RULE_ID_SENTINEL];
 
 typedef
 struct __SBSA_DRV_PARMS__
@@ -36,6 +46,211 @@ struct __SBSA_DRV_PARMS__
     unsigned long   arg2;
 }sbsa_drv_parms_t;
 
+/* /dev/sbsa_acs is opened once and kept for the whole run */
+static struct {
+    bool            opened;     /* open attempted */
+    int             fd;
+    int             open_err;
+    bool            cmd_chan;   /* driver implements the command channel */
+    sbsa_msg_ring_t *ring;
+    size_t          ring_map_size;
+    sbsa_msg_ring_t *results;    /* driver supports batched runs */
+    size_t          results_map_size;
+    FILE           *results_fp;
+} g_drv_chan = { .fd = -1 };
+
+/* Map a ring shared with the driver and check its header */
+static sbsa_msg_ring_t *
+drv_ring_map(off_t offset, uint32_t map_size, uint32_t align)
+{
+    sbsa_msg_ring_t *ring;
+
+    if (map_size <= sizeof(sbsa_msg_ring_t))
+        return NULL;
+
+    ring = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_drv_chan.fd, offset);
+    if (ring == MAP_FAILED) {
+        perror("mmap /dev/sbsa_acs");
+        return NULL;
+    }
+
+    if ((ring->data_size < align) || (ring->data_size & (ring->data_size - 1)) ||
+        (ring->data_size > map_size - sizeof(sbsa_msg_ring_t))) {
+        fprintf(stderr, "Error: invalid ring size 0x%x\n", ring->data_size);
+        munmap(ring, map_size);
+        return NULL;
+    }
+
+    return ring;
+}
+
+static void
+drv_chan_open(void)
+{
+    sbsa_msg_ring_info_u_t info = {0};
+    sbsa_result_ring_info_u_t result_info = {0};
+
+    if (g_drv_chan.opened)
+        return;
+
+    g_drv_chan.opened = true;
+    g_drv_chan.fd = open("/dev/sbsa_acs", O_RDWR | O_CLOEXEC);
+    if (g_drv_chan.fd < 0) {
+        g_drv_chan.open_err = errno;
+        return;
+    }
+
+    /* Older drivers only take commands through /proc/sbsa */
+    if (ioctl(g_drv_chan.fd, SBSA_IOCTL_MSG_RING_INFO, &info) < 0)
+        return;
+
+    g_drv_chan.ring = drv_ring_map(0, info.map_size, 1);
+    if (g_drv_chan.ring == NULL)
+        return;
+
+    g_drv_chan.ring_map_size = info.map_size;
+    g_drv_chan.cmd_chan = true;
+
+    /* Batched runs are optional on top of the command channel */
+    if (ioctl(g_drv_chan.fd, SBSA_IOCTL_RESULT_RING_INFO, &result_info) < 0)
+        return;
+
+    g_drv_chan.results = drv_ring_map((off_t)result_info.map_offset, result_info.map_size,
+                                      sizeof(sbsa_rule_result_u_t));
+    if (g_drv_chan.results)
+        g_drv_chan.results_map_size = result_info.map_size;
+}
+
+void
+call_drv_close(void)
+{
+    if (g_drv_chan.ring)
+        munmap(g_drv_chan.ring, g_drv_chan.ring_map_size);
+
+    if (g_drv_chan.results)
+        munmap(g_drv_chan.results, g_drv_chan.results_map_size);
+
+    if (g_drv_chan.fd >= 0)
+        close(g_drv_chan.fd);
+
+    memset(&g_drv_chan, 0, sizeof(g_drv_chan));
+    g_drv_chan.fd = -1;
+}
+
+/* Print the messages the driver has added to the ring since the last call */
+static void
+drv_msg_ring_drain(void)
+{
+    sbsa_msg_ring_t *ring = g_drv_chan.ring;
+    uint32_t head, tail, off, len;
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    tail = ring->tail;
+
+    /* Driver lapped the reader, only the newest data_size bytes are intact */
+    if ((head - tail) > ring->data_size)
+        tail = head - ring->data_size;
+
+    while (tail != head) {
+        off = tail & (ring->data_size - 1);
+        len = head - tail;
+        if (len > ring->data_size - off)
+            len = ring->data_size - off;
+
+        fwrite(&ring->data[off], 1, len, stdout);
+        tail += len;
+    }
+
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    fflush(stdout);
+}
+
+/* Test states as packed by val/include/val_status.h */
+static const char *
+drv_test_state_string(uint32_t status)
+{
+    switch ((status >> 28) & 0xF) {
+    case 0x4: return "PASSED";
+    case 0x5: return "PARTIAL_COVERAGE";
+    case 0x6: return "WARNING";
+    case 0x7: return "SKIPPED";
+    case 0x8: return "FAILED";
+    case 0x9: return "NOT_IMPLEMENTED";
+    case 0xA: return "PAL_NOT_SUPPORTED";
+    default:  return "UNKNOWN";
+    }
+}
+
+/* Consume the per-rule records the driver has added to the result ring */
+static void
+drv_result_ring_drain(void)
+{
+    sbsa_msg_ring_t *ring = g_drv_chan.results;
+    sbsa_rule_result_u_t rec;
+    const char *name;
+    uint32_t head, tail;
+
+    if (ring == NULL)
+        return;
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    tail = ring->tail;
+
+    if ((head - tail) > ring->data_size)
+        tail = head - ring->data_size;
+
+    /* Records are naturally aligned so none straddles the end of the ring */
+    while ((head - tail) >= sizeof(rec)) {
+        memcpy(&rec, &ring->data[tail & (ring->data_size - 1)], sizeof(rec));
+        tail += sizeof(rec);
+
+        if (g_drv_chan.results_fp == NULL)
+            continue;
+
+        name = (rec.rule_id < RULE_ID_SENTINEL) ? rule_id_string[rec.rule_id] : NULL;
+        fprintf(g_drv_chan.results_fp, "%s,%s,0x%x,%llu\n",
+                name ? name : "UNKNOWN", drv_test_state_string(rec.status),
+                rec.status & 0xFFFF, (unsigned long long)(rec.time_ns / 1000));
+    }
+
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+static int
+drv_send_cmd(const sbsa_drv_cmd_u_t *cmd)
+{
+    FILE             *fd = NULL;
+    sbsa_drv_parms_t test_params;
+
+    drv_chan_open();
+    if (g_drv_chan.cmd_chan) {
+        if (ioctl(g_drv_chan.fd, SBSA_IOCTL_SUBMIT_CMD, cmd) < 0) {
+            perror("ioctl SBSA_IOCTL_SUBMIT_CMD");
+            return 1;
+        }
+        return 0;
+    }
+
+    fd = fopen("/proc/sbsa", "rw+");
+    if (NULL == fd)
+    {
+        printf("fopen failed\n");
+        return 1;
+    }
+
+    test_params.api_num  = cmd->api_num;
+    test_params.num_pe   = cmd->num_pe;
+    test_params.level    = cmd->level;
+    test_params.arg0     = cmd->arg0;
+    test_params.arg1     = cmd->arg1;
+    test_params.arg2     = cmd->arg2;
+
+    fwrite(&test_params,1,sizeof(test_params),fd);
+
+    fclose(fd);
+
+    return 0;
+}
 
 int
 call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned long int *arg2)
@@ -65,16 +280,112 @@ call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned l
   return test_params.api_num;
 }
 
+static int
+drv_chan_wait_for_completion(void)
+{
+  struct pollfd pfd;
+  sbsa_drv_cmd_u_t done;
+  ssize_t len;
+
+  pfd.fd = g_drv_chan.fd;
+  pfd.events = POLLIN | POLLPRI;
+
+  /* Sleep until the driver has messages or the command completes */
+  do {
+    pfd.revents = 0;
+    if (poll(&pfd, 1, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("poll /dev/sbsa_acs");
+      return 1;
+    }
+
+    if (pfd.revents & POLLPRI) {
+      drv_msg_ring_drain();
+      drv_result_ring_drain();
+    }
+
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+      fprintf(stderr, "Error: /dev/sbsa_acs closed by the driver\n");
+      return 1;
+    }
+  } while (!(pfd.revents & POLLIN));
+
+  do {
+    len = read(g_drv_chan.fd, &done, sizeof(done));
+  } while ((len < 0) && (errno == EINTR));
+
+  if (len != sizeof(done)) {
+    perror("read /dev/sbsa_acs");
+    return 1;
+  }
+
+  /* Messages and results written just before completion */
+  drv_msg_ring_drain();
+  drv_result_ring_drain();
+
+  return done.arg1;
+}
+
+bool
+call_drv_batch_supported(void)
+{
+  drv_chan_open();
+  return g_drv_chan.results != NULL;
+}
+
+int
+call_drv_run_batch(const sbsa_batch_hdr_u_t *batch, FILE *results)
+{
+  sbsa_batch_submit_u_t submit = {0};
+  int status;
+
+  if (!call_drv_batch_supported())
+    return -1;
+
+  submit.user_buf = (uint64_t)(uintptr_t)batch;
+  submit.size = batch->size;
+
+  if (results)
+    fprintf(results, "rule,result,status_code,time_us\n");
+
+  /* Records left from an earlier batch are not part of this one */
+  drv_result_ring_drain();
+  g_drv_chan.results_fp = results;
+
+  if (ioctl(g_drv_chan.fd, SBSA_IOCTL_RUN_BATCH, &submit) < 0) {
+    perror("ioctl SBSA_IOCTL_RUN_BATCH");
+    g_drv_chan.results_fp = NULL;
+    return -1;
+  }
+
+  status = drv_chan_wait_for_completion();
+  g_drv_chan.results_fp = NULL;
+
+  if (results)
+    fflush(results);
+
+  return status;
+}
+
 int
 call_drv_wait_for_completion(void)
 {
   unsigned long int arg0, arg1, arg2;
 
+  drv_chan_open();
+  if (g_drv_chan.cmd_chan)
+    return drv_chan_wait_for_completion();
+
   arg0 = DRV_STATUS_PENDING;
 
   while (arg0 == DRV_STATUS_PENDING){
     call_drv_get_status(&arg0, &arg1, &arg2);
     read_from_proc_sbsa_msg();
+
+    /* /proc/sbsa has no completion event, poll without taking a CPU from the tests */
+    if (arg0 == DRV_STATUS_PENDING)
+      usleep(SBSA_DRV_PROC_POLL_US);
   }
 
   return arg1;
@@ -84,25 +395,15 @@ call_drv_wait_for_completion(void)
 int
 call_drv_init_test_env(unsigned int print_level, bool pcie_skip_dp_nic_ms)
 {
-    FILE             *fd = NULL;
-    sbsa_drv_parms_t test_params;
+    sbsa_drv_cmd_u_t cmd = {0};
     int status = 0;
 
-    fd = fopen("/proc/sbsa", "rw+");
+    cmd.api_num  = SBSA_CREATE_INFO_TABLES;
+    cmd.arg1     = print_level;
+    cmd.arg2     = pcie_skip_dp_nic_ms;
 
-    if (NULL == fd)
-    {
-        printf("fopen failed\n");
+    if (drv_send_cmd(&cmd))
         return 1;
-    }
-
-    test_params.api_num  = SBSA_CREATE_INFO_TABLES;
-    test_params.arg1     = print_level;
-    test_params.arg2     = pcie_skip_dp_nic_ms;
-
-    fwrite(&test_params,1,sizeof(test_params),fd);
-
-    fclose(fd);
 
     status = call_drv_wait_for_completion();
 
@@ -112,26 +413,20 @@ call_drv_init_test_env(unsigned int print_level, bool pcie_skip_dp_nic_ms)
 int
 call_drv_clean_test_env(void)
 {
-    FILE             *fd = NULL;
-    sbsa_drv_parms_t test_params;
+    sbsa_drv_cmd_u_t cmd = {0};
+    int status;
 
-    fd = fopen("/proc/sbsa", "rw+");
+    cmd.api_num  = SBSA_FREE_INFO_TABLES;
 
-    if (NULL == fd)
-    {
-        printf("fopen failed\n");
+    if (drv_send_cmd(&cmd))
         return 1;
-    }
-
-    test_params.api_num  = SBSA_FREE_INFO_TABLES;
-    test_params.arg1     = 0;
-    test_params.arg2     = 0;
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
+    status = call_drv_wait_for_completion();
 
-    fclose(fd);
+    /* Last command of the run */
+    call_drv_close();
 
-    return call_drv_wait_for_completion();
+    return status;
 }
 
 int
@@ -139,62 +434,36 @@ call_drv_execute_test(unsigned int api_num, unsigned int num_pe,
   unsigned int level, unsigned int print_level, unsigned long int test_input,
   uint32_t level_filter_mode, uint32_t level_value)
 {
-    FILE             *fd = NULL;
-    sbsa_drv_parms_t test_params;
-
-    fd = fopen("/proc/sbsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed\n");
-        return 1;
-    }
+    sbsa_drv_cmd_u_t cmd = {0};
 
-    test_params.api_num  = api_num;
-    test_params.num_pe   = num_pe;
-    test_params.level    = level;
-    test_params.arg0     = test_input;
-    test_params.arg1     = print_level;
-    test_params.arg2     = 0;
+    cmd.api_num  = api_num;
+    cmd.num_pe   = num_pe;
+    cmd.level    = level;
+    cmd.arg0     = test_input;
+    cmd.arg1     = print_level;
+    cmd.arg2     = 0;
 
     if (api_num == RUN_TESTS) {
         /* Pass desired level and filter mode to driver */
-        test_params.level = level_value;
-        test_params.arg0  = level_filter_mode;
-        test_params.arg1 = print_level;
+        cmd.level    = level_value;
+        cmd.arg0     = level_filter_mode;
+        cmd.arg1     = print_level;
     }
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
-
-    fclose(fd);
-    return 0;
+    return drv_send_cmd(&cmd);
 }
 
 int
 call_update_skip_list(unsigned int api_num, uint32_t *p_skip_test_num)
 {
-    FILE             *fd = NULL;
-    sbsa_drv_parms_t test_params;
-
-    fd = fopen("/proc/sbsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed\n");
-        return 1;
-    }
-
-    test_params.api_num  = api_num;
-    test_params.num_pe   = 0;
-    test_params.level    = 0;
-    test_params.arg0     = p_skip_test_num[0];
-    test_params.arg1     = p_skip_test_num[1];
-    test_params.arg2     = p_skip_test_num[2];
+    sbsa_drv_cmd_u_t cmd = {0};
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
+    cmd.api_num  = api_num;
+    cmd.arg0     = p_skip_test_num[0];
+    cmd.arg1     = p_skip_test_num[1];
+    cmd.arg2     = p_skip_test_num[2];
 
-    fclose(fd);
-    return 0;
+    return drv_send_cmd(&cmd);
 }
 
 typedef struct __SBSA_MSG__ {
@@ -208,10 +477,14 @@ int read_from_proc_sbsa_msg(void)
   char buf_msg[sizeof(sbsa_msg_parms_t)];
 
   FILE  *fd = NULL;
-  sbsa_msg_parms_t msg_params;
 
-  fd = fopen("/proc/sbsa_msg", "r");
+  drv_chan_open();
+  if (g_drv_chan.cmd_chan) {
+    drv_msg_ring_drain();
+    return 0;
+  }
 
+  fd = fopen("/proc/sbsa_msg", "r");
   if (NULL == fd) {
     printf("fopen failed\n");
     return 1;
@@ -223,12 +496,12 @@ int read_from_proc_sbsa_msg(void)
   }
 
   fclose(fd);
+
   return 0;
 }
 
 int sbsa_send_array_u32(uint32_t hint, const uint32_t *arr, uint32_t count)
 {
-    int fd = -1;
     sbsa_array_update_u_t up = {0};
 
     if (!arr)
@@ -239,9 +512,9 @@ int sbsa_send_array_u32(uint32_t hint, const uint32_t *arr, uint32_t count)
         return -1;
     }
 
-    fd = open("/dev/sbsa_acs", O_RDWR);
-    if (fd < 0) {
-        perror("open /dev/sbsa_acs");
+    drv_chan_open();
+    if (g_drv_chan.fd < 0) {
+        fprintf(stderr, "open /dev/sbsa_acs: %s\n", strerror(g_drv_chan.open_err));
         return -1;
     }
 
@@ -249,12 +522,10 @@ int sbsa_send_array_u32(uint32_t hint, const uint32_t *arr, uint32_t count)
     up.count = count;
     up.user_buf = (uint64_t)(uintptr_t)arr;
 
-    if (ioctl(fd, SBSA_IOCTL_UPDATE_ARRAY, &up) < 0) {
+    if (ioctl(g_drv_chan.fd, SBSA_IOCTL_UPDATE_ARRAY, &up) < 0) {
         perror("ioctl SBSA_IOCTL_UPDATE_ARRAY");
-        close(fd);
         return -1;
     }
 
-    close(fd);
     return 0;
 }
@@ -142,20 +142,18 @@ static VOID map_and_add_rule_token(
     for (i = 0; i < tlen; i++) wbuf[i] = start[i];
     wbuf[tlen] = L'\0';
 
-    /* Convert to ASCII for comparison with rule_id_string */
+    /* Convert to ASCII for lookup in rule_id_string */
     i = 0;
     for (; i < tlen && i < (sizeof(abuf) - 1); i++)
         abuf[i] = (CHAR8)(wbuf[i] & 0xFF);
     abuf[i] = '\0';
 
-    for (rid = 0; rid < RULE_ID_SENTINEL; rid++) {
-        if (rule_id_string[rid] &&
-                ascii_streq((CHAR8 *)rule_id_string[rid], abuf)) {
-            if (*count < capacity) {
-                list[(*count)++] = (RULE_ID_e)rid;
-            }
-            return;
+    rid = (UINT32)rule_id_lookup_by_name((char8_t *)abuf);
+    if (rid < RULE_ID_SENTINEL) {
+        if (*count < capacity) {
+            list[(*count)++] = (RULE_ID_e)rid;
         }
+        return;
     }
 
     /* Not found: print invalid once for visibility */
@@ -600,6 +598,19 @@ command_init (void)
               policy->timeout_pass, policy->timeout_fail);
     }
 
+    /* Parse -timeout_scale, percentage applied to VAL polling deadlines */
+    CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-timeout_scale");
+    if (CmdLineArg == NULL) {
+        policy->timeout_scale = DEADLINE_SCALE_DEFAULT;
+    } else {
+        policy->timeout_scale = (UINT32)StrDecimalToUintn(CmdLineArg);
+        if (policy->timeout_scale == 0) {
+            Print(L"Invalid -timeout_scale: provide a non-zero percentage\n");
+            return SHELL_INVALID_PARAMETER;
+        }
+        Print(L"Deadline scale: %d%%\n", policy->timeout_scale);
+    }
+
     /* Parse verbosity level */
     CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-v");
     if (CmdLineArg == NULL) {
@@ -616,6 +627,17 @@ command_init (void)
         }
     }
 
+    /* Console verbosity, only narrows console output when -f is used */
+    CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-cv");
+    if (CmdLineArg == NULL) {
+        policy->console_print_level = 0;
+    } else {
+        policy->console_print_level = StrDecimalToUintn(CmdLineArg);
+        if (policy->console_print_level > 5) {
+            policy->console_print_level = 0;
+        }
+    }
+
     if (ShellCommandLineGetFlag (ParamPackage, L"-mmio")) {
         policy->print_mmio = TRUE;
     } else {
@@ -675,6 +697,18 @@ command_init (void)
     if ((ShellCommandLineGetFlag (ParamPackage, L"-no_crypto_ext")))
         policy->crypto_support = FALSE;
 
+    /* Keep secondary PEs parked between multi-PE payloads */
+    if (ShellCommandLineGetFlag (ParamPackage, L"-pe_pool"))
+        policy->pe_pool = TRUE;
+
+    /* Launch multi-PE payloads through a tree of wake-ups */
+    if (ShellCommandLineGetFlag (ParamPackage, L"-pe_fanout"))
+        policy->pe_fanout = TRUE;
+
+    /* Build the PCIe BDF table by following the bridge hierarchy */
+    if (ShellCommandLineGetFlag (ParamPackage, L"-pcie_pruned_scan"))
+        policy->pcie_pruned_scan = TRUE;
+
 
     /* Options with Values: -r <comma-separated rule IDs or rules file> */
     if (ShellCommandLineGetFlag(ParamPackage, L"-r")) {
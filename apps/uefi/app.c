@@ -50,6 +50,7 @@ ShellAppMain (
     if (g_dtb_log_file_handle) {
       ShellCloseFile(&g_dtb_log_file_handle);
     }
+    val_log_flush();
     if (g_acs_log_file_handle) {
       ShellCloseFile(&g_acs_log_file_handle);
     }
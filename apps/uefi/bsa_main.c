@@ -30,6 +30,7 @@
 /* CLI parameter table for BSA ACS, for description refer HelpMsg */
 CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-cache", TypeFlag},
+    {L"-cv", TypeValue},
     {L"-dtb", TypeValue},
     {L"-el1skiptrap", TypeValue},
     {L"-f", TypeValue},
@@ -44,12 +45,16 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-only", TypeValue},
     {L"-os", TypeFlag},
     {L"-p2p", TypeFlag},
+    {L"-pcie_pruned_scan", TypeFlag},
+    {L"-pe_fanout", TypeFlag},
+    {L"-pe_pool", TypeFlag},
     {L"-ps", TypeFlag},
     {L"-r", TypeValue},
     {L"-skip", TypeValue},
     {L"-skip-dp-nic-ms", TypeFlag},
     {L"-skipmodule", TypeValue},
     {L"-timeout", TypeValue},
+    {L"-timeout_scale", TypeValue},
     {L"-v", TypeValue},
     {NULL, TypeMax}
 };
@@ -63,6 +68,8 @@ HelpMsg (VOID)
         "Options:\n"
         "-cache  Pass this flag to indicate that if the test system supports\n"
         "        PCIe address translation cache\n"
+        "-cv <n> Verbosity of the console prints when a log file is passed with -f\n"
+        "        The log file keeps the -v verbosity\n"
         "-dtb    Pass this flag to dump DTB file (Device Tree Blob) \n"
         "-el1skiptrap <list>\n"
         "        Skip specific EL1 register reads known to trap by the hypervisor.\n"
@@ -88,6 +95,15 @@ HelpMsg (VOID)
         "        Pass -hyp to run BSA Hypervisior software view tests.\n"
         "        Pass -ps  to run BSA Platform security software view tests.\n"
         "-p2p    Pass this flag to indicate that PCIe Hierarchy Supports Peer-to-Peer\n"
+        "-pcie_pruned_scan \n"
+        "        Discover PCIe functions by following the bridge hierarchy instead\n"
+        "        of probing every bus, device and function of each ECAM\n"
+        "-pe_fanout \n"
+        "        Wake secondary PEs through a tree of wake-ups on systems\n"
+        "        with 8 or more PEs instead of one at a time\n"
+        "-pe_pool \n"
+        "        Keep secondary PEs parked between tests instead of PSCI\n"
+        "        CPU_ON/CPU_OFF for every multi-PE payload\n"
         "-r      Run tests for passed comma-separated Rule IDs or a rules file\n"
         "        Examples: -r B_PE_01,B_PE_02,B_GIC_01\n"
         "                  -r rules.txt  (file may mix commas/newlines; lines \n"
@@ -102,6 +118,9 @@ HelpMsg (VOID)
         "-timeout <microseconds> \n"
         "        Set pass timeout (delay in microseconds) for wakeup & WD & timer tests (500us - 2sec)\n"
         "        Example: -timeout 2000 \n"
+        "-timeout_scale <percent> \n"
+        "        Scale every VAL polling deadline, 100 keeps the nominal values\n"
+        "        Example: -timeout_scale 400 on slow models \n"
         "-v <n>  Verbosity of the prints\n"
         "        1 prints all, 5 prints only the errors\n");
 }
@@ -198,6 +217,9 @@ execute_tests()
     createPeripheralInfoTable();
     createSmbiosInfoTable();
     val_allocate_shared_mem();
+    /* Capture PE ID registers once for all PE tests */
+    if (acs_is_module_enabled(PE))
+        val_pe_id_snapshot_create();
 
     FlushImage();
 
@@ -228,6 +250,7 @@ exit_acs:
         ShellCloseFile(&g_dtb_log_file_handle);
     }
 
+    val_log_flush();
     if (g_acs_log_file_handle) {
         ShellCloseFile(&g_acs_log_file_handle);
     }
@@ -342,6 +342,7 @@ execute_tests()
 
   val_print(INFO, "\n      *** DRTM tests complete. *** \n\n");
 
+  val_log_flush();
   if (g_acs_log_file_handle) {
     ShellCloseFile(&g_acs_log_file_handle);
   }
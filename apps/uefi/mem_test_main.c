@@ -726,6 +726,7 @@ execute_tests()
 
   Status = createPeInfoTable();
   if (Status) {
+      val_log_flush();
       if (g_acs_log_file_handle)
         ShellCloseFile(&g_acs_log_file_handle);
      return Status;
@@ -733,6 +734,7 @@ execute_tests()
 
   Status = createGicInfoTable();
   if (Status) {
+      val_log_flush();
       if (g_acs_log_file_handle)
         ShellCloseFile(&g_acs_log_file_handle);
       return Status;
@@ -776,6 +778,7 @@ print_test_status:
   val_print(ERROR, "\nLoad address of the image is: 0x%lx\n", (unsigned long)&_textbsa);
   mem_model_execute_tests(myImageHandle, mySystemTable);
 
+  val_log_flush();
   if (g_acs_log_file_handle) {
     ShellCloseFile(&g_acs_log_file_handle);
   }
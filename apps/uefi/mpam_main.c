@@ -463,6 +463,7 @@ print_test_status:
     val_print(ERROR, "  Tests Failed = %4d\n", g_acs_tests_fail);
     val_print(ERROR, "     --------------------------------------------------------- \n");
 
+    val_log_flush();
     if (g_acs_log_file_handle) {
         ShellCloseFile(&g_acs_log_file_handle);
     }
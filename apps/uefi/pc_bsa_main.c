@@ -30,6 +30,7 @@
 
 /* CLI parameter table for PCBSA ACS, for description refer HelpMsg */
 CONST SHELL_PARAM_ITEM ParamList[] = {
+    {L"-cv", TypeValue},
     {L"-el1skiptrap", TypeValue},
     {L"-f", TypeValue},
     {L"-fr", TypeValue},
@@ -39,11 +40,15 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-m", TypeValue},
     {L"-mmio", TypeFlag},
     {L"-only", TypeValue},
+    {L"-pcie_pruned_scan", TypeFlag},
+    {L"-pe_fanout", TypeFlag},
+    {L"-pe_pool", TypeFlag},
     {L"-r", TypeValue},
     {L"-skip", TypeValue},
     {L"-skip-dp-nic-ms", TypeFlag},
     {L"-skipmodule", TypeValue},
     {L"-timeout", TypeValue},
+    {L"-timeout_scale", TypeValue},
     {L"-v", TypeValue},
     {NULL, TypeMax}
 };
@@ -55,6 +60,8 @@ HelpMsg (VOID)
 {
     Print (L"\nUsage: PcBsa.efi [options]\n"
         "Options:\n"
+        "-cv <n> Verbosity of the console prints when a log file is passed with -f\n"
+        "        The log file keeps the -v verbosity\n"
         "-el1skiptrap <list>\n"
         "        Skip specific EL1 register reads known to trap by the hypervisor.\n"
         "        Tokens: cntpct, devmem, pmsidr\n"
@@ -68,6 +75,15 @@ HelpMsg (VOID)
         "                  TIMER, WATCHDOG, NIST, PCIE, MPAM, ETE, TPM, POWER_WAKEUP\n"
         "        Example: -m PE,GIC,PCIE\n"
         "-mmio   Pass this flag to enable pal_mmio_read/write prints, use with -v 1\n"
+        "-pcie_pruned_scan \n"
+        "        Discover PCIe functions by following the bridge hierarchy instead\n"
+        "        of probing every bus, device and function of each ECAM\n"
+        "-pe_fanout \n"
+        "        Wake secondary PEs through a tree of wake-ups on systems\n"
+        "        with 8 or more PEs instead of one at a time\n"
+        "-pe_pool \n"
+        "        Keep secondary PEs parked between tests instead of PSCI\n"
+        "        CPU_ON/CPU_OFF for every multi-PE payload\n"
         "-r      Run tests for passed comma-separated Rule IDs or a rules file\n"
         "        Examples: -r B_PE_01,B_PE_02,B_GIC_01\n"
         "                  -r rules.txt  (file may mix commas/newlines; lines \n"
@@ -84,6 +100,9 @@ HelpMsg (VOID)
         "-timeout <microseconds> \n"
         "        Set pass timeout (delay in microseconds) for wakeup & WD & timer tests (500us - 2sec)\n"
         "        Example: -timeout 2000 \n"
+        "-timeout_scale <percent> \n"
+        "        Scale every VAL polling deadline, 100 keeps the nominal values\n"
+        "        Example: -timeout_scale 400 on slow models \n"
         "-v <n>  Verbosity of the prints\n"
         "        1 prints all, 5 prints only the errors\n");
 }
@@ -185,6 +204,9 @@ execute_tests()
     createSratInfoTable();
     val_drtm_create_info_table();
     val_allocate_shared_mem();
+    /* Capture PE ID registers once for all PE tests */
+    if (acs_is_module_enabled(PE))
+        val_pe_id_snapshot_create();
 
     FlushImage();
 
@@ -209,6 +231,7 @@ print_test_status:
 
 exit_acs:
     acs_release_run_request(ctx);
+    val_log_flush();
     if (g_acs_log_file_handle) {
         ShellCloseFile(&g_acs_log_file_handle);
     }
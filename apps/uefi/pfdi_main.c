@@ -148,6 +148,7 @@ exit_close:
   acs_release_run_request(ctx);
   freePfdiAcsMem();
 
+  val_log_flush();
   if (g_acs_log_file_handle) {
     ShellCloseFile(&g_acs_log_file_handle);
   }
@@ -738,6 +738,7 @@ execute_tests()
 
   Status = createPeInfoTable();
   if (Status) {
+      val_log_flush();
       if (g_acs_log_file_handle)
         ShellCloseFile(&g_acs_log_file_handle);
      return Status;
@@ -745,6 +746,7 @@ execute_tests()
 
   Status = createGicInfoTable();
   if (Status) {
+      val_log_flush();
       if (g_acs_log_file_handle)
         ShellCloseFile(&g_acs_log_file_handle);
       return Status;
@@ -792,6 +794,7 @@ print_test_status:
 
   val_print(ERROR, "\n      *** SBSA tests complete. Reset the system. ***\n\n");
 
+  val_log_flush();
   if (g_acs_log_file_handle) {
     ShellCloseFile(&g_acs_log_file_handle);
   }
@@ -33,6 +33,7 @@
 CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-a", TypeValue},
     {L"-cache", TypeFlag},
+    {L"-cv", TypeValue},
     {L"-dtb", TypeValue},
     {L"-el1skiptrap", TypeValue},
     {L"-f", TypeValue},
@@ -47,6 +48,9 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-only", TypeValue},
     {L"-os", TypeFlag},
     {L"-p2p", TypeFlag},
+    {L"-pcie_pruned_scan", TypeFlag},
+    {L"-pe_fanout", TypeFlag},
+    {L"-pe_pool", TypeFlag},
     {L"-ps", TypeFlag},
     {L"-r", TypeValue},
     {L"-skip", TypeValue},
@@ -54,6 +58,7 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-skipmodule", TypeValue},
     {L"-slc", TypeValue},
     {L"-timeout", TypeValue},
+    {L"-timeout_scale", TypeValue},
     {L"-v", TypeValue},
     {NULL, TypeMax}
     };
@@ -71,6 +76,8 @@ HelpMsg (VOID)
         "        -a pcbsa  Use full PC BSA rule checklist \n"
         "-cache  Pass this flag to indicate that if the test system supports\n"
         "        PCIe address translation cache\n"
+        "-cv <n> Verbosity of the console prints when a log file is passed with -f\n"
+        "        The log file keeps the -v verbosity\n"
         "-dtb    Pass this flag to dump DTB file (Device Tree Blob) \n"
         "-el1skiptrap <list>\n"
         "        Skip specific EL1 register reads known to trap by the hypervisor.\n"
@@ -106,6 +113,15 @@ HelpMsg (VOID)
         "        Pass -hyp to run BSA Hypervisior software view tests.\n"
         "        Pass -ps  to run BSA Platform security software view tests.\n"
         "-p2p    Pass this flag to indicate that PCIe Hierarchy Supports Peer-to-Peer\n"
+        "-pcie_pruned_scan \n"
+        "        Discover PCIe functions by following the bridge hierarchy instead\n"
+        "        of probing every bus, device and function of each ECAM\n"
+        "-pe_fanout \n"
+        "        Wake secondary PEs through a tree of wake-ups on systems\n"
+        "        with 8 or more PEs instead of one at a time\n"
+        "-pe_pool \n"
+        "        Keep secondary PEs parked between tests instead of PSCI\n"
+        "        CPU_ON/CPU_OFF for every multi-PE payload\n"
         "-r      Run tests for passed comma-separated Rule IDs or a rules file\n"
         "        Examples: -r B_PE_01,B_PE_02,B_GIC_01\n"
         "                  -r rules.txt  (file may mix commas/newlines; lines \n"
@@ -122,6 +138,9 @@ HelpMsg (VOID)
         "-timeout <microseconds> \n"
         "        Set pass timeout (delay in microseconds) for wakeup & WD & timer tests (500us - 2sec)\n"
         "        Example: -timeout 2000 \n"
+        "-timeout_scale <percent> \n"
+        "        Scale every VAL polling deadline, 100 keeps the nominal values\n"
+        "        Example: -timeout_scale 400 on slow models \n"
         "-v <n>  Verbosity of the prints\n"
         "        1 prints all, 5 prints only the errors\n"
     );
@@ -210,6 +229,7 @@ execute_tests()
     /* Create info tables */
     Status = createPeInfoTable();
     if (Status) {
+            val_log_flush();
             if (g_acs_log_file_handle)
                 ShellCloseFile(&g_acs_log_file_handle);
             if (g_dtb_log_file_handle)
@@ -219,6 +239,7 @@ execute_tests()
     }
     Status = createGicInfoTable();
     if (Status) {
+            val_log_flush();
             if (g_acs_log_file_handle)
                 ShellCloseFile(&g_acs_log_file_handle);
             if (g_dtb_log_file_handle)
@@ -249,6 +270,9 @@ execute_tests()
     createRasInfoTable();
     createTpm2InfoTable();
     val_allocate_shared_mem();
+    /* Capture PE ID registers once for all PE tests */
+    if (acs_is_module_enabled(PE))
+        val_pe_id_snapshot_create();
     FlushImage();
 
     if ((ctx->rule_count > 0 && ctx->rule_list != NULL) || (ctx->arch_selection != ARCH_NONE)) {
@@ -275,6 +299,7 @@ exit_acs:
     if (g_dtb_log_file_handle) {
         ShellCloseFile(&g_dtb_log_file_handle);
     }
+    val_log_flush();
     if (g_acs_log_file_handle) {
         ShellCloseFile(&g_acs_log_file_handle);
     }
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include "platform_override_fvp.h"
 #include "pal_status.h"
+#include "pal_mem_stats.h"
 #include "pal_execution_policy.h"
 #include "pal_print.h"
 
@@ -51,7 +52,8 @@ extern uint32_t g_enable_module;
 
 typedef struct mem_block_header {
   uint32_t                 signature;
-  uint32_t                 is_free;
+  uint16_t                 is_free;
+  uint16_t                 leak_scope; /* Leak scope that allocated the block, 0 if none */
   size_t                   size;
   uintptr_t                payload;
   struct mem_block_header  *prev_phys;
@@ -72,6 +74,9 @@ typedef struct {
                                                MEM_MIN_ALIGNMENT, \
                                                MEM_MIN_ALIGNMENT)
 
+/* Free blocks are kept in one list per power-of-two size class. */
+#define MEM_NUM_SIZE_CLASSES        64
+
 #define EL1SKIPTRAP_PMSIDR   (1u << 0)
 #define EL1SKIPTRAP_CNTPCT   (1u << 1)
 #define EL1SKIPTRAP_DEVMEM   (1u << 2)
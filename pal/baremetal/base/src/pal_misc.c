@@ -25,10 +25,16 @@
 extern void* g_sbsa_log_file_handle;
 uint8_t   *gSharedMemory;
 
-static MEM_BLOCK_HEADER *g_free_list;
+static MEM_BLOCK_HEADER *g_free_lists[MEM_NUM_SIZE_CLASSES];
+static uint64_t          g_free_class_map;
 static uint64_t          heap_base;
 static uint64_t          heap_top;
 static uint8_t           heap_init_done;
+static MEM_HEAP_STATS    g_heap_stats;
+static uint16_t          g_leak_scope_id;
+static uint16_t          g_leak_scope_open;
+static uint64_t          g_leak_scope_blocks;
+static uint64_t          g_leak_scope_bytes;
 
 /**
   @brief  Check whether a value is a power of two.
@@ -47,17 +53,182 @@ is_power_of_2(size_t value)
  * Heap allocator overview:
  * - The heap is represented as address-ordered blocks. Each block has a
  *   header at the start and a footer at the end.
- * - Free blocks are also linked through g_free_list, so allocation scans only
- *   currently free blocks.
- * - mem_alloc() finds a free block, places the payload after the header and
- *   hidden owner pointer, aligns the payload, and splits any usable remainder
- *   into a new free block.
+ * - Free blocks are kept in segregated lists, one per power-of-two size
+ *   class, with a bitmap of non-empty classes. Allocation starts at the class
+ *   of the smallest block that could hold the request and skips empty classes,
+ *   so it never walks blocks that are too small by a whole class.
+ * - mem_alloc() places the payload after the header and hidden owner pointer
+ *   and aligns it. When the alignment padding is large enough to hold a block,
+ *   as for page-aligned requests, it is split off as a free block in front, so
+ *   only the requested size is reserved. Any usable tail is split off too.
  * - mem_free() recovers the owning block from the hidden pointer stored before
  *   the payload, validates header/footer metadata, marks the block free, then
- *   coalesces adjacent free blocks before reinserting the final block into
- *   g_free_list.
+ *   coalesces adjacent free blocks before inserting the final block into its
+ *   size class list.
+ * - A leak scope tags the allocations made between pal_mem_leak_scope_begin()
+ *   and pal_mem_leak_scope_end(). Blocks carry the scope that allocated them,
+ *   so the blocks still live when the scope ends are counted in O(1). They are
+ *   only reported, never reclaimed.
  */
 
+/**
+  @brief  Return the size class of a block size.
+
+  @param  size  Block size in bytes, non-zero.
+
+  @return Size class, floor(log2(size)).
+**/
+static uint32_t
+mem_size_class(size_t size)
+{
+  return (uint32_t)(63 - __builtin_clzll((unsigned long long)size));
+}
+
+/**
+  @brief  Write the footer of a block from its header.
+
+  @param  block  Block whose size is final.
+
+  @return None
+**/
+static void
+mem_write_footer(MEM_BLOCK_HEADER *block)
+{
+  MEM_BLOCK_FOOTER *footer;
+
+  footer = (MEM_BLOCK_FOOTER *)((uintptr_t)block + block->size -
+                                sizeof(MEM_BLOCK_FOOTER));
+  footer->signature = MEM_FOOT_SIGNATURE;
+  footer->reserved = 0;
+  footer->size = block->size;
+}
+
+/**
+  @brief  Insert a free block at the head of its size class list.
+
+  @param  block  Free block.
+
+  @return None
+**/
+static void
+mem_free_list_insert(MEM_BLOCK_HEADER *block)
+{
+  uint32_t class = mem_size_class(block->size);
+
+  block->is_free = 1;
+  block->leak_scope = 0;
+  block->prev_free = NULL;
+  block->next_free = g_free_lists[class];
+  if (g_free_lists[class] != NULL) {
+    g_free_lists[class]->prev_free = block;
+  }
+  g_free_lists[class] = block;
+  g_free_class_map |= (1ULL << class);
+}
+
+/**
+  @brief  Remove a free block from its size class list.
+
+  @param  block  Free block.
+
+  @return None
+**/
+static void
+mem_free_list_remove(MEM_BLOCK_HEADER *block)
+{
+  uint32_t class = mem_size_class(block->size);
+
+  if (block->prev_free != NULL) {
+    block->prev_free->next_free = block->next_free;
+  } else {
+    g_free_lists[class] = block->next_free;
+    if (g_free_lists[class] == NULL) {
+      g_free_class_map &= ~(1ULL << class);
+    }
+  }
+
+  if (block->next_free != NULL) {
+    block->next_free->prev_free = block->prev_free;
+  }
+
+  block->prev_free = NULL;
+  block->next_free = NULL;
+}
+
+/**
+  @brief  Split a free block at an offset and return the upper part as a new
+          block. The lower part keeps the original header.
+
+  @param  block   Block to split, not on a free list.
+  @param  offset  Size of the lower part, at least MEM_MIN_BLOCK_SIZE.
+
+  @return Header of the upper part.
+**/
+static MEM_BLOCK_HEADER *
+mem_block_split(MEM_BLOCK_HEADER *block, size_t offset)
+{
+  MEM_BLOCK_HEADER *upper;
+
+  upper = (MEM_BLOCK_HEADER *)((uintptr_t)block + offset);
+  upper->signature = MEM_BLOCK_SIGNATURE;
+  upper->is_free = 1;
+  upper->leak_scope = 0;
+  upper->size = block->size - offset;
+  upper->payload = 0;
+  upper->prev_phys = block;
+  upper->next_phys = block->next_phys;
+  upper->prev_free = NULL;
+  upper->next_free = NULL;
+  if (upper->next_phys != NULL) {
+    upper->next_phys->prev_phys = upper;
+  }
+
+  block->size = offset;
+  block->next_phys = upper;
+  mem_write_footer(block);
+  mem_write_footer(upper);
+
+  return upper;
+}
+
+/**
+  @brief  Check whether a free block can hold an allocation.
+
+  @param  block      Free block.
+  @param  alignment  Payload alignment, a power of two.
+  @param  size       Payload size.
+  @param  lead       Bytes to split off in front of the block.
+  @param  payload    Payload address.
+
+  @return 1 if the allocation fits, 0 otherwise.
+**/
+static uint32_t
+mem_block_fit(MEM_BLOCK_HEADER *block, size_t alignment, size_t size,
+              size_t *lead, uintptr_t *payload)
+{
+  uintptr_t block_start = (uintptr_t)block;
+  uintptr_t block_end = block_start + block->size;
+  uintptr_t header;
+  uintptr_t used_end;
+
+  /*
+   * Payload is placed after the block header and a hidden back pointer.
+   * mem_free() uses that back pointer to recover the owning block.
+   */
+  *payload = ADDR_ALIGN(block_start + sizeof(MEM_BLOCK_HEADER) +
+                        sizeof(MEM_BLOCK_HEADER *), alignment);
+  header = *payload - sizeof(MEM_BLOCK_HEADER *) - sizeof(MEM_BLOCK_HEADER);
+
+  /* Padding too small for a block of its own stays inside the allocation. */
+  *lead = header - block_start;
+  if (*lead < MEM_MIN_BLOCK_SIZE) {
+    *lead = 0;
+  }
+
+  used_end = ADDR_ALIGN(*payload + size + sizeof(MEM_BLOCK_FOOTER), MEM_MIN_ALIGNMENT);
+  return used_end <= block_end;
+}
+
 /**
   @brief  Initialize the baremetal heap allocator state.
 
@@ -70,13 +241,17 @@ static uint32_t mem_alloc_init(void)
   uintptr_t aligned_heap_base;
   uintptr_t aligned_heap_top;
   size_t    heap_size;
-  MEM_BLOCK_FOOTER *footer;
+  MEM_BLOCK_HEADER *block;
+  uint32_t  class;
 
   aligned_heap_base = ADDR_ALIGN(PLATFORM_HEAP_REGION_BASE, MEM_MIN_ALIGNMENT);
   aligned_heap_top = (PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE) &
                      ~((uintptr_t)MEM_MIN_ALIGNMENT - 1U);
 
-  g_free_list = NULL;
+  for (class = 0; class < MEM_NUM_SIZE_CLASSES; class++) {
+    g_free_lists[class] = NULL;
+  }
+  g_free_class_map = 0;
   heap_base = aligned_heap_base;
   heap_top = aligned_heap_top;
 
@@ -89,21 +264,16 @@ static uint32_t mem_alloc_init(void)
     return HEAP_INIT_FAILED;
   }
 
-  g_free_list = (MEM_BLOCK_HEADER *)aligned_heap_base;
-  g_free_list->signature = MEM_BLOCK_SIGNATURE;
-  g_free_list->is_free = 1;
-  g_free_list->size = heap_size;
-  g_free_list->payload = 0;
-  g_free_list->prev_phys = NULL;
-  g_free_list->next_phys = NULL;
-  g_free_list->prev_free = NULL;
-  g_free_list->next_free = NULL;
-
-  footer = (MEM_BLOCK_FOOTER *)(aligned_heap_base + heap_size -
-                                sizeof(MEM_BLOCK_FOOTER));
-  footer->signature = MEM_FOOT_SIGNATURE;
-  footer->reserved = 0;
-  footer->size = g_free_list->size;
+  block = (MEM_BLOCK_HEADER *)aligned_heap_base;
+  block->signature = MEM_BLOCK_SIGNATURE;
+  block->size = heap_size;
+  block->payload = 0;
+  block->prev_phys = NULL;
+  block->next_phys = NULL;
+  mem_write_footer(block);
+  mem_free_list_insert(block);
+
+  g_heap_stats.heap_size = heap_size;
 
   heap_init_done = HEAP_INITIALISED;
   return HEAP_INIT_SUCCESS;
@@ -119,18 +289,14 @@ static uint32_t mem_alloc_init(void)
  **/
 void *mem_alloc(size_t alignment, size_t size)
 {
-  MEM_BLOCK_HEADER *block;
+  MEM_BLOCK_HEADER *block = NULL;
   MEM_BLOCK_HEADER *remainder;
-  MEM_BLOCK_FOOTER *footer;
+  size_t           min_block_size;
+  size_t           lead = 0;
   size_t           alloc_size;
-  size_t           remainder_size;
-  size_t           reserve_size;
-  uintptr_t        block_start;
-  uintptr_t        block_end;
-  uintptr_t        payload;
-  uintptr_t        payload_base;
-  uintptr_t        footer_end;
-  uintptr_t        used_end;
+  uintptr_t        payload = 0;
+  uint64_t         classes;
+  uint32_t         class;
 
   if ((size == 0) || !is_power_of_2(alignment)) {
     return NULL;
@@ -140,126 +306,87 @@ void *mem_alloc(size_t alignment, size_t size)
     alignment = MEM_MIN_ALIGNMENT;
   }
 
-  if (size > (SIZE_MAX - alignment)) {
-    return NULL;
-  }
-
-  reserve_size = size + alignment;
-
   if (heap_init_done != HEAP_INITIALISED) {
     if (mem_alloc_init() != HEAP_INIT_SUCCESS) {
       return NULL;
     }
   }
 
-  for (block = g_free_list; block != NULL; block = block->next_free) {
-    block_start = (uintptr_t)block;
-    if (block->size > (UINTPTR_MAX - block_start)) {
-      continue;
-    }
-
-    block_end = block_start + block->size;
-
-    /*
-     * Payload is placed after the block header and a hidden back pointer.
-     * mem_free() uses that back pointer to recover the owning block.
-     */
-    if ((block_start > (UINTPTR_MAX - sizeof(MEM_BLOCK_HEADER))) ||
-        ((block_start + sizeof(MEM_BLOCK_HEADER)) >
-         (UINTPTR_MAX - sizeof(MEM_BLOCK_HEADER *)))) {
-      continue;
-    }
-
-    payload_base = block_start + sizeof(MEM_BLOCK_HEADER) +
-                   sizeof(MEM_BLOCK_HEADER *);
-    if (payload_base > (UINTPTR_MAX - (alignment - 1U))) {
-      continue;
-    }
-
-    payload = ADDR_ALIGN(payload_base, alignment);
-
-    if ((reserve_size > (UINTPTR_MAX - payload)) ||
-        ((payload + reserve_size) > (UINTPTR_MAX - sizeof(MEM_BLOCK_FOOTER)))) {
-      continue;
-    }
+  /* Requests larger than the heap would overflow the fit arithmetic below. */
+  if ((size > (heap_top - heap_base)) || (alignment > (heap_top - heap_base))) {
+    g_heap_stats.failed_allocs++;
+    return NULL;
+  }
 
-    footer_end = payload + reserve_size + sizeof(MEM_BLOCK_FOOTER);
-    if (footer_end > (UINTPTR_MAX - (MEM_MIN_ALIGNMENT - 1U))) {
-      continue;
+  /* No block below this size can hold the request, whatever its alignment. */
+  min_block_size = ADDR_ALIGN(sizeof(MEM_BLOCK_HEADER) + sizeof(MEM_BLOCK_HEADER *) +
+                              size + sizeof(MEM_BLOCK_FOOTER), MEM_MIN_ALIGNMENT);
+  class = mem_size_class(min_block_size);
+  classes = g_free_class_map & (~0ULL << class);
+
+  /*
+   * Blocks of the first candidate class may be smaller than the request and
+   * alignment padding may not fit, so every class is searched first-fit.
+   */
+  while ((classes != 0) && (block == NULL)) {
+    class = (uint32_t)__builtin_ctzll(classes);
+    classes &= classes - 1U;
+
+    for (block = g_free_lists[class]; block != NULL; block = block->next_free) {
+      if (mem_block_fit(block, alignment, size, &lead, &payload)) {
+        break;
+      }
     }
+  }
 
-    used_end = ADDR_ALIGN(footer_end, MEM_MIN_ALIGNMENT);
-    if (used_end > block_end) {
-      continue;
-    }
+  if (block == NULL) {
+    g_heap_stats.failed_allocs++;
+    return NULL;
+  }
 
-    alloc_size = used_end - block_start;
+  /* The selected free block is now owned by this allocation. */
+  mem_free_list_remove(block);
 
-    /* The selected free block is now owned by this allocation. */
-    if (block->prev_free != NULL) {
-      block->prev_free->next_free = block->next_free;
-    } else {
-      g_free_list = block->next_free;
-    }
+  /* Return the alignment padding in front of the payload to the heap. */
+  if (lead != 0) {
+    remainder = block;
+    block = mem_block_split(remainder, lead);
+    mem_free_list_insert(remainder);
+  }
 
-    if (block->next_free != NULL) {
-      block->next_free->prev_free = block->prev_free;
-    }
+  alloc_size = ADDR_ALIGN(payload + size + sizeof(MEM_BLOCK_FOOTER), MEM_MIN_ALIGNMENT) -
+               (uintptr_t)block;
 
-    block->prev_free = NULL;
-    block->next_free = NULL;
-
-    remainder_size = block->size - alloc_size;
-    if (remainder_size >= MEM_MIN_BLOCK_SIZE) {
-      /* Keep the unused tail as a free block for later allocations. */
-      remainder = (MEM_BLOCK_HEADER *)((uintptr_t)block + alloc_size);
-      remainder->signature = MEM_BLOCK_SIGNATURE;
-      remainder->is_free = 1;
-      remainder->size = remainder_size;
-      remainder->payload = 0;
-      remainder->prev_phys = block;
-      remainder->next_phys = block->next_phys;
-      remainder->prev_free = NULL;
-      remainder->next_free = NULL;
-      if (remainder->next_phys != NULL) {
-        remainder->next_phys->prev_phys = remainder;
-      }
+  /* Keep the unused tail as a free block for later allocations. */
+  if ((block->size - alloc_size) >= MEM_MIN_BLOCK_SIZE) {
+    remainder = mem_block_split(block, alloc_size);
+    mem_free_list_insert(remainder);
+  }
 
-      block->size = alloc_size;
-      block->next_phys = remainder;
+  block->payload = payload;
+  block->is_free = 0;
+  block->leak_scope = g_leak_scope_open ? g_leak_scope_id : 0;
+  block->prev_free = NULL;
+  block->next_free = NULL;
 
-      /* Footer is used to validate and coalesce the free block. */
-      footer = (MEM_BLOCK_FOOTER *)((uintptr_t)remainder + remainder->size -
-                                    sizeof(MEM_BLOCK_FOOTER));
-      footer->signature = MEM_FOOT_SIGNATURE;
-      footer->reserved = 0;
-      footer->size = remainder->size;
+  /* Store footer metadata for validation during free. */
+  mem_write_footer(block);
 
-      remainder->next_free = g_free_list;
-      if (g_free_list != NULL) {
-        g_free_list->prev_free = remainder;
-      }
-      g_free_list = remainder;
-    }
+  g_heap_stats.used_bytes += block->size;
+  g_heap_stats.live_blocks++;
+  g_heap_stats.total_allocs++;
+  if (g_heap_stats.used_bytes > g_heap_stats.peak_used_bytes) {
+    g_heap_stats.peak_used_bytes = g_heap_stats.used_bytes;
+  }
 
-    block->payload = payload;
-    block->is_free = 0;
-    block->prev_free = NULL;
-    block->next_free = NULL;
-
-    /* Store footer metadata for validation during free. */
-    footer = (MEM_BLOCK_FOOTER *)((uintptr_t)block + block->size -
-                                  sizeof(MEM_BLOCK_FOOTER));
-    footer->signature = MEM_FOOT_SIGNATURE;
-    footer->reserved = 0;
-    footer->size = block->size;
-
-    /* Store owning block immediately before the returned payload. */
-    ((MEM_BLOCK_HEADER **)payload)[-1] = block;
-    return (void *)payload;
+  if (block->leak_scope != 0) {
+    g_leak_scope_blocks++;
+    g_leak_scope_bytes += block->size;
   }
 
-  return NULL;
+  /* Store owning block immediately before the returned payload. */
+  ((MEM_BLOCK_HEADER **)payload)[-1] = block;
+  return (void *)payload;
 }
 
 /**
@@ -306,7 +433,7 @@ void mem_free(void *ptr)
     return;
   }
 
-  /* Header/footer agreement protects the free list from stale/corrupt input. */
+  /* Header/footer agreement protects the free lists from stale/corrupt input. */
   footer = (MEM_BLOCK_FOOTER *)((uintptr_t)block + block->size -
                                 sizeof(MEM_BLOCK_FOOTER));
   if ((footer->signature != MEM_FOOT_SIGNATURE) ||
@@ -318,29 +445,21 @@ void mem_free(void *ptr)
     return;
   }
 
-  block->payload = 0;
+  g_heap_stats.used_bytes -= block->size;
+  g_heap_stats.live_blocks--;
+  if (g_leak_scope_open && (block->leak_scope == g_leak_scope_id)) {
+    g_leak_scope_blocks--;
+    g_leak_scope_bytes -= block->size;
+  }
 
+  block->payload = 0;
   block->is_free = 1;
-  footer->signature = MEM_FOOT_SIGNATURE;
-  footer->reserved = 0;
-  footer->size = block->size;
 
   if ((block->prev_phys != NULL) && block->prev_phys->is_free) {
     prev = block->prev_phys;
 
-    /* Remove previous block from free list before merging with it. */
-    if (prev->prev_free != NULL) {
-      prev->prev_free->next_free = prev->next_free;
-    } else {
-      g_free_list = prev->next_free;
-    }
-
-    if (prev->next_free != NULL) {
-      prev->next_free->prev_free = prev->prev_free;
-    }
-
-    prev->prev_free = NULL;
-    prev->next_free = NULL;
+    /* Remove previous block from its free list before merging with it. */
+    mem_free_list_remove(prev);
 
     prev->size += block->size;
     prev->next_phys = block->next_phys;
@@ -348,51 +467,110 @@ void mem_free(void *ptr)
       prev->next_phys->prev_phys = prev;
     }
     block = prev;
-
-    footer = (MEM_BLOCK_FOOTER *)((uintptr_t)block + block->size -
-                                  sizeof(MEM_BLOCK_FOOTER));
-    footer->signature = MEM_FOOT_SIGNATURE;
-    footer->reserved = 0;
-    footer->size = block->size;
   }
 
   next = block->next_phys;
   if ((next != NULL) && next->is_free) {
-    /* Remove next block from free list before merging with it. */
-    if (next->prev_free != NULL) {
-      next->prev_free->next_free = next->next_free;
-    } else {
-      g_free_list = next->next_free;
-    }
-
-    if (next->next_free != NULL) {
-      next->next_free->prev_free = next->prev_free;
-    }
-
-    next->prev_free = NULL;
-    next->next_free = NULL;
+    /* Remove next block from its free list before merging with it. */
+    mem_free_list_remove(next);
 
     block->size += next->size;
     block->next_phys = next->next_phys;
     if (block->next_phys != NULL) {
       block->next_phys->prev_phys = block;
     }
+  }
+
+  /* Insert the final free/coalesced block into its size class list. */
+  mem_write_footer(block);
+  mem_free_list_insert(block);
+}
+
+/**
+  @brief  Begin a leak scope. Blocks allocated until the scope ends are
+          tagged with it, so the ones still live at the end are counted
+          without walking the heap. Scopes do not nest.
+
+  @param  None
+
+  @return Scope identifier, 0 if a scope is already open.
+**/
+uint32_t
+pal_mem_leak_scope_begin(void)
+{
+  if (g_leak_scope_open) {
+    return 0;
+  }
 
-    footer = (MEM_BLOCK_FOOTER *)((uintptr_t)block + block->size -
-                                  sizeof(MEM_BLOCK_FOOTER));
-    footer->signature = MEM_FOOT_SIGNATURE;
-    footer->reserved = 0;
-    footer->size = block->size;
+  /* Identifier 0 marks blocks allocated outside any scope. */
+  if (++g_leak_scope_id == 0) {
+    g_leak_scope_id = 1;
   }
 
-  /* Insert the final free/coalesced block at the head of the free list. */
-  block->is_free = 1;
-  block->prev_free = NULL;
-  block->next_free = g_free_list;
-  if (g_free_list != NULL) {
-    g_free_list->prev_free = block;
+  g_leak_scope_open = 1;
+  g_leak_scope_blocks = 0;
+  g_leak_scope_bytes = 0;
+  return g_leak_scope_id;
+}
+
+/**
+  @brief  End a leak scope begun by pal_mem_leak_scope_begin and report the
+          blocks allocated in it that are still live.
+
+          The blocks are left allocated: allocations made while a test runs
+          include state that outlives the test, such as driver tables
+          created on first use, so they cannot be freed on the owner's
+          behalf.
+
+  @param  scope         Identifier returned by pal_mem_leak_scope_begin.
+  @param  live_blocks   Number of scope blocks still allocated.
+  @param  live_bytes    Bytes held by those blocks, headers included.
+
+  @return None
+**/
+void
+pal_mem_leak_scope_end(uint32_t scope, uint64_t *live_blocks, uint64_t *live_bytes)
+{
+  *live_blocks = 0;
+  *live_bytes = 0;
+
+  if (!g_leak_scope_open || (scope != g_leak_scope_id)) {
+    return;
+  }
+
+  *live_blocks = g_leak_scope_blocks;
+  *live_bytes = g_leak_scope_bytes;
+  g_leak_scope_open = 0;
+}
+
+/**
+  @brief  Report heap usage and fragmentation.
+
+  @param  stats  Filled with the counters kept by mem_alloc/mem_free, and the
+                 number and largest size of the free blocks.
+
+  @return None
+**/
+void
+pal_mem_get_heap_stats(MEM_HEAP_STATS *stats)
+{
+  MEM_BLOCK_HEADER *block;
+  uint32_t         class;
+
+  *stats = g_heap_stats;
+  stats->free_bytes = 0;
+  stats->free_blocks = 0;
+  stats->largest_free_block = 0;
+
+  for (class = 0; class < MEM_NUM_SIZE_CLASSES; class++) {
+    for (block = g_free_lists[class]; block != NULL; block = block->next_free) {
+      stats->free_bytes += block->size;
+      stats->free_blocks++;
+      if (block->size > stats->largest_free_block) {
+        stats->largest_free_block = block->size;
+      }
+    }
   }
-  g_free_list = block;
 }
 
 #define get_num_va_args(_args, _lcount)             \
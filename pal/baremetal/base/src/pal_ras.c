@@ -25,23 +25,6 @@ extern const PLATFORM_OVERRIDE_RAS_NODE_INTERRUPT_INFO platform_ras_node_interru
 
 extern const PLATFORM_OVERRIDE_RAS2_INFO_TABLE platform_ras2_cfg;
 
-/**
-  @brief  Platform Defined way of Timeout/Wait loop
-
-  @param  count  - Timeout/Wait Multiplier.
-
-  @return None
-**/
-void
-pal_ras_wait_timeout(uint32_t count)
-{
-  uint32_t timeout = count * PLATFORM_BM_OVERRIDE_TIMEOUT_MEDIUM;
-
-  /* Wait Loop */
-  while (timeout > 0)
-    timeout--;
-}
-
 /**
   @brief  Display RAS info table details
 
@@ -111,14 +111,30 @@ acs_get_platform_run_request_defaults(void)
  * platform needs specific EL1 register accesses skipped:
  *   b0=EL1SKIPTRAP_PMSIDR, b1=EL1SKIPTRAP_CNTPCT, b2=EL1SKIPTRAP_DEVMEM.
  *   Example: el1skiptrap_mask = EL1SKIPTRAP_CNTPCT;
+ *
+ * pe_pool keeps secondary PEs parked in a WFE loop between multi-PE payloads
+ * instead of PSCI CPU_ON/CPU_OFF for every dispatch.
+ *
+ * pe_fanout wakes secondary PEs for multi-PE payloads through a tree of
+ * wake-ups, each woken PE waking further PEs, on systems with 8+ PEs.
+ *
+ * pcie_pruned_scan builds the PCIe BDF table by following the bridge
+ * hierarchy instead of probing every bus/device/function of each ECAM.
+ *
+ * timeout_scale is the percentage applied to every VAL polling deadline,
+ * 0 keeps the nominal deadlines (100%). Raise it for slow models.
  */
 static const acs_execution_policy_t g_platform_execution_policy = {
     .timeout_pass = PLATFORM_OVERRIDE_TIMEOUT,
     .timeout_fail = PLATFORM_OVERRIDE_FAILSAFE_TIMEOUT,
     .timer_timeout_us = PLATFORM_OVERRIDE_TIMER_TIMEOUT,
+    .timeout_scale = 0,
     .crypto_support = TRUE,
     .sys_last_lvl_cache = PLATFORM_OVERRRIDE_SLC,
     .el1skiptrap_mask = 0,
+    .pe_pool = FALSE,
+    .pe_fanout = FALSE,
+    .pcie_pruned_scan = FALSE,
 };
 
 const acs_execution_policy_t *
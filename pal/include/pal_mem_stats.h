@@ -0,0 +1,40 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef PAL_MEM_STATS_H_
+#define PAL_MEM_STATS_H_
+
+#include "acs_stdint.h"
+
+/* Baremetal heap statistics and leak scopes, exported through pal_interface.h */
+typedef struct {
+  uint64_t  heap_size;
+  uint64_t  used_bytes;          /* Bytes held by live blocks, headers included */
+  uint64_t  peak_used_bytes;
+  uint64_t  live_blocks;
+  uint64_t  total_allocs;
+  uint64_t  failed_allocs;
+  uint64_t  free_bytes;
+  uint64_t  free_blocks;
+  uint64_t  largest_free_block;
+} MEM_HEAP_STATS;
+
+uint32_t pal_mem_leak_scope_begin(void);
+void     pal_mem_leak_scope_end(uint32_t scope, uint64_t *live_blocks, uint64_t *live_bytes);
+void     pal_mem_get_heap_stats(MEM_HEAP_STATS *stats);
+
+#endif /* PAL_MEM_STATS_H_ */
@@ -245,6 +245,54 @@ pal_print(UINT64 data)
   }
 }
 
+/**
+  @brief  Sends a string to the output console only
+
+  @param  data  Address of a NULL terminated ASCII string
+
+  @return None
+**/
+VOID
+pal_print_console(UINT64 data)
+{
+  AsciiPrint("%a", (CHAR8 *)(UINTN)data);
+}
+
+/**
+  @brief  Reports whether a log file was opened with the -f option
+
+  @return 1 if a log file is open, 0 otherwise
+**/
+UINT32
+pal_log_file_present(VOID)
+{
+  return (g_acs_log_file_handle != NULL) ? 1 : 0;
+}
+
+/**
+  @brief  Writes a block of log data to the log file
+
+  @param  data  Address of the data to write
+  @param  size  Number of bytes to write
+
+  @return 0 on success, 1 if there is no log file or the write failed
+**/
+UINT32
+pal_log_file_write(UINT64 data, UINT32 size)
+{
+  UINTN      BufferSize = size;
+  EFI_STATUS Status;
+
+  if (g_acs_log_file_handle == NULL)
+    return 1;
+
+  Status = ShellWriteFile(g_acs_log_file_handle, &BufferSize, (VOID *)(UINTN)data);
+  if (EFI_ERROR(Status) || (BufferSize != size))
+    return 1;
+
+  return 0;
+}
+
 /**
   @brief  Emit a warning indicating the given PAL API is not implemented.
   @param  api_name  Name of the unimplemented API (typically __func__).
@@ -252,18 +300,12 @@ pal_print(UINT64 data)
 VOID
 pal_warn_not_implemented(const CHAR8 *api_name)
 {
-  CHAR8 Buffer[512];
-
   if (api_name == NULL)
     return;
 
-  AsciiSPrint(Buffer, sizeof(Buffer),
-              "\n       %a is not implemented."
-              "\n       Please implement the PAL function in test suite or"
-              "\n       conduct an offline review for this rule.\n",
-              api_name);
-
-  pal_print((UINT64)(UINTN)Buffer);
+  pal_print_msg(ACS_PRINT_WARN, "\n       %a is not implemented.", api_name);
+  pal_print_msg(ACS_PRINT_WARN, "\n       Please implement the PAL function in test suite or");
+  pal_print_msg(ACS_PRINT_WARN, "\n       conduct an offline review for this rule.\n");
 }
 
 /**
@@ -89,23 +89,6 @@ pal_ras_inject_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param)
   return PAL_STATUS_NOT_IMPLEMENTED;
 }
 
-/**
-  @brief  Platform Defined way of Timeout/Wait loop
-
-  @param  count  - Timeout/Wait Multiplier.
-
-  @return None
-**/
-VOID
-pal_ras_wait_timeout(UINT32 count)
-{
-  UINT32 timeout = count * PLATFORM_TIMEOUT_MEDIUM;
-
-  /* Wait Loop */
-  while (timeout > 0)
-    timeout--;
-}
-
 /**
   @brief  Display RAS info table details
 
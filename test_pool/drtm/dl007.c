@@ -30,8 +30,7 @@ volatile uint32_t dl_done = 0;
 void payload_secondary(void)
 {
   /* Wait until DL is called on Primary PE */
-  uint32_t timeout = TIMEOUT_MEDIUM;
-  while (timeout-- && (dl_done == 0));
+  val_flag_wait(&dl_done, 1, PE_COMPLETION_TIMEOUT_US);
 }
 
 static
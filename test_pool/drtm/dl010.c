@@ -49,7 +49,7 @@ payload(uint32_t num_pe)
    * */
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
   int64_t  status;
-  uint32_t timeout;
+  uint32_t timed_out;
   uint32_t sec_pe_index;
 
   DRTM_PARAMETERS *drtm_params;
@@ -89,16 +89,14 @@ payload(uint32_t num_pe)
 
   /* Invoke DRTM Dynamic Launch, This will return only in case of error */
 
-  timeout = TIMEOUT_LARGE;
-
   val_set_status(sec_pe_index, RESULT_PENDING(TEST_NUM));
   val_execute_on_pe(sec_pe_index, secondary_pe_payload, (uint64_t)drtm_params);
 
-  while ((--timeout) && (IS_RESULT_PENDING(val_get_status(sec_pe_index))));
+  timed_out = val_pe_status_wait(sec_pe_index, PE_COMPLETION_TIMEOUT_US);
 
   val_data_cache_ops_by_va((addr_t)&dl_status, CLEAN_AND_INVALIDATE);
 
-  if (timeout == 0) {
+  if (timed_out) {
     val_print(ERROR, "\n       **Timed out** for PE index = %d", sec_pe_index);
     val_print(ERROR, " Found = %d", dl_status);
     val_set_status(index, RESULT_FAIL(3));
@@ -49,7 +49,6 @@ payload (void)
 
   uint32_t index;
   uint32_t e_bdf = 0, get_value = 0;
-  uint32_t timeout;
   uint32_t status;
   uint32_t num_cards;
   uint32_t num_smmus, num_group;
@@ -149,9 +148,7 @@ payload (void)
     val_exerciser_ops(GENERATE_MSI, msi_index, instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_LARGE;
-    while ((--timeout > 0) && irq_pending)
-        {};
+    val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
     /* Interrupt must not be generated */
     if (irq_pending == 0) {
@@ -214,7 +214,7 @@ inject_error(uint32_t e_bdf, uint32_t instance, uint32_t aer_offset)
 {
     uint32_t err_code;
     uint32_t status, value;
-    uint32_t res, timeout;
+    uint32_t res, timed_out;
 
     for (err_code = 0; err_code <= ERR_CNT; err_code++)
     {
@@ -228,11 +228,9 @@ inject_error(uint32_t e_bdf, uint32_t instance, uint32_t aer_offset)
         if (msi_check == 1)
         {
             if (mask_value == 0) {
-                timeout = TIMEOUT_LARGE;
-                while ((--timeout > 0) && irq_pending)
-                {};
+                timed_out = val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
-                if (timeout == 0)
+                if (timed_out)
                 {
                     val_gic_free_irq(irq_pending, 0);
                     val_print(ERROR,
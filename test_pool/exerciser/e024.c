@@ -158,6 +158,7 @@ payload(void)
   uint32_t source_id;
   uint32_t dpc_trigger_reason;
   uint32_t timeout;
+  uint32_t timed_out;
   uint32_t msi_check = 0;
 
   uint32_t device_id = 0;
@@ -323,11 +324,9 @@ err_check:
 
           if (msi_check == 1)
           {
-              timeout = TIMEOUT_LARGE;
-              while ((--timeout > 0) && irq_pending)
-              {};
+              timed_out = val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
-              if (timeout == 0) {
+              if (timed_out) {
                   val_gic_free_irq(irq_pending, 0);
                   val_print(ERROR, "\n       Interrupt trigger failed for bdf 0x%x", e_bdf);
                   fail_cnt++;
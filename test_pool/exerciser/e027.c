@@ -154,6 +154,7 @@ payload(void)
   uint32_t aer_offset;
   uint32_t rp_aer_offset;
   uint32_t timeout;
+  uint32_t timed_out;
 
   uint32_t device_id = 0;
   uint32_t stream_id = 0;
@@ -291,11 +292,9 @@ payload(void)
               fail_cnt++;
           }
 
-          timeout = TIMEOUT_LARGE;
-          while ((--timeout > 0) && irq_pending)
-          {};
+          timed_out = val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
-          if (timeout == 0) {
+          if (timed_out) {
               val_gic_free_irq(irq_pending, 0);
               val_print(ERROR, "\n       Interrupt trigger failed for bdf 0x%lx", e_bdf);
               fail_cnt++;
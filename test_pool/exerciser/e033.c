@@ -49,7 +49,7 @@ payload (void)
 {
   uint32_t index;
   uint32_t e_bdf = 0;
-  uint32_t timeout;
+  uint32_t timed_out;
   uint32_t status;
   uint32_t num_cards;
   uint32_t num_smmus;
@@ -140,11 +140,9 @@ payload (void)
     val_exerciser_ops(GENERATE_MSI, msi_index, instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_LARGE;
-    while ((--timeout > 0) && irq_pending)
-        {};
+    timed_out = val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
-    if (timeout == 0) {
+    if (timed_out) {
         val_print(ERROR,
             "\n       Interrupt trigger failed for : 0x%x, ", lpi_int_id + instance);
         val_print(ERROR,
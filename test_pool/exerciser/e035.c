@@ -55,7 +55,7 @@ payload (void)
 
   uint32_t index;
   uint32_t e_bdf = 0, get_value = 0;
-  uint32_t timeout;
+  uint32_t timed_out;
   uint32_t status;
   uint32_t num_instance, grp_id = 0, blk_index = 0;
   uint32_t test_skip = 1;
@@ -161,12 +161,10 @@ payload (void)
       val_exerciser_ops(GENERATE_MSI, msi_index, instance);
 
       /* PE busy polls to check the completion of interrupt service routine */
-      timeout = TIMEOUT_LARGE;
-      while ((--timeout > 0) && irq_pending)
-          {};
+      timed_out = val_flag_wait(&irq_pending, 0, INTR_WAIT_TIMEOUT_US);
 
       /* Interrupt must not be generated */
-      if (timeout == 0) {
+      if (timed_out) {
           val_print(ERROR,
               "\n       Interrupt trigger failed int_id : 0x%x", base_lpi_id + instance);
           val_print(ERROR,
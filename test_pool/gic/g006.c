@@ -41,7 +41,6 @@ void
 payload()
 {
   /* Check non-secure physical timer Private Peripheral Interrupt (PPI) assignment */
-  uint32_t timeout = TIMEOUT_LARGE;
   uint32_t timer_expire_val = 100;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
 
@@ -60,11 +59,7 @@ payload()
 
   val_timer_set_phy_el1(timer_expire_val);
 
-  while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-        ;
-  }
-
-  if (timeout == 0) {
+  if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
     val_print(ERROR,
         "\n       EL0-Phy timer interrupt not received on INTID: %d   ", intid);
     val_set_status(index, RESULT_FAIL(3));
@@ -48,7 +48,6 @@ payload()
 
     /*Check CNTHV interrupt received*/
     uint32_t data;
-    uint32_t timeout = TIMEOUT_LARGE;
     uint64_t timer_expire_val = 100;
     uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
 
@@ -92,11 +91,7 @@ payload()
     }
 
     val_timer_set_vir_el2(timer_expire_val);
-    while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-        ;
-    }
-
-    if (timeout == 0) {
+    if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
         val_print(ERROR,
             "\n       NS EL2 Virtual timer interrupt %d not received", intid);
         val_set_status(index, RESULT_FAIL(4));
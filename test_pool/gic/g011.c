@@ -55,7 +55,6 @@ payload()
 
     /*Check GIC Maintenance interrupt received*/
     uint32_t data;
-    uint32_t timeout = TIMEOUT_LARGE;
     uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
 
     if (val_pe_reg_read(CurrentEL) == AARCH64_EL1) {
@@ -91,11 +90,7 @@ payload()
     data |= 0x7;
     val_gic_reg_write(ICH_HCR_EL2, data);
 
-    while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-        ;
-    }
-
-    if (timeout == 0) {
+    if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
         val_print(ERROR, "\n       Interrupt not received within timeout");
         val_set_status(index, RESULT_FAIL(4));
         return;
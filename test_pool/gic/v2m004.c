@@ -45,7 +45,6 @@ payload()
 
   uint32_t num_spi;
   uint32_t instance;
-  uint32_t timeout = TIMEOUT_MEDIUM;
   uint32_t msi_frame, min_spi_id;
   uint64_t frame_base;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
@@ -84,12 +83,8 @@ payload()
 
     val_mmio_write(val_get_gicd_base() + GICD_ISPENDR + (4 * reg_offset), 1 << reg_shift);
 
-    while ((timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-      timeout--;
-    }
-
     /* If the Status is changed that means interrupt handler is called & test is failed. */
-    if (timeout != 0) {
+    if (!val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
       val_print(ERROR, "\n       Interrupt generated by GICD registers");
       val_set_status(index, RESULT_FAIL(2));
       return;
@@ -99,11 +94,7 @@ payload()
     /* Generate the Interrupt by writing the int_id to SETSPI_NS Register */
     val_mmio_write(frame_base + GICv2m_MSI_SETSPI, int_id);
 
-    while ((timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-      timeout--;
-    }
-
-    if (timeout == 0) {
+    if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
       val_print(ERROR, "\n       Interrupt not received within timeout");
       val_set_status(index, RESULT_FAIL(3));
       return;
@@ -66,7 +66,7 @@ void payload(void)
     uint32_t pe_index;
     uint32_t status;
     uint32_t total_nodes;
-    uint32_t timeout;
+    uint32_t timed_out;
     uint32_t mpamf_ecr;
     uint32_t intr_flags;
     uint32_t intr_count = 0;
@@ -130,13 +130,12 @@ void payload(void)
         val_mpam_msc_trigger_intr(msc_index);
 
         /* PE busy polls to check the completion of interrupt service routine */
-        timeout = TIMEOUT_LARGE;
-        while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(pe_index))));
+        timed_out = val_pe_status_wait(pe_index, INTR_WAIT_TIMEOUT_US);
 
         /* Restore Error Control Register original settings */
         val_mpam_mmr_write(msc_index, REG_MPAMF_ECR, mpamf_ecr);
 
-        if (timeout && (!IS_RESULT_PENDING(val_get_status(pe_index)))) {
+        if (!timed_out) {
             val_set_status(pe_index, RESULT_FAIL(03));
             return;
         }
@@ -28,7 +28,7 @@
 static uint32_t msc_index;
 static uint32_t intr_num;
 static uint64_t mpam2_el2_temp;
-static volatile bool isr_completion_flag;
+static volatile uint32_t isr_completion_flag;
 
 static
 void intr_handler(void)
@@ -64,7 +64,6 @@ void payload(void)
     uint32_t rsrc_node_cnt;
     uint32_t rsrc_index;
     uint64_t mpam2_el2;
-    uint64_t timeout;
     uint32_t status;
     uint64_t buf_size = 0;
     uint64_t base = 0;
@@ -175,8 +174,7 @@ void payload(void)
             val_time_delay_ms(TIMEOUT_MEDIUM);
 
             /* PE busy polls to check the completion of interrupt service routine */
-            timeout = TIMEOUT_LARGE;
-            while ((--timeout > 0) && (isr_completion_flag == 0));
+            val_flag_wait(&isr_completion_flag, 1, INTR_WAIT_TIMEOUT_US);
 
             val_print(DEBUG, "\n       MSMON_CFG_MBWU_CTL is %llx",
                                             val_mpam_mmr_read(msc_index, REG_MSMON_CFG_MBWU_CTL));
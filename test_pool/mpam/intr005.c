@@ -145,7 +145,6 @@ void payload(void)
     uint32_t msmon_idr;
     uint32_t device_id = 0;
     uint32_t its_id = 0;
-    uint64_t timeout;
     uint64_t buf_size = TEST_BUF_SIZE;
     uint64_t base = 0;
     uint64_t mem_size = 0;
@@ -268,10 +267,7 @@ void payload(void)
                 goto monitor_cleanup;
             }
 
-            timeout = TIMEOUT_LARGE;
-            while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(pe_index))));
-
-            if (timeout == 0) {
+            if (val_pe_status_wait(pe_index, INTR_WAIT_TIMEOUT_US)) {
                 val_print(ERROR,
                     "\n       Overflow MSI not received for MSC %d", msc_index);
                 test_fail++;
@@ -94,6 +94,8 @@ void payload(void)
     void *src_buf = 0;
     void *dest_buf = 0;
     uint64_t buf_size;
+    MPAM_TRAFFIC_CFG_t traffic_cfg;
+    MPAM_TRAFFIC_RESULT_t traffic;
     uint64_t start_count;
     uint64_t end_count;
     uint64_t addr_base, addr_len;
@@ -287,8 +289,25 @@ void payload(void)
                 start_count = val_mpam_memory_mbwumon_read_count(msc_index);
                 val_print(INFO, "\n       Start count is %llx", start_count);
 
-                /* perform memory operation */
-                val_memcpy(src_buf, dest_buf, buf_size);
+                /* perform memory operation with a known offered load */
+                val_memory_set(&traffic_cfg, sizeof(traffic_cfg), 0);
+                traffic_cfg.mode = MPAM_TRAFFIC_COPY;
+                traffic_cfg.buf_base = (uint64_t)src_buf;
+                traffic_cfg.dst_base = (uint64_t)dest_buf;
+                traffic_cfg.buf_size = buf_size;
+                traffic_cfg.target_bytes = buf_size;
+
+                if (val_mpam_traffic_run(&traffic_cfg, &traffic) != ACS_STATUS_PASS) {
+                    val_print(ERROR, "\n       Traffic generation failed");
+                    val_set_status(pe_index, RESULT_FAIL(03));
+
+                    /* Restore MPAM2_EL2 settings */
+                    val_mpam_reg_write(MPAM2_EL2, mpam2_el2_temp);
+                    return;
+                }
+
+                val_print(INFO, "\n       Offered load 0x%llx bytes", traffic.bytes);
+                val_print(INFO, " at 0x%llx bytes/sec", traffic.bytes_per_sec);
                 /* Wait for some time before the memcpy settles and counters update */
                 val_time_delay_ms(TIMEOUT_MEDIUM);
 
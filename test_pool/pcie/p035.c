@@ -148,6 +148,9 @@ payload(void)
           reg_value = reg_value | DCTLR_FLR_SET;
           val_pcie_write_cfg(bdf, cap_base + DCTLR_OFFSET, reg_value);
 
+          /* Capabilities are read again from the Function after the reset */
+          val_pcie_invalidate_cap_cache(bdf);
+
           /* Wait for 100 ms */
           status = val_time_delay_ms(100 * ONE_MILLISECOND);
           if (status)
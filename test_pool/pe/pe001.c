@@ -298,13 +298,52 @@ id_regs_check(void)
   return;
 }
 
+/* Compare the registers of a PE captured in the PE ID snapshot with the
+   primary PE, without waking the PE again */
+static void
+id_regs_check_snapshot(uint32_t index)
+{
+  uint64_t reg_read_data;
+  uint32_t i = 0, check = 0;
+  pe_reg_info *pe_buffer = g_pe_reg_info + index;
+
+  for (i = 0; i < MAX_CACHE_LEVEL; i++) {
+      val_pe_id_snapshot_read_ccsidr(index, i, &reg_read_data);
+      if (reg_read_data == 0)
+          continue;
+
+      pe_buffer->pe_cache[i] = reg_read_data;
+      if ((reg_read_data & (~reg_list[0].reg_mask)) != (cache_list[i] & (~reg_list[0].reg_mask))) {
+          pe_buffer->cache_status[i] = 1;
+          check = 1;
+      }
+  }
+
+  for (i = 1; i < NUM_OF_REGISTERS; i++) {
+      reg_read_data = 0;
+      val_pe_id_snapshot_read(index, reg_list[i].reg_name, &reg_read_data);
+
+      pe_buffer->reg_data[i] = reg_read_data;
+      if ((reg_read_data & (~reg_list[i].reg_mask)) != (rd_data_array[i] &
+                                                                    (~reg_list[i].reg_mask)))
+      {
+          pe_buffer->reg_status[i] = 1;
+          check = 1;
+      }
+  }
+
+  if (check == 1)
+      val_set_status(index, RESULT_FAIL(2));
+  else
+      val_set_status(index, RESULT_PASS);
+}
+
 static
 void
 payload(uint32_t num_pe)
 {
   uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint32_t i, j, t = 0;
-  uint32_t timeout;
   uint64_t reg_read_data;
   uint64_t total_fail = 0;
   uint64_t reg_fail = 0;
@@ -360,11 +399,14 @@ payload(uint32_t num_pe)
 
   for (i = 0; i < num_pe; i++) {
       if (i != my_index) {
-          timeout = TIMEOUT_LARGE;
-          val_execute_on_pe(i, id_regs_check, (uint64_t)g_pe_reg_info);
-          while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))));
+          /* Use the registers captured at start-up when available */
+          if (val_pe_id_snapshot_valid(i)) {
+              id_regs_check_snapshot(i);
+              continue;
+          }
 
-          if(timeout == 0) {
+          val_execute_on_pe(i, id_regs_check, (uint64_t)g_pe_reg_info);
+          if (val_pe_status_wait(i, PE_COMPLETION_TIMEOUT_US)) {
               val_print(ERROR, "\n       **Timed out** for PE index = %d", i);
               val_set_status(i, RESULT_FAIL(3));
               return;
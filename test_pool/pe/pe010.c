@@ -78,7 +78,7 @@ static
 void
 payload()
 {
-  uint32_t timeout = 0x100000;
+  uint32_t timed_out = 0;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint32_t data = 0;
   uint64_t pmcr_value = val_pe_reg_read(PMCR_EL0);
@@ -111,12 +111,11 @@ payload()
 
   set_pmu_overflow();
 
-  while ((--timeout > 0) && \
-         (IS_RESULT_PENDING(val_get_status(index))));
+  timed_out = val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US);
 
   val_pe_reg_write(PMCR_EL0, pmcr_value);
 exception_taken:
-  if (timeout == 0) {
+  if (timed_out) {
       val_print(ERROR, "\n       Interrupt not received within timeout");
       val_set_status(index, RESULT_FAIL(2));
   }
@@ -326,7 +326,6 @@ payload_check_arm_generic_uart_interrupt()
 {
   uint32_t count = val_peripheral_get_info(NUM_UART, 0);
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
-  uint32_t timeout;
   uint32_t interface_type;
   uint32_t supported_uart_found = 0;
   uint32_t uart_interrupt_checked = 0;
@@ -339,7 +338,6 @@ payload_check_arm_generic_uart_interrupt()
   }
   val_set_status(index, RESULT_SKIP(2));
   while (count != 0) {
-      timeout = TIMEOUT_LARGE;
       int_id    = val_peripheral_get_info(UART_GSIV, count - 1);
       interface_type = val_peripheral_get_info(UART_INTERFACE_TYPE, count - 1);
       l_uart_base = val_peripheral_get_info(UART_BASE0, count - 1);
@@ -390,10 +388,7 @@ payload_check_arm_generic_uart_interrupt()
           val_print_raw(l_uart_base, acs_policy_get_print_level(),
                         "\n       Test Message                          ", 0);
 
-          while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-          };
-
-          if (timeout == 0) {
+          if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US)) {
              val_print(ERROR,
              "\n       Did not receive UART interrupt on %d  ",
              int_id);
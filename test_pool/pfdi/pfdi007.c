@@ -65,7 +65,7 @@ pfdi_test_run(void)
 static void payload_run(void *arg)
 {
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
-  uint32_t timeout, i = 0, test_fail = 0;
+  uint32_t i = 0, test_fail = 0;
   uint32_t num_pe = *(uint32_t *)arg;
   PFDI_RET_PARAMS *pfdi_range_buffer;
   PFDI_RET_PARAMS *pfdi_all_parts_buffer;
@@ -97,11 +97,9 @@ static void payload_run(void *arg)
   pfdi_test_run();
   for (i = 0; i < num_pe; i++) {
     if (i != index) {
-      timeout = TIMEOUT_LARGE;
       val_execute_on_pe(i, pfdi_test_run, 0);
 
-      while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))));
-      if (timeout == 0) {
+      if (val_pe_status_wait(i, PE_COMPLETION_TIMEOUT_US)) {
         val_print(ERROR, "\n       **Timed out** for PE index = %d", i);
         val_set_status(i, RESULT_FAIL(3));
         goto free_pfdi_details_both;
@@ -71,7 +71,7 @@ payload_check_pe_test_run_less_than_minus_one(void *arg)
 {
     uint32_t  num_pe = *((uint32_t *)arg);
     uint32_t  index = val_pe_get_index_mpid(val_pe_get_mpid());
-    uint32_t  i = 0, j = 0, timeout, test_fail = 0;
+    uint32_t  i = 0, j = 0, test_fail = 0;
     PFDI_RET_PARAMS *pfdi_buffer;
 
     /* Allocate memory for 2 cases * num_pe */
@@ -87,12 +87,9 @@ payload_check_pe_test_run_less_than_minus_one(void *arg)
 
     for (i = 0; i < num_pe; i++) {
         if (i != index) {
-            timeout = TIMEOUT_LARGE;
             val_execute_on_pe(i, check_pe_test_run_less_than_minus_one, 0);
 
-            while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))));
-
-            if (timeout == 0) {
+            if (val_pe_status_wait(i, PE_COMPLETION_TIMEOUT_US)) {
                 val_print(ERROR, "\n       **Timed out** for PE index = %d", i);
                 val_set_status(i, RESULT_FAIL(2));
                 goto free_pfdi_details;
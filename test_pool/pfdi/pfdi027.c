@@ -147,7 +147,7 @@ payload_check_error_overwrite(void *arg)
 {
   uint32_t num_pe = *((uint32_t *)arg);
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
-  uint32_t i, j, timeout, test_fail, test_skip;
+  uint32_t i, j, test_fail, test_skip;
   pfdi_error_injection_results *result;
 
   g_results = (pfdi_error_injection_results *)
@@ -164,12 +164,9 @@ payload_check_error_overwrite(void *arg)
   /* Execute test on all other PEs */
   for (i = 0; i < num_pe; i++) {
     if (i != index) {
-      timeout = TIMEOUT_LARGE;
       val_execute_on_pe(i, check_error_overwrite, 0);
 
-      while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))));
-
-      if (timeout == 0) {
+      if (val_pe_status_wait(i, PE_COMPLETION_TIMEOUT_US)) {
         val_print(ERROR, "\n       **Timed out** for PE index = %d", i);
         val_set_status(i, RESULT_FAIL(2));
         goto free_results;
@@ -139,7 +139,6 @@ payload_check_pe_locality(void *arg)
   uint32_t num_pe = *((uint32_t *)arg);
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint32_t other_pe_index;
-  uint32_t timeout;
   uint32_t i;
   uint32_t idx;
   uint32_t test_fail = 0;
@@ -182,10 +181,7 @@ payload_check_pe_locality(void *arg)
   val_execute_on_pe(other_pe_index, call_pfdi_functions_on_other_pe, 0);
 
   /* Wait for the other PE to finish its calls */
-  timeout = TIMEOUT_LARGE;
-  while ((--timeout) && (IS_RESULT_PENDING(val_get_status(other_pe_index))));
-
-  if (timeout == 0) {
+  if (val_pe_status_wait(other_pe_index, PE_COMPLETION_TIMEOUT_US)) {
     val_print(ERROR, "\n       **Timed out** waiting for other PE index = %d",
               other_pe_index);
     val_set_status(index, RESULT_FAIL(2));
@@ -62,14 +62,12 @@ static
 void
 payload()
 {
-  uint32_t timeout = 0x100000;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint64_t pmcr_value = val_pe_reg_read(PMCR_EL0);
 
   int_id = val_pe_get_pmu_gsiv(index);
 
   if (int_id != 23) {
-      timeout = 0;
       val_print(ERROR, "\n       Incorrect PPI value      %d       ", int_id);
       val_set_status(index, RESULT_FAIL(02));
       return;
@@ -79,11 +77,7 @@ payload()
 
   set_pmu_overflow();
 
-  while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
-    ;
-  }
-
-  if (timeout == 0)
+  if (val_pe_status_wait(index, INTR_WAIT_TIMEOUT_US))
       val_set_status(index, RESULT_FAIL(01));
 
   val_pe_reg_write(PMCR_EL0, pmcr_value);
@@ -43,6 +43,8 @@ payload()
   uint64_t err_rec_addrmode_bitmap;
   uint64_t data;
 
+  RAS_ERR_REC_SNAPSHOT *snapshot;
+  uint32_t num_snap;
   uint32_t status;
   uint32_t fail_cnt = 0, test_skip = 0, warn_cnt = 0;
   uint32_t node_index;
@@ -209,10 +211,20 @@ payload()
               continue;
           }
 
+          /* Capture STATUS and ADDR of all the node's records in one pass */
+          snapshot = val_memory_alloc(num_err_recs * sizeof(RAS_ERR_REC_SNAPSHOT));
+          if (snapshot == NULL) {
+              val_print(ERROR, "\n       Snapshot allocation failed for node index: 0x%lx",
+                        node_index);
+              fail_cnt++;
+              continue;
+          }
+          num_snap = val_ras_snapshot_node(node_index, snapshot, num_err_recs);
+
           /* Iterate through each error record implemented and check if ERR<n>ADDR.AI bit is 0b0
              if the address is the same as System Physical Address for the location,
              and 0b1 otherwise.*/
-          for (err_rec_index = 0; err_rec_index < num_err_recs; err_rec_index++) {
+          for (err_rec_index = 0; err_rec_index < num_snap; err_rec_index++) {
               /* check if error record is implemented for current node
                  Bit[n] = 0b: Error record at index n is implemented.
                  Bit[n] = 1b: Error record at index n is not implemented.
@@ -225,7 +237,7 @@ payload()
 
               /* if ERR<n>STATUS AV, bit [31] & V, bit [30] is invalid, continue with next
                  error record */
-              data = val_ras_reg_read(node_index, RAS_ERR_STATUS, err_rec_index);
+              data = snapshot[err_rec_index].status;
               if (data == INVALID_RAS_REG_VAL) {
                   val_print(ERROR,
                               "\n       Couldn't read ERR<%d>STATUS register for ",
@@ -249,7 +261,7 @@ payload()
               err_rec_addrmode = (err_rec_addrmode_bitmap >> err_rec_index) & 0x1;
 
               /* read ERR<n>ADDR.AI bit */
-              data = val_ras_reg_read(node_index, RAS_ERR_ADDR, err_rec_index);
+              data = snapshot[err_rec_index].addr;
               if (data == INVALID_RAS_REG_VAL) {
                   val_print(ERROR,
                               "\n       Couldn't read ERR<%d>STATUS register for ",
@@ -274,6 +286,8 @@ payload()
               }
           }
 
+          val_memory_free(snapshot);
+
           /* check if system RAS recorded the error in memory with address syndrome
              if no, rule is not applicable for the node  */
           if (!err_recorded) {
@@ -35,6 +35,7 @@ list(APPEND TEST_INCLUDE
     ${ROOT_DIR}/val/driver/gic/its/
     ${ROOT_DIR}/val/driver/smmu_v3/
     ${ROOT_DIR}/val/driver/pcie/
+    ${ROOT_DIR}/pal/include/
     ${ROOT_DIR}/pal/baremetal/base/include/
     ${ROOT_DIR}/pal/baremetal/base/src/
     ${ROOT_DIR}/pal/baremetal/target/${TARGET}/include/
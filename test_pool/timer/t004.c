@@ -46,7 +46,8 @@ void
 payload()
 {
 
-  volatile uint32_t timeout;
+  uint64_t timeout_us;
+  uint64_t freq;
   uint32_t timer_expire_val = TIMEOUT_MEDIUM;
   uint32_t status, ns_timer = 0;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
@@ -65,7 +66,6 @@ payload()
           continue;    //Skip Secure Timer
 
       ns_timer++;
-      timeout = TIMEOUT_LARGE;
       val_set_status(index, RESULT_PENDING(TEST_NUM));     // Set the initial result to pending
 
       //Read CNTACR to determine whether access permission from NS state is permitted
@@ -100,13 +100,16 @@ payload()
           return;
       }
 
+      /* Allow for the timer expiry, in system counter ticks, on top of the interrupt wait */
+      timeout_us = INTR_WAIT_TIMEOUT_US;
+      freq = val_get_counter_frequency();
+      if (freq)
+          timeout_us += ((uint64_t)timer_expire_val * 1000000) / freq;
+
       /* enable System timer */
       val_timer_set_system_timer((addr_t)cnt_base_n, timer_expire_val);
 
-      while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index))))
-      ;
-
-      if (timeout == 0) {
+      if (val_pe_status_wait(index, timeout_us)) {
           val_print(ERROR, "\n       Sys timer interrupt not received on %d   ", intid);
           val_set_status(index, RESULT_FAIL(3));
           return;
@@ -20,8 +20,20 @@
 #include "acs_gic_support.h"
 #include "val_sysreg_pe.h"
 
+/* Command queue state of an ITS and the mappings already made through it */
+typedef struct {
+  uint32_t    cwriter;            /* Next free command, in doublewords from CommandQBase */
+  uint32_t    creadr;             /* Last GITS_CREADR offset read, in doublewords */
+  uint32_t    pending;            /* Commands written but not yet published */
+  uint64_t    rd_base;            /* Target RDBase in the format selected by GITS_TYPER.PTA */
+  uint32_t    collection_mapped;
+  uint32_t    num_devices;
+  uint32_t    device_id[ITS_MAX_MAPPED_DEVICES];
+  uint32_t    device_lpis[ITS_MAX_MAPPED_DEVICES];  /* LPIs mapped through each DeviceID */
+} ITS_CMDQ_STATE;
+
 extern GIC_ITS_INFO    *g_gic_its_info;
-static uint32_t        *g_cwriter_ptr;
+static ITS_CMDQ_STATE  *g_its_cmdq;
 static uint32_t        g_its_setup_done;
 
 uint32_t GET_NUM_BITS(uint64_t value)
@@ -107,14 +119,14 @@ ArmGicSetItsCommandQueueBase(
 
   ItsBase = g_gic_its_info->GicIts[its_index].Base;
 
-  Address = (uint64_t)val_aligned_alloc(SIZE_64KB, (NUM_PAGES_8 * SIZE_4KB));
+  Address = (uint64_t)val_aligned_alloc(SIZE_64KB, ITS_CMDQ_SIZE);
 
   if (!Address) {
     val_print(ERROR, "\nITS : Could Not Allocate Memory CmdQ. Test may not pass.");
     return 1;
   }
 
-  val_memory_set((void *)Address,  (NUM_PAGES_8*SIZE_4KB), 0);
+  val_memory_set((void *)Address, ITS_CMDQ_SIZE, 0);
 
   g_gic_its_info->GicIts[its_index].CommandQBase = Address;
 
@@ -296,154 +308,274 @@ static uint32_t ArmGicSetItsTables(uint32_t its_index)
 }
 
 
-static void EnableITS(uint64_t GicItsBase)
+static void EnableITS(uint32_t its_index)
 {
   /* Set GITS_CTLR.Enable as 1 to enable the ITS */
   uint32_t    value;
+  uint64_t    ItsBase;
+
+  ItsBase = g_gic_its_info->GicIts[its_index].Base;
+
+  value = val_mmio_read(ItsBase + ARM_GITS_CTLR);
+  if (value & ARM_GITS_CTLR_ENABLE)
+    return;
+
+  /* Do not trust mappings made before the ITS was last disabled */
+  g_its_cmdq[its_index].collection_mapped = 0;
+  g_its_cmdq[its_index].num_devices = 0;
+
+  val_mmio_write(ItsBase + ARM_GITS_CTLR, (value | ARM_GITS_CTLR_ENABLE));
+}
+
+static uint32_t ItsCmdQReadCreadr(uint32_t its_index)
+{
+  /* Refresh the cached GITS_CREADR offset, retrying a stalled command queue */
+  uint64_t    creadr_value;
+  uint64_t    cwriter_value;
+  uint64_t    ItsBase;
+
+  ItsBase = g_gic_its_info->GicIts[its_index].Base;
+  creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
+
+  if (creadr_value & ARM_GITS_CREADR_STALL) {
+    cwriter_value = val_mmio_read64(ItsBase + ARM_GITS_CWRITER) & ARM_GITS_CMDQ_OFFSET_MASK;
+    val_mmio_write64((ItsBase + ARM_GITS_CWRITER), (cwriter_value | ARM_GITS_CWRITER_RETRY));
+  }
+
+  g_its_cmdq[its_index].creadr =
+                        (creadr_value & ARM_GITS_CMDQ_OFFSET_MASK) / NUM_BYTES_IN_DW;
+  return g_its_cmdq[its_index].creadr;
+}
+
+static uint32_t ItsCmdQConsumed(void *arg)
+{
+  /* val_poll_until condition: the ITS consumed every published command */
+  uint32_t its_index = *(uint32_t *)arg;
+
+  return (ItsCmdQReadCreadr(its_index) == g_its_cmdq[its_index].cwriter);
+}
+
+static uint32_t PollTillCommandQueueDone(uint32_t its_index)
+{
+  /* Wait for the ITS to consume every published command, bounded by a deadline */
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+
+  val_poll_until(ItsCmdQConsumed, &its_index, ITS_CMDQ_TIMEOUT_US, DEADLINE_BACKOFF_NONE);
 
-  value = val_mmio_read(GicItsBase + ARM_GITS_CTLR);
-  val_mmio_write(GicItsBase + ARM_GITS_CTLR, (value | ARM_GITS_CTLR_ENABLE));
+  if (cmdq->creadr != cmdq->cwriter) {
+    val_print(ERROR,
+              "\n       ITS : Command Queue READR not moving, Test may not pass");
+    return 1;
+  }
+
+  return 0;
+}
+
+static uint32_t ItsCmdQPublish(uint32_t its_index)
+{
+  /* Hand all written commands to the ITS with one CWRITER update and wait for them */
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+  uint64_t    ItsBase;
+
+  ItsBase = g_gic_its_info->GicIts[its_index].Base;
+
+  if (cmdq->pending) {
+    dsbsy();
+    val_mmio_write64((ItsBase + ARM_GITS_CWRITER), (cmdq->cwriter * NUM_BYTES_IN_DW));
+    cmdq->pending = 0;
+  }
+
+  return PollTillCommandQueueDone(its_index);
+}
+
+static uint32_t ItsCmdQReserve(uint32_t its_index)
+{
+  /* Make room for one command, one slot is always left free to tell full from empty */
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+  uint32_t    next;
+
+  next = (cmdq->cwriter + ITS_NEXT_CMD_PTR) % ITS_CMDQ_DWORDS;
+  if (next != cmdq->creadr)
+    return 0;
+
+  if (ItsCmdQReadCreadr(its_index) != next)
+    return 0;
+
+  return ItsCmdQPublish(its_index);
+}
+
+static void
+ItsCmdQWrite(
+   uint32_t     its_index,
+   uint64_t     dw0,
+   uint64_t     dw1,
+   uint64_t     dw2,
+   uint64_t     dw3
+  )
+{
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+  uint64_t    *cmd;
+
+  if (ItsCmdQReserve(its_index))
+    return;
+
+  cmd = (uint64_t *)g_gic_its_info->GicIts[its_index].CommandQBase + cmdq->cwriter;
+  val_mmio_write64((uint64_t)(cmd), dw0);
+  val_mmio_write64((uint64_t)(cmd + 1), dw1);
+  val_mmio_write64((uint64_t)(cmd + 2), dw2);
+  val_mmio_write64((uint64_t)(cmd + 3), dw3);
+
+  cmdq->cwriter = (cmdq->cwriter + ITS_NEXT_CMD_PTR) % ITS_CMDQ_DWORDS;
+  cmdq->pending++;
 }
 
 static void
 WriteCmdQMAPD(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
    uint64_t     device_id,
    uint64_t     ITT_BASE,
    uint32_t     Size,
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(Size));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD),
+                 (uint64_t)(Size),
+                 (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)),
+                 (uint64_t)(0x0));
 }
 
 static void
 WriteCmdQMAPC(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
    uint32_t     Clctn_ID,
-   uint32_t     RDBase,
+   uint64_t     RDBase,
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_MAPC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)(ARM_ITS_CMD_MAPC),
+                 (uint64_t)(0x0),
+                 (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID),
+                 (uint64_t)(0x0));
 }
 
 static void
 WriteCmdQMAPTI(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
    uint64_t     device_id,
    uint32_t     int_id,
    uint32_t     Clctn_ID
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     ((uint64_t)(int_id-ARM_LPI_MINID) | ((uint64_t)int_id << 32)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI),
+                 ((uint64_t)(int_id-ARM_LPI_MINID) | ((uint64_t)int_id << 32)),
+                 (uint64_t)(Clctn_ID),
+                 (uint64_t)(0));
 }
 
 static void
 WriteCmdQINV(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
    uint64_t     device_id,
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     (uint64_t)(int_id-ARM_LPI_MINID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV),
+                 (uint64_t)(int_id-ARM_LPI_MINID),
+                 (uint64_t)(0x0),
+                 (uint64_t)(0x0));
 }
 
 static void
 WriteCmdQDISCARD(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
    uint64_t     device_id,
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     (uint64_t)(int_id-ARM_LPI_MINID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD),
+                 (uint64_t)(int_id-ARM_LPI_MINID),
+                 (uint64_t)(0x0),
+                 (uint64_t)(0x0));
 }
 
 
 static void
 WriteCmdQSYNC(
    uint32_t     its_index,
-   uint64_t     *CMDQ_BASE,
-   uint32_t     RDBase
+   uint64_t     RDBase
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_SYNC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(RDBase));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    ItsCmdQWrite(its_index,
+                 (uint64_t)(ARM_ITS_CMD_SYNC),
+                 (uint64_t)(0x0),
+                 (uint64_t)(RDBase),
+                 (uint64_t)(0x0));
 }
 
-static void PollTillCommandQueueDone(uint32_t its_index)
+static void ItsCmdQSync(uint32_t its_index)
 {
-  uint32_t    count;
-  uint64_t    creadr_value;
-  uint64_t    stall_value;
-  uint64_t    cwriter_value;
-  uint64_t    ItsBase;
-
-  count = 0;
-  ItsBase = g_gic_its_info->GicIts[its_index].Base;
-  cwriter_value = val_mmio_read64(ItsBase + ARM_GITS_CWRITER);
-  creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
+  /* Close the written commands with one SYNC and publish them */
+  if (g_its_cmdq[its_index].pending == 0)
+    return;
 
-  while (creadr_value != cwriter_value) {
-    /* Check Stall Value */
-    stall_value = creadr_value & ARM_GITS_CREADR_STALL;
+  WriteCmdQSYNC(its_index, g_its_cmdq[its_index].rd_base);
+  ItsCmdQPublish(its_index);
+}
 
-    if (stall_value) {
-      /* Retry */
-      val_mmio_write64((ItsBase + ARM_GITS_CWRITER),
-                  (cwriter_value | ARM_GITS_CWRITER_RETRY)
-                 );
+static void ItsMapDevice(uint32_t its_index, uint32_t device_id)
+{
+  /* Issue MAPD only for a DeviceID this ITS has no LPI mapped through yet */
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+  uint32_t    i;
+
+  for (i = 0; i < cmdq->num_devices; i++) {
+    if (cmdq->device_id[i] == device_id) {
+      cmdq->device_lpis[i]++;
+      return;
     }
+  }
 
-    count++;
-    if (count > WAIT_ITS_COMMAND_DONE) {
-      val_print(ERROR,
-                "\n       ITS : Command Queue READR not moving, Test may not pass");
+  WriteCmdQMAPD(its_index, device_id,
+                g_gic_its_info->GicIts[its_index].ITTBase,
+                g_gic_its_info->GicIts[its_index].IDBits, 0x1 /*Valid*/);
+
+  /* Once the table is full, untracked devices are mapped and unmapped on every request */
+  if (cmdq->num_devices < ITS_MAX_MAPPED_DEVICES) {
+    cmdq->device_id[cmdq->num_devices] = device_id;
+    cmdq->device_lpis[cmdq->num_devices] = 1;
+    cmdq->num_devices++;
+  }
+}
+
+static void ItsUnmapDevice(uint32_t its_index, uint32_t device_id)
+{
+  /* Unmap a DeviceID with MAPD V=0 once its last LPI is cleared. All devices
+     share the ITS ITT, so a device left mapped would alias the next one. */
+  ITS_CMDQ_STATE *cmdq = &g_its_cmdq[its_index];
+  uint32_t    i;
+
+  for (i = 0; i < cmdq->num_devices; i++) {
+    if (cmdq->device_id[i] == device_id)
       break;
-    }
+  }
+
+  if (i < cmdq->num_devices) {
+    if (--cmdq->device_lpis[i])
+      return;
 
-    creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
+    cmdq->num_devices--;
+    cmdq->device_id[i] = cmdq->device_id[cmdq->num_devices];
+    cmdq->device_lpis[i] = cmdq->device_lpis[cmdq->num_devices];
   }
 
+  WriteCmdQMAPD(its_index, device_id,
+                g_gic_its_info->GicIts[its_index].ITTBase,
+                0, 0 /*InValid*/);
 }
 
 static uint64_t GetRDBaseFormat(uint32_t its_index)
@@ -470,60 +602,28 @@ static uint64_t GetRDBaseFormat(uint32_t its_index)
   }
 }
 
-
 void val_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id)
 {
-  uint64_t    value;
-  uint64_t    RDBase;
-  uint64_t    ItsBase;
-  uint64_t    ItsCommandBase;
-
   if (!g_its_setup_done)
     return;
 
-  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
-  ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
-
   /* Clear Config table for LPI=int_id */
   ClearConfigTable(int_id);
 
-  /* Get RDBase Depending on GITS_TYPER.PTA */
-  RDBase = GetRDBaseFormat(its_index);
-
   /* Discard Mappings */
-  WriteCmdQDISCARD(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id);
-  /* Un Map Device using MAPD */
-  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
-                g_gic_its_info->GicIts[its_index].ITTBase,
-                0, 0 /*InValid*/);
-  /* ITS SYNC Command */
-  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
-
-  dsbsy();
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
-
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(its_index);
-  dsbsy();
+  WriteCmdQDISCARD(its_index, device_id, int_id);
+  /* Un Map Device using MAPD once it has no LPI left */
+  ItsUnmapDevice(its_index, device_id);
 
+  ItsCmdQSync(its_index);
 }
 
 void val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
                             uint32_t int_id, uint32_t Priority)
 {
-  uint64_t    value;
-  uint64_t    RDBase;
-  uint64_t    ItsBase;
-  uint64_t    ItsCommandBase;
-
   if (!g_its_setup_done)
     return;
 
-  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
-  ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
-
   /* Set Config table with enable the LPI = int_id, Priority. */
   SetConfigTable(int_id, Priority);
 
@@ -531,35 +631,23 @@ void val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
   EnableLPIsRD(g_gic_its_info->GicRdBase);
 
   /* Enable ITS */
-  EnableITS(ItsBase);
-
-  /* Get RDBase Depending on GITS_TYPER.PTA */
-  RDBase = GetRDBaseFormat(its_index);
+  EnableITS(its_index);
 
   /* Map Device using MAPD */
-  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
-                g_gic_its_info->GicIts[its_index].ITTBase,
-                g_gic_its_info->GicIts[its_index].IDBits, 0x1 /*Valid*/);
+  ItsMapDevice(its_index, device_id);
+
   /* Map Collection using MAPC */
-  WriteCmdQMAPC(its_index, (uint64_t *)(ItsCommandBase),
-                0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/);
+  if (!g_its_cmdq[its_index].collection_mapped) {
+    WriteCmdQMAPC(its_index, ITS_COLLECTION_ID, g_its_cmdq[its_index].rd_base, 0x1 /*Valid*/);
+    g_its_cmdq[its_index].collection_mapped = 1;
+  }
+
   /* Map Interrupt using MAPI */
-  WriteCmdQMAPTI(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id, 0x1 /*Clctn_ID*/);
+  WriteCmdQMAPTI(its_index, device_id, int_id, ITS_COLLECTION_ID);
   /* Invalid Entry */
-  WriteCmdQINV(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id);
-  /* ITS SYNC Command */
-  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
-
-  dsbsy();
-
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
-
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(its_index);
-  dsbsy();
+  WriteCmdQINV(its_index, device_id, int_id);
 
+  ItsCmdQSync(its_index);
 }
 
 
@@ -627,17 +715,14 @@ uint32_t val_its_init(void)
   uint32_t    Status;
   uint32_t    index;
 
-  g_cwriter_ptr = (uint32_t *)pal_aligned_alloc(MEM_ALIGN_4K,
-                                                sizeof(uint32_t) * (g_gic_its_info->GicNumIts));
+  g_its_cmdq = (ITS_CMDQ_STATE *)val_memory_calloc(g_gic_its_info->GicNumIts,
+                                                   sizeof(ITS_CMDQ_STATE));
 
-  if (g_cwriter_ptr == NULL) {
+  if (g_its_cmdq == NULL) {
     val_print(ERROR, "\nITS : Could Not Allocate Memory CWriteR. Test may not pass.");
     return 0;
   }
 
-  for (index = 0; index < g_gic_its_info->GicNumIts; index++)
-    g_cwriter_ptr[index] = 0;
-
   for (index = 0; index < g_gic_its_info->GicNumIts; index++)
   {
     /* Set Initial configuration */   // DONE
@@ -662,6 +747,9 @@ uint32_t val_its_init(void)
     Status = ArmGicSetItsTables(index);
     if (Status)
       return Status;
+
+    /* Get RDBase Depending on GITS_TYPER.PTA */
+    g_its_cmdq[index].rd_base = GetRDBaseFormat(index);
   }
 
   g_its_setup_done = 1;
@@ -39,7 +39,7 @@
 #define ARM_LPI_MIN_IDBITS  14
 #define ARM_LPI_MAX_IDBITS  31
 
-#define WAIT_ITS_COMMAND_DONE   10000
+#define ITS_CMDQ_TIMEOUT_US     1000000   /* Deadline for a command queue drain */
 
 /* GICv3 specific registers */
 
@@ -131,6 +131,9 @@
 /* GITS_CREADR Bits */
 #define ARM_GITS_CREADR_STALL       (1 << 0)
 
+/* GITS_CREADR/GITS_CWRITER Offset field, bits [19:5] */
+#define ARM_GITS_CMDQ_OFFSET_MASK   (0xFFFE0ul)
+
 /* GITS_CWRITER Bits */
 #define ARM_GITS_CWRITER_RETRY      (1 << 0)
 
@@ -184,6 +187,11 @@
 #define ITS_NEXT_CMD_PTR    4
 #define NUM_BYTES_IN_DW     8
 
+#define ITS_CMDQ_SIZE           (NUM_PAGES_8 * SIZE_4KB)
+#define ITS_CMDQ_DWORDS         (ITS_CMDQ_SIZE / NUM_BYTES_IN_DW)
+#define ITS_COLLECTION_ID       0x1
+#define ITS_MAX_MAPPED_DEVICES  64
+
 uint32_t ArmGicRedistributorConfigurationForLPI(uint64_t rd_base);
 
 void ClearConfigTable(uint32_t int_id);
@@ -124,6 +124,8 @@ void EnableLPIsRD(uint64_t GicRedistributorBase)
 {
   uint32_t    value;
   value = val_mmio_read(GicRedistributorBase + ARM_GICR_CTLR);
+  if (value & ARM_GICR_CTLR_ENABLE_LPIS)
+    return;
 
   val_mmio_write(GicRedistributorBase + ARM_GICR_CTLR,
               (value | ARM_GICR_CTLR_ENABLE_LPIS));
@@ -107,6 +107,22 @@ CurrentCpuRDBase(uint64_t mGicRedistributorBase, uint32_t length)
   return 0;
 }
 
+#if defined(TARGET_SIMULATION)
+/**
+  @brief  val_poll_until condition: the redistributor reports ChildrenAsleep clear
+  @param  arg - pointer to the redistributor base of the PE
+  @return 1 if the interface is active
+**/
+static uint32_t
+v3_gicr_awake(void *arg)
+{
+  uint64_t cpuRd_base = *(uint64_t *)arg;
+
+  return !((val_mmio_read(cpuRd_base + GICR_WAKER) >> GICR_WAKER_CHILDREN_ASLEEP_SHIFT)
+           & GICR_WAKER_BIT_MASK);
+}
+#endif
+
 /**
   @brief  Marks primary PE as online
   @param  none
@@ -131,18 +147,9 @@ WakeUpRD(void)
       val_mmio_write(cpuRd_base + GICR_WAKER, tmp & ~0x02);
 
 #if defined(TARGET_SIMULATION)
-    uint32_t timeout = 0x20000;
-    uint32_t spin = 0;
-    do {
-        tmp = (val_mmio_read(cpuRd_base + GICR_WAKER) >> GICR_WAKER_CHILDREN_ASLEEP_SHIFT)
-              & GICR_WAKER_BIT_MASK;
-        /* Interface Active */
-        if (!tmp) break;
-        if ((++spin & GICR_WAKER_SPIN_DELAY_MASK) == 0) {
-          /* Give sim time to advance without hammering MMIO */
-          val_time_delay_ms(1);
-        }
-    } while (--timeout);
+    /* Back off between reads to give sim time to advance without hammering MMIO */
+    val_poll_until(v3_gicr_awake, (void *)&cpuRd_base, GICR_WAKER_TIMEOUT_US,
+                   DEADLINE_BACKOFF_DELAY);
 #else
   do {
       tmp = (val_mmio_read(cpuRd_base + GICR_WAKER)
@@ -34,7 +34,7 @@
 #define GICR_WAKER_CHILDREN_ASLEEP_SHIFT     2U
 /* Single-bit mask */
 #define GICR_WAKER_BIT_MASK                 0x1U
-#define GICR_WAKER_SPIN_DELAY_MASK          0x3FFU
+#define GICR_WAKER_TIMEOUT_US               1000000U  /* Deadline for ChildrenAsleep to clear */
 #define GIC_ALL_INTERRUPTS_MASK             0xFFFFFFFFU
 #define GIC_SIM_MAX_SPI_ROUTE_COUNT         256U
 
@@ -69,7 +69,7 @@ uint32_t smmu_oas[SMMU_OAS_MAX_IDX] = {32, 36, 40, 42, 44, 48, 52};
 #define SMMU_GBPA_ABORT    (1U << 20)
 #define SMMU_GBPA_UPDATE   (1U << 31)
 
-#define SMMU_SYNC_TIMEOUT  0x1000000ULL
+#define SMMU_SYNC_TIMEOUT_US  1000000   /* Deadline for a register update to be acknowledged */
 
 #define SMMU_CR1_OFFSET 0x28
 BITFIELD_DECL(uint32_t, CR1_TABLE_SH, 11, 10)
@@ -204,7 +204,22 @@ BITFIELD_DECL(uint64_t, CMDQ_0_OP, 7, 0)
 BITFIELD_DECL(uint64_t, CMDQ_CFGI_1_RANGE, 4, 0)
 #define CMDQ_CFGI_1_ALL_STES 31
 
-#define SMMU_CMDQ_POLL_TIMEOUT 0x100000
+BITFIELD_DECL(uint64_t, CMDQ_CFGI_0_SSID, 31, 12)
+BITFIELD_DECL(uint64_t, CMDQ_CFGI_0_SID, 63, 32)
+#define CMDQ_CFGI_1_LEAF (1UL << 0)
+
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_VMID, 47, 32)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_ASID, 63, 48)
+
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_CS, 13, 12)
+#define CMDQ_SYNC_0_CS_NONE 0
+#define CMDQ_SYNC_0_CS_IRQ  1
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSH, 23, 22)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIATTR, 27, 24)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIDATA, 63, 32)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_1_MSIADDR, 51, 2)
+
+#define SMMU_CMDQ_TIMEOUT_US   1000000   /* Deadline for the SMMU to consume commands */
 
 #define CDTAB_SPLIT             10
 #define CDTAB_L2_ENTRY_COUNT    (1 << CDTAB_SPLIT)
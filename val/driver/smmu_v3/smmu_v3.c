@@ -24,11 +24,23 @@ uint32_t    g_smmu_index;
 uint64_t    g_page1_base;
 extern uint32_t g_num_smmus;
 
-struct smmu_master_node *g_smmu_master_list_head = NULL;
-
-static uint64_t align_to_size(uint64_t addr,  uint64_t size)
+/**
+  @brief  Allocate a zeroed table or queue with the alignment its base address
+          field requires, so it does not have to be over-allocated and
+          aligned by hand.
+  @param  size  - size in bytes.
+  @param  align - required alignment in bytes, a power of two.
+  @return virtual address of the table, NULL on failure.
+**/
+static void *smmu_table_alloc(uint64_t size, uint64_t align)
 {
-    return ((size - (addr & (size-1)) + addr) & ~(size-1));
+    void *table;
+
+    table = val_aligned_alloc((uint32_t)align, (uint32_t)size);
+    if (table != NULL)
+        val_memory_set(table, (uint32_t)size, 0);
+
+    return table;
 }
 
 static uint32_t smmu_inc_prod(smmu_queue_t *q)
@@ -41,14 +53,6 @@ static uint32_t smmu_inc_cons(smmu_queue_t *q)
     return (q->cons + 1) & ((0x1ul << (q->log2nent + 1)) - 1);
 }
 
-static uint32_t smmu_queue_full(smmu_queue_t *q)
-{
-    uint32_t index_mask = ((0x1ul << q->log2nent) - 1);
-    uint32_t wrap_mask = (0x1ul << q->log2nent);
-    return ((q->prod & index_mask) == (q->cons & index_mask)) &&
-           ((q->prod & wrap_mask) != (q->cons & wrap_mask));
-}
-
 static uint32_t smmu_queue_empty(smmu_queue_t *q)
 {
     uint32_t index_mask = ((0x1ul << q->log2nent) - 1);
@@ -62,10 +66,15 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     val_memory_set(cmd, CMDQ_DWORDS_PER_ENT << 3, 0);
     cmd[0] |= BITFIELD_SET(CMDQ_0_OP, opcode);
 
+    /* Operands of scoped commands are filled in by the caller */
     switch (opcode) {
     case CMDQ_OP_TLBI_EL2_ALL:
     case CMDQ_OP_TLBI_NSNH_ALL:
     case CMDQ_OP_CMD_SYNC:
+    case CMDQ_OP_CFGI_STE:
+    case CMDQ_OP_CFGI_CD:
+    case CMDQ_OP_TLBI_NH_ASID:
+    case CMDQ_OP_TLBI_S12_VMALL:
         break;
     case CMDQ_OP_CFGI_ALL:
         cmd[1] |= BITFIELD_SET(CMDQ_CFGI_1_RANGE, CMDQ_CFGI_1_ALL_STES);
@@ -78,79 +87,240 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     return 0;
 }
 
-static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
+static uint32_t smmu_queue_space(smmu_queue_t *q)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    int ret = 0, i;
-    uint64_t *cmd_dst;
+    uint32_t nent = (0x1ul << q->log2nent);
+    uint32_t used = (q->prod - q->cons) & ((nent << 1) - 1);
+
+    return nent - used;
+}
+
+/**
+  @brief   Wait until the command queue has room for a number of commands
+
+  @param   smmu  - Pointer to the SMMU device structure
+  @param   n     - Number of command slots needed
+
+  @return  0 on success, -1 if the SMMU did not consume commands in time
+**/
+static int smmu_cmdq_reserve(smmu_dev_t *smmu, uint32_t n)
+{
+    val_deadline_t dl;
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t
-        queue =
-            {
-                .log2nent = cmdq->queue.log2nent,
-            };
+    uint32_t wrap_idx_mask = (0x1ul << (cmdq->queue.log2nent + 1)) - 1;
 
-    while (smmu_queue_full(&cmdq->queue) && timeout) {
-        timeout--;
-    }
+    val_deadline_start(&dl, SMMU_CMDQ_TIMEOUT_US);
 
-    if (!timeout) {
-        val_print(ERROR, "\n       SMMU CMD queue is full     ");
-        return -1;
+    /* CONS is read back only when the cached copy shows too little room */
+    while (smmu_queue_space(&cmdq->queue) < n) {
+        if (val_deadline_expired(&dl)) {
+            val_print(ERROR, "\n       SMMU CMD queue is full     ");
+            return -1;
+        }
+        cmdq->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg) & wrap_idx_mask;
     }
 
-    queue.prod = val_mmio_read((uint64_t)cmdq->prod_reg);
-    cmd_dst = (uint64_t *)(cmdq->base + ((queue.prod & ((0x1ull << queue.log2nent) - 1)) * (cmdq->entry_size)));
-    for (i = 0; i < CMDQ_DWORDS_PER_ENT; ++i)
-        cmd_dst[i] = cmd[i];
-    queue.prod = smmu_inc_prod(&queue);
+    return 0;
+}
+
+/**
+  @brief   Copy commands into the queue memory at the software PROD index
 
-#ifndef TARGET_LINUX
-    dmbsy();
-#endif
-    val_mmio_write((uint64_t)cmdq->prod_reg, queue.prod);
+  @param   smmu  - Pointer to the SMMU device structure
+  @param   cmds  - Commands, CMDQ_DWORDS_PER_ENT dwords each
+  @param   n     - Number of commands
 
-    return ret;
+  @return  Pointer to the queue slot of the last command written
+**/
+static uint64_t *smmu_cmdq_copy_cmds(smmu_dev_t *smmu, const uint64_t *cmds, uint32_t n)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    uint32_t index_mask = (0x1ul << cmdq->queue.log2nent) - 1;
+    uint64_t *cmd_dst = NULL;
+    uint32_t i, j;
+
+    for (i = 0; i < n; i++) {
+        cmd_dst = (uint64_t *)(cmdq->base + ((cmdq->queue.prod & index_mask) * cmdq->entry_size));
+        for (j = 0; j < CMDQ_DWORDS_PER_ENT; j++)
+            cmd_dst[j] = cmds[i * CMDQ_DWORDS_PER_ENT + j];
+        cmdq->queue.prod = smmu_inc_prod(&cmdq->queue);
+    }
+
+    return cmd_dst;
 }
 
-static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
-                   uint8_t opcode)
+/**
+  @brief   Build a CMD_SYNC for a queue slot
+
+  When the SMMU can write MSIs coherently, the sync signals completion by
+  writing MSIData 0 over its own first word in the queue, so completion is
+  observed in memory instead of by polling SMMU_CMDQ_CONS.
+
+  @param   smmu     - Pointer to the SMMU device structure
+  @param   cmd      - Command buffer to fill
+  @param   slot_va  - Virtual address of the queue slot the sync is written to
+
+  @return  None
+**/
+static void smmu_cmdq_build_sync(smmu_dev_t *smmu, uint64_t *cmd, uint64_t *slot_va)
 {
-    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+    uint64_t slot_pa;
 
-    if (smmu_cmdq_build_cmd(cmd, opcode)) {
-        return -1;
-    }
+    smmu_cmdq_build_cmd(cmd, CMDQ_OP_CMD_SYNC);
+    if (!(smmu->supported.msi && smmu->supported.coherent))
+        return;
 
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    slot_pa = smmu->cmdq.base_phys + ((uint8_t *)slot_va - smmu->cmdq.base);
+    cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_IRQ) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSH, SMMU_SH_ISH) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSIATTR, SMMU_MEMATTR_OIWB) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSIDATA, 0);
+    cmd[1] |= slot_pa & (CMDQ_SYNC_1_MSIADDR_MASK << CMDQ_SYNC_1_MSIADDR_SHIFT);
 }
 
-static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
+/**
+  @brief   Wait for a published CMD_SYNC to complete
+
+  @param   smmu     - Pointer to the SMMU device structure
+  @param   sync_va  - Queue slot holding the CMD_SYNC
+
+  @return  0 on completion, -1 on timeout
+**/
+static int smmu_cmdq_wait_sync(smmu_dev_t *smmu, uint64_t *sync_va)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
+    val_deadline_t dl;
+    uint32_t expired = 0;
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t queue = {
-                .log2nent = smmu->cmdq.queue.log2nent,
-                .prod = val_mmio_read((uint64_t)smmu->cmdq.prod_reg),
-                .cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg)
-            };
-
-    while (timeout > 0) {
-        if (smmu_queue_empty(&queue))
-            break;
-        queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
-        timeout--;
+    uint32_t wrap_idx_mask = (0x1ul << (cmdq->queue.log2nent + 1)) - 1;
+
+    val_deadline_start(&dl, SMMU_CMDQ_TIMEOUT_US);
+
+    if (smmu->supported.msi && smmu->supported.coherent) {
+        /* MSIData 0 replaces the CMD_SYNC opcode in the first word */
+        while (*(volatile uint32_t *)sync_va != 0) {
+            expired = val_deadline_expired(&dl);
+            if (expired)
+                break;
+        }
+        cmdq->queue.cons = cmdq->queue.prod;
+    } else {
+        while (1) {
+            cmdq->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg) & wrap_idx_mask;
+            if (smmu_queue_empty(&cmdq->queue))
+                break;
+            expired = val_deadline_expired(&dl);
+            if (expired)
+                break;
+        }
     }
 
-    if (!timeout) {
-        val_print(ERROR, "\n       CMDQ poll timeout at 0x%08x", queue.prod);
+    if (expired) {
+        val_print(ERROR, "\n       CMDQ poll timeout at 0x%08x", cmdq->queue.prod);
         val_print(ERROR, "\n       prod_reg = 0x%08x,",
 val_mmio_read((uint64_t)smmu->cmdq.prod_reg));
         val_print(ERROR, "\n       cons_reg = 0x%08x",
 val_mmio_read((uint64_t)smmu->cmdq.cons_reg));
         val_print(ERROR, "\n       gerror   = 0x%08x     ",
 val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
+        cmdq->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg) & wrap_idx_mask;
+        return -1;
     }
+
+    return 0;
+}
+
+/**
+  @brief   Publish the collected commands without waiting for completion
+
+  @param   smmu   - Pointer to the SMMU device structure
+  @param   batch  - Command batch, emptied on return
+
+  @return  0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_publish(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    int ret = 0;
+
+    if (batch->num) {
+        ret = smmu_cmdq_reserve(smmu, batch->num);
+        if (!ret) {
+            smmu_cmdq_copy_cmds(smmu, batch->cmds, batch->num);
+#ifndef TARGET_LINUX
+            dmbsy();
+#endif
+            val_mmio_write((uint64_t)smmu->cmdq.prod_reg, smmu->cmdq.queue.prod);
+        }
+    }
+
+    batch->num = 0;
+    return ret;
+}
+
+/**
+  @brief   Append a command to a batch, publishing the batch first if full
+
+  @param   smmu   - Pointer to the SMMU device structure
+  @param   batch  - Command batch
+  @param   opcode - Command opcode
+
+  @return  Pointer to the command in the batch for the caller to complete,
+           NULL on failure
+**/
+static uint64_t *smmu_cmdq_batch_add(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch, uint8_t opcode)
+{
+    uint64_t *cmd;
+
+    /* Publish a full batch, leaving room in the queue for the CMD_SYNC */
+    if (batch->num == SMMU_CMDQ_BATCH_MAX ||
+        batch->num + 1 >= (0x1ul << smmu->cmdq.queue.log2nent)) {
+        if (smmu_cmdq_batch_publish(smmu, batch))
+            return NULL;
+    }
+
+    cmd = &batch->cmds[batch->num * CMDQ_DWORDS_PER_ENT];
+    if (smmu_cmdq_build_cmd(cmd, opcode))
+        return NULL;
+
+    batch->num++;
+    return cmd;
+}
+
+/**
+  @brief   Publish a batch followed by one CMD_SYNC and wait for the sync
+
+  All commands and the sync are written to the queue memory first and made
+  visible to the SMMU with a single SMMU_CMDQ_PROD write.
+
+  @param   smmu   - Pointer to the SMMU device structure
+  @param   batch  - Command batch, emptied on return
+
+  @return  0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_submit(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    uint32_t index_mask = (0x1ul << cmdq->queue.log2nent) - 1;
+    uint64_t sync[CMDQ_DWORDS_PER_ENT];
+    uint64_t *sync_va;
+
+    if (smmu_cmdq_reserve(smmu, batch->num + 1)) {
+        batch->num = 0;
+        return -1;
+    }
+
+    smmu_cmdq_copy_cmds(smmu, batch->cmds, batch->num);
+    batch->num = 0;
+
+    sync_va = (uint64_t *)(cmdq->base + ((cmdq->queue.prod & index_mask) * cmdq->entry_size));
+    smmu_cmdq_build_sync(smmu, sync, sync_va);
+    smmu_cmdq_copy_cmds(smmu, sync, 1);
+
+#ifndef TARGET_LINUX
+    dmbsy();
+#endif
+    val_mmio_write((uint64_t)cmdq->prod_reg, cmdq->queue.prod);
+
+    return smmu_cmdq_wait_sync(smmu, sync_va);
 }
 
 static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
@@ -220,14 +390,14 @@ static uint32_t smmu_strtab_init_linear(smmu_dev_t *smmu)
     smmu_strtab_config_t *cfg = &smmu->strtab_cfg;
 
     size = (1 << smmu->sid_bits) * (STRTAB_STE_DWORDS << 3);
-    cfg->strtab_ptr = val_memory_calloc(2, size);
+    cfg->strtab_ptr = smmu_table_alloc(size, size);
     if (!cfg->strtab_ptr) {
         val_print(ERROR, "\n       Failed to allocate linear stream table.     ");
         return 0;
     }
 
-    cfg->strtab_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cfg->strtab_ptr), size);
-    cfg->strtab64 = (uint64_t*)align_to_size((uint64_t)cfg->strtab_ptr, size);
+    cfg->strtab_phys = (uint64_t)val_memory_virt_to_phys(cfg->strtab_ptr);
+    cfg->strtab64 = (uint64_t *)cfg->strtab_ptr;
     cfg->l1_ent_count = 1 << smmu->sid_bits;
     cfg->strtab_base_cfg = BITFIELD_SET(STRTAB_BASE_CFG_FMT, STRTAB_BASE_CFG_FMT_LINEAR) |
                            BITFIELD_SET(STRTAB_BASE_CFG_LOG2SIZE, smmu->sid_bits);
@@ -243,14 +413,14 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
     uint64_t cmdq_size = ((1 << cmdq->queue.log2nent) * CMDQ_DWORDS_PER_ENT) << 3;
 
     cmdq_size = (cmdq_size < 32)?32:cmdq_size;
-    cmdq->base_ptr = val_memory_calloc (2, cmdq_size);
+    cmdq->base_ptr = smmu_table_alloc(cmdq_size, cmdq_size);
     if (!cmdq->base_ptr) {
         val_print(ERROR, "\n       Failed to allocate Command queue struct.     ");
         return 0;
     }
 
-    cmdq->base_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cmdq->base_ptr), cmdq_size);
-    cmdq->base = (uint8_t*)align_to_size((uint64_t)cmdq->base_ptr, cmdq_size);
+    cmdq->base_phys = (uint64_t)val_memory_virt_to_phys(cmdq->base_ptr);
+    cmdq->base = (uint8_t *)cmdq->base_ptr;
 
     cmdq->prod_reg = (uint32_t*)(smmu->base + SMMU_CMDQ_PROD_OFFSET);
     cmdq->cons_reg = (uint32_t*)(smmu->base + SMMU_CMDQ_CONS_OFFSET);
@@ -269,15 +439,14 @@ static uint32_t smmu_evnt_queue_init(smmu_dev_t *smmu)
     smmu_evnt_queue_t *evntq = &smmu->evntq;
     uint64_t evntq_size = ((1 << evntq->queue.log2nent) * EVNTQ_DWORDS_PER_ENT) << 3;
     evntq_size = (evntq_size < 64)?64:evntq_size;
-    evntq->base_ptr = val_memory_calloc (1, evntq_size);
+    evntq->base_ptr = smmu_table_alloc(evntq_size, evntq_size);
     if (!evntq->base_ptr) {
         val_print(ERROR, "\n       Failed to allocate Event queue struct.");
         return 0;
     }
 
-    evntq->base_phys = align_to_size((uint64_t)val_memory_virt_to_phys(evntq->base_ptr),
-                                     evntq_size);
-    evntq->base = (uint8_t *)align_to_size((uint64_t)evntq->base_ptr, evntq_size);
+    evntq->base_phys = (uint64_t)val_memory_virt_to_phys(evntq->base_ptr);
+    evntq->base = (uint8_t *)evntq->base_ptr;
 
     evntq->prod_reg = (uint32_t *)(smmu->page1_base + SMMU_EVNTQ_PROD_OFFSET);
     evntq->cons_reg = (uint32_t *)(smmu->page1_base + SMMU_EVNTQ_CONS_OFFSET);
@@ -305,13 +474,13 @@ static void smmu_free_strtab(smmu_dev_t *smmu)
         for (i = 0; i < cfg->l1_ent_count; ++i)
         {
             if (cfg->l1_desc[i].l2ptr != NULL)
-                val_memory_free(cfg->l1_desc[i].l2ptr);
+                val_memory_free_aligned(cfg->l1_desc[i].l2ptr);
         }
 
         val_memory_free(cfg->l1_desc);
     }
 
-    val_memory_free(cfg->strtab_ptr);
+    val_memory_free_aligned(cfg->strtab_ptr);
 }
 
 /* Stream table manipulation functions */
@@ -340,15 +509,15 @@ static int smmu_strtab_init_level2(smmu_dev_t *smmu, uint32_t sid)
     strtab = &cfg->strtab64[(sid >> STRTAB_SPLIT) * STRTAB_L1_DESC_DWORDS];
 
     desc->span = STRTAB_SPLIT + 1;
-    desc->l2ptr = val_memory_calloc(2, size);
+    desc->l2ptr = smmu_table_alloc(size, size);
     if (!desc->l2ptr) {
         val_print(ERROR, "\n       failed to allocate l2 stream table for SID %u     ",
 sid);
         return 0;
     }
 
-    desc->l2desc_phys = align_to_size((uint64_t)val_memory_virt_to_phys(desc->l2ptr), size);
-    desc->l2desc64 = (uint64_t*)align_to_size((uint64_t)desc->l2ptr, size);
+    desc->l2desc_phys = (uint64_t)val_memory_virt_to_phys(desc->l2ptr);
+    desc->l2desc64 = (uint64_t *)desc->l2ptr;
 
     for (ste = desc->l2desc64, i = 0; i < (1 << STRTAB_SPLIT); ++i, ste += STRTAB_STE_DWORDS)
         smmu_strtab_write_ste(NULL, ste);
@@ -381,21 +550,21 @@ static int smmu_strtab_init_2level(smmu_dev_t *smmu)
     log2size += STRTAB_SPLIT;
 
     l1_tbl_size = cfg->l1_ent_count * STRTAB_L1_DESC_SIZE;
-    cfg->strtab_ptr = val_memory_alloc(2 * l1_tbl_size);
+    cfg->strtab_ptr = smmu_table_alloc(l1_tbl_size, l1_tbl_size);
     if (!cfg->strtab_ptr) {
         val_print(ERROR, "\n       failed to allocate l1 stream table     ");
         return 0;
     }
 
-    cfg->strtab_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cfg->strtab_ptr), l1_tbl_size);
-    cfg->strtab64 = (uint64_t*)align_to_size((uint64_t)cfg->strtab_ptr, l1_tbl_size);
+    cfg->strtab_phys = (uint64_t)val_memory_virt_to_phys(cfg->strtab_ptr);
+    cfg->strtab64 = (uint64_t *)cfg->strtab_ptr;
     cfg->strtab_base_cfg = BITFIELD_SET(STRTAB_BASE_CFG_FMT, STRTAB_BASE_CFG_FMT_2LVL) |
                            BITFIELD_SET(STRTAB_BASE_CFG_LOG2SIZE, log2size) |
                            BITFIELD_SET(STRTAB_BASE_CFG_SPLIT, STRTAB_SPLIT);
 
     ret = smmu_strtab_init_level1(smmu);
     if (!ret) {
-        val_memory_free(cfg->strtab_ptr);
+        val_memory_free_aligned(cfg->strtab_ptr);
         return 0;
     }
 
@@ -428,47 +597,64 @@ static uint32_t smmu_strtab_init(smmu_dev_t *smmu)
 static int smmu_reg_write_sync(smmu_dev_t *smmu, uint32_t val,
                    unsigned int reg_off, unsigned int ack_off)
 {
-    uint64_t timeout = 0x1000000;
+    val_deadline_t dl;
     uint32_t reg;
 
     val_mmio_write(smmu->base + reg_off, val);
 
-    while (timeout--) {
+    val_deadline_start(&dl, SMMU_SYNC_TIMEOUT_US);
+    do {
         reg = val_mmio_read(smmu->base + ack_off);
         if (reg == val) {
             return 0;
         }
-    }
+    } while (!val_deadline_expired(&dl));
 
     return 1;
 }
 
-static smmu_master_t *smmu_master_at(uint32_t sid)
+/**
+  @brief  Look up the master of a StreamID in the master directory of an SMMU.
+  @param  smmu  - SMMU the master sits behind.
+  @param  sid   - StreamID of the master, must be below (1 << smmu->sid_bits).
+  @param  alloc - if set, allocate directory levels and an empty master on a miss.
+  @return master, NULL if it does not exist and alloc is clear or allocation fails.
+**/
+static smmu_master_t *smmu_master_at(smmu_dev_t *smmu, uint32_t sid, uint32_t alloc)
 {
-    struct smmu_master_node *node = g_smmu_master_list_head;
+    smmu_master_dir_l1_t *l1;
+    smmu_master_t **slot;
+    uint32_t l1_count;
 
-    while (node != NULL)
+    if (smmu->master_dir == NULL)
     {
-        if (node->master->sid == sid)
-            return node->master;
-        node = node->next;
-    }
+        if (!alloc)
+            return NULL;
 
-    node = val_memory_alloc(sizeof(struct smmu_master_node));
-    if (node == NULL)
-        return NULL;
+        l1_count = (smmu->sid_bits > SMMU_MASTER_DIR_SPLIT) ?
+                   (1u << (smmu->sid_bits - SMMU_MASTER_DIR_SPLIT)) : 1;
+        smmu->master_dir = val_memory_calloc(l1_count, sizeof(smmu_master_dir_l1_t));
+        if (smmu->master_dir == NULL)
+            return NULL;
+        smmu->master_dir_l1_count = l1_count;
+    }
 
-    node->master = val_memory_calloc(1, sizeof(smmu_master_t));
-    if (node->master == NULL)
+    l1 = &smmu->master_dir[sid >> SMMU_MASTER_DIR_SPLIT];
+    if (l1->l2 == NULL)
     {
-        val_memory_free(node);
-        return NULL;
+        if (!alloc)
+            return NULL;
+
+        l1->l2 = val_memory_calloc(SMMU_MASTER_DIR_L2_ENTS, sizeof(smmu_master_t *));
+        if (l1->l2 == NULL)
+            return NULL;
     }
 
-    node->next = g_smmu_master_list_head;
-    g_smmu_master_list_head = node;
+    slot = &l1->l2[sid & (SMMU_MASTER_DIR_L2_ENTS - 1)];
+    if (*slot == NULL && alloc)
+        *slot = val_memory_calloc(1, sizeof(smmu_master_t));
 
-    return node->master;
+    return *slot;
 }
 
 // Event handler. Gives the info of the kind of event error generated.
@@ -656,16 +842,82 @@ static int smmu_dev_disable(smmu_dev_t *smmu)
 
 static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
 {
+    smmu_cmdq_batch_t batch = { .num = 0 };
+
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_ALL);
+    smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_CFGI_ALL);
     if (smmu->supported.hyp) {
-        smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_EL2_ALL);
+        smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_EL2_ALL);
     }
 
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_NSNH_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
+    smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_NSNH_ALL);
+    smmu_cmdq_batch_submit(smmu, &batch);
+}
 
-    smmu_cmdq_poll_until_consumed(smmu);
+/**
+  @brief   Queue CMD_CFGI_STE for one StreamID
+
+  @param   smmu   - Pointer to the SMMU device structure
+  @param   batch  - Command batch
+  @param   sid    - StreamID
+  @param   leaf   - 1 if only the STE changed, 0 if a level 1 descriptor changed too
+
+  @return  None
+**/
+static void smmu_cmdq_batch_cfgi_ste(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch,
+                                     uint32_t sid, uint32_t leaf)
+{
+    uint64_t *cmd = smmu_cmdq_batch_add(smmu, batch, CMDQ_OP_CFGI_STE);
+
+    if (cmd == NULL)
+        return;
+
+    cmd[0] |= BITFIELD_SET(CMDQ_CFGI_0_SID, (uint64_t)sid);
+    if (leaf)
+        cmd[1] |= CMDQ_CFGI_1_LEAF;
+}
+
+/**
+  @brief   Invalidate the cached configuration and TLB entries of one master
+
+  Stage 1 masters get CFGI_STE, CFGI_CD for their SubstreamID and
+  TLBI_NH_ASID for their ASID. Stage 2 masters get CFGI_STE and
+  TLBI_S12_VMALL for their VMID. Other masters of the SMMU keep their
+  cached state.
+
+  @param   master - Pointer to the master
+  @param   leaf   - 1 if only the STE changed, 0 if a level 1 descriptor changed too
+
+  @return  None
+**/
+static void smmu_tlbi_cfgi_master(smmu_master_t *master, uint32_t leaf)
+{
+    smmu_dev_t *smmu = master->smmu;
+    smmu_cmdq_batch_t batch = { .num = 0 };
+    uint64_t *cmd;
+
+    smmu_cmdq_batch_cfgi_ste(smmu, &batch, master->sid, leaf);
+
+    if (master->stage == SMMU_STAGE_S1) {
+        cmd = smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_CFGI_CD);
+        if (cmd) {
+            cmd[0] |= BITFIELD_SET(CMDQ_CFGI_0_SID, (uint64_t)master->sid) |
+                      BITFIELD_SET(CMDQ_CFGI_0_SSID, (uint64_t)master->ssid);
+            cmd[1] |= CMDQ_CFGI_1_LEAF;
+        }
+
+        cmd = smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_NH_ASID);
+        if (cmd)
+            cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_ASID,
+                                   (uint64_t)master->stage1_config.cd.asid);
+    } else if (master->stage == SMMU_STAGE_S2) {
+        cmd = smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_S12_VMALL);
+        if (cmd)
+            cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_VMID,
+                                   (uint64_t)master->stage2_config.vmid);
+    }
+
+    smmu_cmdq_batch_submit(smmu, &batch);
 }
 
 static int smmu_reset(smmu_dev_t *smmu)
@@ -740,15 +992,16 @@ static int smmu_reset(smmu_dev_t *smmu)
 **/
 static int smmu_gbpa_write_sync(smmu_dev_t *smmu, uint32_t gbpa_attrs)
 {
-    uint64_t timeout = SMMU_SYNC_TIMEOUT;
+    val_deadline_t dl;
     uint32_t gbpa;
 
     /* Must only write when Update == 0 */
-    while (timeout--) {
+    val_deadline_start(&dl, SMMU_SYNC_TIMEOUT_US);
+    do {
         gbpa = val_mmio_read(smmu->base + SMMU_GBPA_OFFSET);
         if ((gbpa & SMMU_GBPA_UPDATE) == 0)
             break;
-    }
+    } while (!val_deadline_expired(&dl));
 
     if (gbpa & SMMU_GBPA_UPDATE)
         return 1;
@@ -758,12 +1011,12 @@ static int smmu_gbpa_write_sync(smmu_dev_t *smmu, uint32_t gbpa_attrs)
                    gbpa_attrs | SMMU_GBPA_UPDATE);
 
     /* Poll until Update clears (update complete) */
-    timeout = SMMU_SYNC_TIMEOUT;
-    while (timeout--) {
+    val_deadline_start(&dl, SMMU_SYNC_TIMEOUT_US);
+    do {
         gbpa = val_mmio_read(smmu->base + SMMU_GBPA_OFFSET);
         if ((gbpa & SMMU_GBPA_UPDATE) == 0)
             return 0;
-    }
+    } while (!val_deadline_expired(&dl));
 
     return 1;
 }
@@ -862,6 +1115,12 @@ static uint32_t smmu_probe(smmu_dev_t *smmu)
     if (data & IDR0_S2P)
         smmu->supported.s2p = 1;
 
+    if (data & IDR0_MSI)
+        smmu->supported.msi = 1;
+
+    if (data & IDR0_COHACC)
+        smmu->supported.coherent = 1;
+
     if (!(data & (IDR0_S1P | IDR0_S2P))) {
         val_print(ERROR, "\nno translation support!");
         return 0;
@@ -959,14 +1218,15 @@ static int smmu_cdtab_alloc_leaf_table(smmu_cdtab_l1_ctx_desc_t *l1_desc)
 {
     uint64_t size = CDTAB_L2_ENTRY_COUNT * (CDTAB_CD_DWORDS << 3);
 
-    l1_desc->l2ptr = val_memory_alloc(size*2);
+    /* L1CD.L2Ptr holds address bits [51:12] */
+    l1_desc->l2ptr = smmu_table_alloc(size, 1ul << CDTAB_L1_DESC_L2PTR_SHIFT);
     if (!l1_desc->l2ptr) {
         val_print(ERROR, "\n       failed to allocate context descriptor table     ");
         return 1;
     }
 
-    l1_desc->l2desc_phys = align_to_size((uint64_t)val_memory_virt_to_phys(l1_desc->l2ptr), size);
-    l1_desc->l2desc64 = (uint64_t*)align_to_size((uint64_t)l1_desc->l2ptr, size);
+    l1_desc->l2desc_phys = (uint64_t)val_memory_virt_to_phys(l1_desc->l2ptr);
+    l1_desc->l2desc64 = (uint64_t *)l1_desc->l2ptr;
     return 0;
 }
 
@@ -1040,6 +1300,9 @@ static void smmu_cdtab_free(smmu_master_t *master)
     smmu_cdtab_config_t *cdcfg = &cfg->cdcfg;
     max_contexts = 1 << cfg->s1cdmax;
 
+    if (cdcfg->cdtab_ptr == NULL)
+        return;
+
     if (master->smmu->supported.cd2l &&
         max_contexts > CDTAB_L2_ENTRY_COUNT)
     {
@@ -1047,14 +1310,14 @@ static void smmu_cdtab_free(smmu_master_t *master)
         for (i = 0; i < num_l1_ents; i++)
         {
             if (cdcfg->l1_desc[i].l2ptr != NULL)
-                val_memory_free(cdcfg->l1_desc[i].l2ptr);
+                val_memory_free_aligned(cdcfg->l1_desc[i].l2ptr);
 
         }
 
         val_memory_free(cdcfg->l1_desc);
     }
 
-    val_memory_free(cdcfg->cdtab_ptr);
+    val_memory_free_aligned(cdcfg->cdtab_ptr);
     cdcfg->cdtab_ptr = NULL;
 }
 
@@ -1083,18 +1346,50 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         l1_tbl_size = cdmax * (CDTAB_CD_DWORDS << 3);
     }
 
-    cdcfg->cdtab_ptr = val_memory_calloc(2, l1_tbl_size);
+    /* STE.S1ContextPtr holds address bits [51:6] */
+    cdcfg->cdtab_ptr = smmu_table_alloc(l1_tbl_size, 1ul << STRTAB_STE_0_S1CONTEXTPTR_SHIFT);
     if (!cdcfg->cdtab_ptr) {
         val_print(ERROR, "\n       smmu_cdtab_alloc: alloc failed     ");
         return 0;
     }
 
-    cdcfg->cdtab_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cdcfg->cdtab_ptr), l1_tbl_size);
-    cdcfg->cdtab64 = (uint64_t*)align_to_size((uint64_t)cdcfg->cdtab_ptr, l1_tbl_size);
+    cdcfg->cdtab_phys = (uint64_t)val_memory_virt_to_phys(cdcfg->cdtab_ptr);
+    cdcfg->cdtab64 = (uint64_t *)cdcfg->cdtab_ptr;
 
     return 1;
 }
 
+static void smmu_master_dir_free(smmu_dev_t *smmu)
+{
+    smmu_master_t **l2;
+    uint32_t i, j;
+
+    if (smmu->master_dir == NULL)
+        return;
+
+    for (i = 0; i < smmu->master_dir_l1_count; i++)
+    {
+        l2 = smmu->master_dir[i].l2;
+        if (l2 == NULL)
+            continue;
+
+        for (j = 0; j < SMMU_MASTER_DIR_L2_ENTS; j++)
+        {
+            if (l2[j] == NULL)
+                continue;
+            if (l2[j]->smmu != NULL)
+                smmu_cdtab_free(l2[j]);
+            val_memory_free(l2[j]);
+        }
+
+        val_memory_free(l2);
+    }
+
+    val_memory_free(smmu->master_dir);
+    smmu->master_dir = NULL;
+    smmu->master_dir_l1_count = 0;
+}
+
 /**
   @brief - 1. Determine if stage 1 or stage 2 translation is needed.
            2. Populate stage1 or stage2 configuration data structures. Create and populate
@@ -1129,7 +1424,15 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         return 1;
     }
 
-    if ((master = smmu_master_at(master_attr.streamid)) == NULL)
+    if (master_attr.streamid >= (0x1ul << smmu->sid_bits))
+    {
+        val_print(ERROR,
+        "\n       val_smmu_map: sid %d out of range     ",
+        master_attr.streamid);
+        return 1;
+    }
+
+    if ((master = smmu_master_at(smmu, master_attr.streamid, 1)) == NULL)
         return 1;
 
     if (master->smmu == NULL)
@@ -1156,14 +1459,6 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         master->ssid = master_attr.substreamid;
     }
 
-    if (master_attr.streamid >= (0x1ul << smmu->sid_bits))
-    {
-        val_print(ERROR,
-        "\n       val_smmu_map: sid %d out of range     ",
-        master_attr.streamid);
-        return 1;
-    }
-
     if (smmu->supported.st_level_2lvl) {
         if(!smmu_strtab_init_level2(smmu, master->sid))
         {
@@ -1175,7 +1470,7 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
     if (master->stage == SMMU_STAGE_S2)
     {
         smmu_stage2_config_t *cfg = &master->stage2_config;
-        cfg->vmid = 0;
+        cfg->vmid = SMMU_MASTER_TLB_TAG(master->sid);
         cfg->vttbr = pgt_desc.pgt_base;
         cfg->vtcr = BITFIELD_SET(STRTAB_STE_2_VTCR_S2T0SZ, pgt_desc.tcr.tsz) |
                     BITFIELD_SET(STRTAB_STE_2_VTCR_S2SL0, pgt_desc.tcr.sl) |
@@ -1194,7 +1489,7 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
                 return 1;
         }
 
-        cfg->cd.asid = 0;
+        cfg->cd.asid = SMMU_MASTER_TLB_TAG(master->sid);
         cfg->cd.ttbr = pgt_desc.pgt_base;
         cfg->cd.tcr  = BITFIELD_SET(CDTAB_CD_0_TCR_T0SZ, pgt_desc.tcr.tsz) |
                        BITFIELD_SET(CDTAB_CD_0_TCR_TG0, pgt_desc.tcr.tg) |
@@ -1216,7 +1511,8 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
     if (acs_policy_get_print_level() <= TRACE)
         dump_strtab(ste);
 
-    smmu_tlbi_cfgi(smmu);
+    /* A new level 2 table may have been hooked into the level 1 table */
+    smmu_tlbi_cfgi_master(master, !smmu->supported.st_level_2lvl);
 
     return 0;
 }
@@ -1228,12 +1524,19 @@ uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master_attr, uint32_t
     smmu_dev_t *smmu;
     uint64_t *ste;
     uint32_t dcp_value;
+    smmu_cmdq_batch_t batch = { .num = 0 };
 
-    master = smmu_master_at(master_attr.streamid);
-    if (master == NULL)
+    if (g_smmu == NULL || master_attr.smmu_index >= g_num_smmus)
         return ACS_INVALID_INDEX;
 
     smmu = &g_smmu[master_attr.smmu_index];
+    if (master_attr.streamid >= (0x1ul << smmu->sid_bits))
+        return ACS_INVALID_INDEX;
+
+    master = smmu_master_at(smmu, master_attr.streamid, 0);
+    if (master == NULL || master->smmu == NULL)
+        return ACS_INVALID_INDEX;
+
     ste = smmu_strtab_get_ste_for_sid(smmu, master->sid);
 
     if (value == 1)
@@ -1241,6 +1544,10 @@ uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master_attr, uint32_t
     else
         ste[1] = ste[1] & BITFIELD_SET(STRTAB_STE_1_DCP, value);
 
+    /* Only the STE of this StreamID changed */
+    smmu_cmdq_batch_cfgi_ste(smmu, &batch, master->sid, 1);
+    smmu_cmdq_batch_submit(smmu, &batch);
+
     if (acs_policy_get_print_level() <= TRACE)
     {
         val_print(TRACE, "\n       Dump STE values");
@@ -1262,22 +1569,26 @@ uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master_attr, uint32_t
 void val_smmu_unmap(smmu_master_attributes_t master_attr)
 {
     smmu_master_t *master;
-    uint64_t *strtab;
+    smmu_dev_t *smmu;
+    uint64_t *ste;
 
-    if ((master = smmu_master_at(master_attr.streamid)) == NULL)
+    if (g_smmu == NULL || master_attr.smmu_index >= g_num_smmus)
         return;
 
-    if (master->smmu == NULL)
+    smmu = &g_smmu[master_attr.smmu_index];
+    if (smmu->base == 0 || master_attr.streamid >= (0x1ul << smmu->sid_bits))
         return;
 
-    if (master_attr.streamid >= (0x1ul << master->smmu->sid_bits))
+    master = smmu_master_at(smmu, master_attr.streamid, 0);
+    if (master == NULL || master->smmu == NULL)
         return;
 
-    strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
-    smmu_strtab_write_ste(NULL, strtab);
+    ste = smmu_strtab_get_ste_for_sid(smmu, master->sid);
+    smmu_strtab_write_ste(NULL, ste);
 
+    /* Drop cached copies of the STE and CD before the CD table is freed */
+    smmu_tlbi_cfgi_master(master, 1);
     smmu_cdtab_free(master);
-    smmu_tlbi_cfgi(master->smmu);
     val_memory_set(master, sizeof(smmu_master_t), 0);
 }
 
@@ -1306,11 +1617,11 @@ val_smmu_is_iova_mapped(uint32_t smmu_index, uint32_t streamid, uint64_t iova)
     if (smmu_index >= g_num_smmus)
         return 1;
 
-    master = smmu_master_at(streamid);
-    if (master == NULL || master->smmu == NULL)
+    if (g_smmu[smmu_index].base == 0 || streamid >= (0x1ul << g_smmu[smmu_index].sid_bits))
         return 1;
 
-    if (master->smmu != &g_smmu[smmu_index])
+    master = smmu_master_at(&g_smmu[smmu_index], streamid, 0);
+    if (master == NULL || master->smmu == NULL)
         return 1;
 
     if (master->stage != SMMU_STAGE_S1)
@@ -1389,9 +1700,10 @@ void val_smmu_stop(void)
             continue;
         smmu_dev_disable(smmu);
         if (smmu->cmdq.base_ptr)
-            val_memory_free(smmu->cmdq.base_ptr);
+            val_memory_free_aligned(smmu->cmdq.base_ptr);
         if (smmu->evntq.base_ptr)
-            val_memory_free(smmu->evntq.base_ptr);
+            val_memory_free_aligned(smmu->evntq.base_ptr);
+        smmu_master_dir_free(smmu);
         smmu_free_strtab(smmu);
     }
 
@@ -37,7 +37,10 @@ static inline uint64_t get_max(uint64_t x, uint64_t y)
 
 #define CMDQ_OP_CFGI_STE 0x3
 #define CMDQ_OP_CFGI_ALL 0x4
+#define CMDQ_OP_CFGI_CD 0x5
+#define CMDQ_OP_TLBI_NH_ASID 0x11
 #define CMDQ_OP_TLBI_EL2_ALL 0x20
+#define CMDQ_OP_TLBI_S12_VMALL 0x28
 #define CMDQ_OP_TLBI_NSNH_ALL 0x30
 #define CMDQ_OP_CMD_SYNC 0x46
 
@@ -47,6 +50,7 @@ typedef struct {
     uint32_t log2nent;
 } smmu_queue_t;
 
+/* queue.prod is the producer index last published to SMMU_CMDQ_PROD */
 typedef struct {
     smmu_queue_t queue;
     void    *base_ptr;
@@ -58,6 +62,14 @@ typedef struct {
     uint32_t *cons_reg;
 } smmu_cmd_queue_t;
 
+/* Commands collected in memory and published with one PROD update */
+#define SMMU_CMDQ_BATCH_MAX 64
+
+typedef struct {
+    uint64_t cmds[SMMU_CMDQ_BATCH_MAX * CMDQ_DWORDS_PER_ENT];
+    uint32_t num;
+} smmu_cmdq_batch_t;
+
 typedef struct {
     smmu_queue_t queue;
     void    *base_ptr;
@@ -120,6 +132,20 @@ typedef struct {
     uint32_t strtab_base_cfg;
 } smmu_strtab_config_t;
 
+/*
+ * Per-SMMU master directory indexed by StreamID. It mirrors the 2-level
+ * stream table: level 1 entries point to lazily allocated arrays of
+ * (1 << SMMU_MASTER_DIR_SPLIT) master pointers.
+ */
+#define SMMU_MASTER_DIR_SPLIT   STRTAB_SPLIT
+#define SMMU_MASTER_DIR_L2_ENTS (1 << SMMU_MASTER_DIR_SPLIT)
+
+struct smmu_master;
+
+typedef struct {
+    struct smmu_master **l2;
+} smmu_master_dir_l1_t;
+
 typedef struct {
     uint64_t base;
     uint64_t page1_base;
@@ -138,10 +164,13 @@ typedef struct {
            uint32_t s1p:1;
            uint32_t s2p:1;
            uint32_t msi:1;
+           uint32_t coherent:1;
         };
         uint32_t bitmap;
     } supported;
     uint64_t msi_address;
+    smmu_master_dir_l1_t *master_dir;
+    uint32_t master_dir_l1_count;
 } smmu_dev_t;
 
 typedef enum {
@@ -150,7 +179,14 @@ typedef enum {
     SMMU_STAGE_BYPASS
 } smmu_stage_t;
 
-typedef struct {
+/*
+ * ASID and VMID of a master are derived from its StreamID, so TLB entries of
+ * different masters can be invalidated separately. 8 bits fit the smallest
+ * ASID and VMID width, masters sharing a tag are invalidated together.
+ */
+#define SMMU_MASTER_TLB_TAG(sid) ((sid) & 0xFF)
+
+typedef struct smmu_master {
 #define MAX_PAGE_TABLES_PER_MASTER 8
     smmu_dev_t *smmu;
     smmu_stage_t stage;
@@ -161,9 +197,4 @@ typedef struct {
     uint32_t ssid_bits;
 } smmu_master_t;
 
-struct smmu_master_node {
-    smmu_master_t *master;
-    struct smmu_master_node *next;
-};
-
 #endif /*__SMMU_V3_H__ */
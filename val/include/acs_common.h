@@ -144,6 +144,9 @@ val_mmio_write64(addr_t addr, uint64_t data);
 uint32_t
 val_check_skip_module(uint32_t module_base);
 
+bool
+acs_is_module_enabled(uint32_t module_base);
+
 uint32_t
 val_initialize_test(uint32_t test_num, char8_t * desc, uint32_t num_pe);
 
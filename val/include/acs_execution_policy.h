@@ -25,22 +25,35 @@
  * acs_execution_policy_t captures shared runtime behavior knobs for one ACS
  * invocation. It contains only "how to run" inputs gathered from platform
  * defaults, build overrides, CLI parsing, or EL3-provided parameters:
- * - print verbosity and MMIO-print enablement
+ * - print verbosity, console verbosity and MMIO-print enablement
  * - PCIe/CXL behavior hints
- * - wakeup/watchdog/timer timeout controls
+ * - wakeup/watchdog/timer timeout controls and the deadline scale factor
  * - crypto-extension and EL1 trap workarounds
  * - system last-level cache hinting
+ * - secondary-PE dispatch mode (PSCI power-cycle or parked worker pool)
+ * - PCIe BDF table scan mode (exhaustive or topology pruned)
  */
 typedef struct acs_execution_policy {
     uint32_t pcie_p2p;
     uint32_t pcie_cache_present;
     bool     pcie_skip_dp_nic_ms;
     uint32_t print_level;
+    /*
+     * Minimum verbosity of records echoed to the console when a log file is
+     * open. The log file keeps print_level. 0 echoes every printed record.
+     */
+    uint32_t console_print_level;
     uint32_t print_mmio;
     uint32_t log_indent;
     uint32_t timeout_pass;
     uint32_t timeout_fail;
     uint32_t timer_timeout_us;
+    /*
+     * Percentage applied to every VAL polling deadline (val_deadline_start).
+     * 100 keeps the nominal values, larger values give slow models more time.
+     * 0 is treated as 100.
+     */
+    uint32_t timeout_scale;
     uint32_t crypto_support;
     /*
      * System last-level cache hint used by MPAM and related tests:
@@ -54,12 +67,29 @@ typedef struct acs_execution_policy {
      * not safely expose them. Compose with EL1SKIPTRAP_* flags.
      */
     uint32_t el1skiptrap_mask;
+    /*
+     * Keep secondary PEs parked in a WFE loop between payloads instead of
+     * PSCI CPU_ON/CPU_OFF for every dispatch. Opt-in, off by default.
+     */
+    bool     pe_pool;
+    /*
+     * Launch multi-PE payloads on large systems through a tree of wake-ups,
+     * where every woken PE wakes further PEs. Opt-in, off by default.
+     */
+    bool     pe_fanout;
+    /*
+     * Build the PCIe BDF table by following the bridge hierarchy and skipping
+     * functions 1-7 of single-function devices instead of probing every
+     * bus/device/function of each ECAM. Opt-in, off by default.
+     */
+    bool     pcie_pruned_scan;
 } acs_execution_policy_t;
 
 void acs_reset_execution_policy(void);
 acs_execution_policy_t *acs_get_execution_policy_mut(void);
 const acs_execution_policy_t *acs_get_execution_policy(void);
 uint32_t acs_policy_get_print_level(void);
+uint32_t acs_policy_get_console_print_level(void);
 uint32_t acs_policy_get_print_mmio(void);
 uint32_t acs_policy_get_log_indent(void);
 void acs_policy_set_log_indent(uint32_t indent);
@@ -69,8 +99,12 @@ bool acs_policy_get_pcie_skip_dp_nic_ms(void);
 uint32_t acs_policy_get_timeout_pass(void);
 uint32_t acs_policy_get_timeout_fail(void);
 uint32_t acs_policy_get_timer_timeout_us(void);
+uint32_t acs_policy_get_timeout_scale(void);
 uint32_t acs_policy_get_crypto_support(void);
 uint32_t acs_policy_get_sys_last_lvl_cache(void);
 uint32_t acs_policy_get_el1skiptrap_mask(void);
+bool acs_policy_get_pe_pool(void);
+bool acs_policy_get_pe_fanout(void);
+bool acs_policy_get_pcie_pruned_scan(void);
 
 #endif /* __ACS_EXECUTION_POLICY_H__ */
@@ -26,6 +26,16 @@
 #define MEM_MAP_FAILURE  0x2
 #define MEM_SIZE_64KB    65536
 
+/* Iterator over the unpopulated ranges of the memory info table */
+typedef struct {
+  uint32_t index;          /* Next memory info table entry to visit */
+  uint64_t cursor;         /* End of the ranges visited so far */
+  uint32_t include_holes;  /* Also return the gaps between described ranges */
+} val_mem_range_iter_t;
+
+void val_memory_range_iter_init(val_mem_range_iter_t *iter, uint32_t include_holes);
+uint32_t val_memory_range_iter_next(val_mem_range_iter_t *iter, addr_t *base, uint64_t *size);
+
 uint32_t val_memory_ioremap(void *addr, uint32_t size, uint32_t attr, void **baseptr);
 addr_t val_memory_get_addr(MEMORY_INFO_e mem_type, uint32_t instance, uint64_t *attr);
 
@@ -45,6 +55,9 @@ void val_memory_free_aligned(void *addr);
 void *val_memory_alloc_cacheable(uint32_t bdf, uint32_t size, void **pa);
 void val_memory_free_cacheable(uint32_t bdf, uint32_t size, void *va, void *pa);
 void val_mem_issue_dsb(void);
+uint32_t val_memory_leak_scope_begin(void);
+void val_memory_leak_scope_end(uint32_t scope);
+void val_memory_print_heap_stats(void);
 
 uint32_t val_memory_region_has_52bit_addr(void);
 uint32_t val_mmu_get_mapping_count(void);
@@ -78,6 +78,38 @@ typedef enum {
 #define MAX_CPBM_WIDTH      32768
 #define MAX_BWPBM_WIDTH     4096
 
+/* MPAM traffic generator access patterns */
+typedef enum {
+  MPAM_TRAFFIC_READ = 0,      /* LDP stream over the buffer */
+  MPAM_TRAFFIC_WRITE,         /* STP stream over the buffer */
+  MPAM_TRAFFIC_COPY,          /* LDP/STP stream from buffer to destination */
+  MPAM_TRAFFIC_COPY_NT,       /* LDNP/STNP stream from buffer to destination */
+  MPAM_TRAFFIC_STRIDE,        /* One load every stride bytes */
+  MPAM_TRAFFIC_CHASE          /* Dependent loads along a random cycle of stride sized nodes */
+} MPAM_TRAFFIC_MODE_e;
+
+#define MPAM_TRAFFIC_LINE_SIZE       64
+#define MPAM_TRAFFIC_DEF_STRIDE      MPAM_TRAFFIC_LINE_SIZE
+
+typedef struct {
+  MPAM_TRAFFIC_MODE_e mode;
+  uint64_t buf_base;       /* Source buffer, 64 byte aligned; 0 selects the PE shared buffer */
+  uint64_t buf_size;       /* Bytes of the source buffer walked per pass */
+  uint64_t dst_base;       /* Copy destination; 0 places it right after the source */
+  uint64_t stride;         /* Stride and chase node size; 0 selects MPAM_TRAFFIC_DEF_STRIDE */
+  uint64_t target_bytes;   /* Stop after this many bytes, 0 for no byte limit */
+  uint64_t duration_us;    /* Stop after this time, 0 for no time limit */
+  uint16_t partid;         /* PARTID carried by the traffic when set_partid is set */
+  uint8_t  pmg;            /* PMG carried by the traffic when set_partid is set */
+  uint8_t  set_partid;     /* 1 to program MPAM2_EL2 for the run, 0 to keep it */
+} MPAM_TRAFFIC_CFG_t;
+
+typedef struct {
+  uint64_t bytes;          /* Bytes moved, stride and chase count a cache line per access */
+  uint64_t ticks;          /* Generic timer ticks spent generating traffic */
+  uint64_t bytes_per_sec;  /* 0 if the generic timer could not be used */
+} MPAM_TRAFFIC_RESULT_t;
+
 void val_mpam_reg_write(MPAM_SYS_REGS reg_id, uint64_t write_data);
 uint64_t val_mpam_reg_read(MPAM_SYS_REGS reg_id);
 
@@ -108,6 +140,9 @@ void val_mem_free_at_address (uint64_t mem_base, uint64_t size);
 uint32_t val_alloc_shared_memcpybuf(uint64_t mem_base, uint64_t buffer_size, uint32_t pe_count);
 uint64_t val_get_shared_memcpybuf(uint32_t pe_index);
 void val_mem_free_shared_memcpybuf(uint32_t num_pe);
+uint32_t val_mpam_traffic_run(const MPAM_TRAFFIC_CFG_t *cfg, MPAM_TRAFFIC_RESULT_t *result);
+uint32_t val_mpam_traffic_run_all_pe(const MPAM_TRAFFIC_CFG_t *cfg, uint32_t num_pe,
+                                     MPAM_TRAFFIC_RESULT_t *total);
 uint32_t val_mpam_get_csumon_count(uint32_t msc_index);
 uint32_t val_mpam_supports_csumon(uint32_t msc_index);
 uint64_t val_mpam_memory_get_size(uint32_t msc_index, uint32_t rsrc_index);
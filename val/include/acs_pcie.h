@@ -165,7 +165,45 @@ typedef struct {
   pcie_device_attr device[];         ///< in the format of Segment/Bus/Dev/Func
 } pcie_device_bdf_table;
 
+/* Dense bus to config space base table of one segment, built from the ECAM
+   regions so that config accesses do not search the PCIe info table */
+typedef struct {
+  uint32_t segment;
+  uint32_t reserved;
+  addr_t   bus_base[PCIE_MAX_BUS];   ///< Config space of device 0 function 0, 0 if unmapped
+} pcie_ecam_lookup_seg;
+
+/* Capability IDs covered by the per-function capability directory, IDs
+   outside these ranges are searched in config space on every lookup */
+#define PCIE_CAP_DIR_NUM_CID   0x20
+#define PCIE_CAP_DIR_NUM_ECID  0x40
+
+typedef enum {
+  PCIE_CAP_DIR_STALE = 0,     ///< Rescanned on the next lookup
+  PCIE_CAP_DIR_VALID,
+  PCIE_CAP_DIR_UNCACHED       ///< Chain could not be walked cleanly, always search
+} PCIE_CAP_DIR_STATE_e;
+
+typedef struct {
+  uint32_t bdf;
+  uint32_t state;
+  uint32_t ecap_miss;         ///< Status returned for an absent extended capability
+  uint8_t  cap_offset[PCIE_CAP_DIR_NUM_CID];     ///< 0 if the capability is absent
+  uint16_t ecap_offset[PCIE_CAP_DIR_NUM_ECID];   ///< 0 if the capability is absent
+} pcie_cap_dir_entry;
+
+/* Capability directory of every function in g_pcie_bdf_table, with a hash
+   from BDF to directory index */
+typedef struct {
+  uint32_t num_entries;
+  uint32_t hash_size;         ///< Power of two, at least twice num_entries
+  uint32_t *hash;             ///< Directory index + 1, 0 if the slot is free
+  pcie_cap_dir_entry entry[];
+} pcie_cap_dir;
+
 void     val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
+uint32_t val_pcie_create_cap_dir(void);
+void     val_pcie_free_cap_dir(void);
 void     val_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 uint32_t val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
 uint32_t val_get_msi_vectors(uint32_t bdf, PERIPHERAL_VECTOR_LIST **mvector);
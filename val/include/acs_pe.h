@@ -209,6 +209,28 @@ typedef enum {
   ZCR_EL1,
 } BSA_ACS_PE_REGS;
 
+/* PE ID register snapshot, captured once on every PE and shared by tests.
+   Bump PE_ID_SNAPSHOT_VERSION whenever the register list or layout changes
+   so that dumps from different runs can be compared safely. */
+#define PE_ID_SNAPSHOT_VERSION        1
+#define PE_ID_SNAPSHOT_NUM_REGS       45
+#define PE_ID_SNAPSHOT_MAX_CACHE_LVL  7
+
+typedef struct {
+  uint32_t valid;                                  /* Set by the PE once captured */
+  uint32_t reserved;
+  uint64_t reg[PE_ID_SNAPSHOT_NUM_REGS];           /* Indexed as g_pe_id_snapshot_regs */
+  uint64_t ccsidr[PE_ID_SNAPSHOT_MAX_CACHE_LVL];   /* Data/unified CCSIDR per level */
+} PE_ID_SNAPSHOT_ENTRY;
+
+typedef struct {
+  uint32_t version;
+  uint32_t num_of_pe;
+  uint32_t num_of_regs;
+  uint32_t entry_size;
+  PE_ID_SNAPSHOT_ENTRY entry[];
+} PE_ID_SNAPSHOT_TABLE;
+
 uint64_t AA64WriteSp(uint64_t write_data);
 uint64_t AA64ReadSp(void);
 uint64_t ArmRdvl(void);
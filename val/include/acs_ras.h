@@ -41,6 +41,8 @@
 #define ERR_STATUS_CI_MASK  (0x1 << 19)
 #define ERR_STATUS_CLEAR    (0xFFF80000)
 
+#define RAS_WAIT_UNIT_US    1000   /* One val_ras_wait_timeout count (1ms) */
+
 #define ERR_CTLR_CLEAR_MASK     0x3FFD
 #define ERR_CTLR_ED_ENABLE      0x1
 #define ERR_CTLR_FHI_ENABLE     0x108ULL  /* Enable Fault Handling Interrupt */
@@ -59,6 +61,11 @@
 #define ERR_CTLR_OFFSET         0x008
 #define ERR_STATUS_OFFSET       0x010
 #define ERR_ADDR_OFFSET         0x018
+#define ERR_MISC0_OFFSET        0x020
+#define ERR_MISC1_OFFSET        0x028
+#define ERR_MISC2_OFFSET        0x030
+#define ERR_MISC3_OFFSET        0x038
+#define ERR_RECORD_SIZE         64
 #define ERR_PFGCTL_OFFSET       0x808
 #define ERR_PFGCDN_OFFSET       0x810
 #define ERR_ERRDEVAFF_OFFSET    0xFA8
@@ -66,6 +73,7 @@
 #define RAS_INTERFACE_SR        0x0
 #define RAS_INTERFACE_MMIO      0x1
 
+#define RAS_VERSION_1P1         0x2
 #define RAS_VERSION_2           0x3
 
 #define FEAT_ANERR_VAL2      0x2
@@ -106,6 +114,13 @@ typedef enum {
     RAS_INFO_PE_FLAG             /* Resource Flag for RAS PE Node */
 } RAS_INFO_TYPE;
 
+/* Registers of one error record captured by val_ras_snapshot_node */
+typedef struct {
+    uint64_t status;
+    uint64_t addr;
+    uint64_t misc[4];
+} RAS_ERR_REC_SNAPSHOT;
+
 uint32_t val_ras_setup_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param);
 uint32_t val_ras_inject_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param);
 void val_ras_wait_timeout(uint32_t count);
@@ -116,6 +131,8 @@ uint32_t val_ras_check_plat_poison_support(void);
 uint64_t val_ras_reg_read(uint32_t node_index, uint32_t reg, uint32_t err_rec_idx);
 void val_ras_reg_write(uint32_t node_index, uint32_t reg, uint64_t write_data);
 void val_ras_clear_error_status(uint32_t node_index, uint8_t is_pfg_check);
+uint32_t val_ras_snapshot_node(uint32_t node_index, RAS_ERR_REC_SNAPSHOT *snapshot,
+                               uint32_t max_recs);
 
 uint32_t ras001_entry(uint32_t num_pe);
 uint32_t ras002_entry(uint32_t num_pe);
@@ -30,6 +30,58 @@ typedef struct {
   uint32_t    status;
 }VAL_SHARED_MEM_t;
 
+/* Secondary PE states tracked in the PE pool mailbox */
+#define PE_POOL_STATE_OFF      0x0   /* PE powered off, must be woken through PSCI */
+#define PE_POOL_STATE_PARKED   0x1   /* PE idle in WFE, waiting for a new request */
+#define PE_POOL_STATE_BUSY     0x2   /* PE executing a dispatched payload */
+#define PE_POOL_STATE_WAKING   0x3   /* PE woken through PSCI, not parked yet */
+
+/* Requests posted by the primary PE to a parked secondary PE */
+#define PE_POOL_CMD_RUN        0x1   /* Execute payload from VAL_SHARED_MEM_t */
+#define PE_POOL_CMD_EXIT       0x2   /* Leave the pool and power off through PSCI */
+
+#define PE_POOL_EXIT_TIMEOUT_US  1000000   /* Deadline for a PE to leave the pool (1s) */
+#define PE_POOL_PARK_TIMEOUT_US  1000000   /* Deadline for a PE to return to the pool (1s) */
+
+#define VAL_PE_MAILBOX_ALIGN   64
+
+/* Per-PE mailbox, one cache line each, used when secondary PEs are kept parked
+   and to hand the fan-out launch key to a woken PE */
+typedef struct {
+  uint32_t    seq;      /* Incremented by primary PE for every posted request */
+  uint32_t    cmd;      /* PE_POOL_CMD_* */
+  uint32_t    state;    /* PE_POOL_STATE_* */
+  uint32_t    fanout_seq; /* Fan-out launch the PE was woken for, 0 if none */
+  uint8_t     pad[VAL_PE_MAILBOX_ALIGN - 16];
+}VAL_PE_MAILBOX_t;
+
+/* Tree-structured launch of a payload on many PEs */
+#define PE_FANOUT_DEGREE       4   /* PEs woken by each node of the tree */
+#define PE_FANOUT_MIN_PE       8   /* Below this a serial launch is as fast */
+#define PE_FANOUT_SLOTS        2   /* Descriptors, used in turn by successive launches */
+
+/* Fan-out descriptor, read by every woken PE to find its children */
+typedef struct {
+  uint64_t    payload;
+  uint64_t    arg;
+  uint32_t    root;     /* Index of the PE at the top of the tree */
+  uint32_t    num_pe;   /* Payload runs on PE index [0, num_pe) */
+  uint32_t    degree;
+  uint32_t    active;   /* Set while a fan-out launch is in progress */
+  uint32_t    seq;      /* Launch key, never 0, selects slot seq % PE_FANOUT_SLOTS */
+  uint32_t    reserved;
+}VAL_PE_FANOUT_t;
+
+/* Number of 64-bit words in the PE completion bitmap */
+#define PE_COMPLETION_WORDS(num_pe)  (((num_pe) + 63) / 64)
+
+/* CNTKCTL event stream used to bound WFE while waiting for PE completion.
+   CNTHCTL_EL2 uses the same EVNTEN/EVNTI layout for the EL2 event stream. */
+#define CNTKCTL_EVNTEN        (1ull << 2)
+#define CNTKCTL_EVNTI_SHIFT   4
+#define CNTKCTL_EVNTI_MASK    (0xFull << CNTKCTL_EVNTI_SHIFT)
+#define PE_COMPLETION_EVNTI   15   /* Event every 2^16 counter ticks */
+
 uint64_t
 val_pe_reg_read(uint32_t reg_id);
 
@@ -789,6 +789,9 @@ uint32_t pal_mem_set_wb_executable(void *addr, uint32_t size);
 
 /* Common Definitions */
 void     pal_print(uint64_t data);
+void     pal_print_console(uint64_t data);
+uint32_t pal_log_file_present(void);
+uint32_t pal_log_file_write(uint64_t data, uint32_t size);
 void     pal_uart_print(int log, const char *fmt, ...);
 void     pal_print_raw(uint64_t addr, char8_t *string, uint64_t data);
 void     pal_uart_putc(char c);
@@ -823,6 +826,10 @@ void     pal_mem_free_aligned(void *buffer);
 void    *pal_mem_alloc_cacheable(uint32_t bdf, uint32_t size, void **pa);
 void     pal_mem_free_cacheable(uint32_t bdf, unsigned int size, void *va, void *pa);
 
+#ifdef TARGET_BAREMETAL
+#include "pal_mem_stats.h"
+#endif
+
 uint32_t pal_mmio_read(uint64_t addr);
 uint64_t pal_mmio_read64(uint64_t addr);
 void     pal_mmio_write8(uint64_t addr, uint8_t data);
@@ -1317,8 +1324,8 @@ typedef union {
 
 /* VAL polling policy for PCC channel ownership and command completion. */
 #define PCC_COMMAND_TIMEOUT_USEC      100000U
-#define PCC_POLL_INTERVAL_USEC        1000U
 #define PCC_STATUS_SUCCESS            0U
+#define PCC_STATUS_PENDING            1U
 
 void pal_pcc_create_info_table(PCC_INFO_TABLE *PccInfoTable);
 void pal_pcc_store_info(uint32_t subspace_idx);
@@ -1445,7 +1452,6 @@ void pal_ras_create_info_table(RAS_INFO_TABLE *ras_info_table);
 
 uint32_t pal_ras_setup_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param);
 uint32_t pal_ras_inject_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param);
-void pal_ras_wait_timeout(uint32_t count);
 uint32_t pal_ras_check_plat_poison_support(void);
 
 typedef struct {
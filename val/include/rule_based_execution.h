@@ -28,6 +28,12 @@
 #define INVALID_IDX 0xFFFFFFFF
 #define RULE_REFERENCE_PATH_MAX_DEPTH 10
 
+/* Bitsets keyed by RULE_ID_e or MODULE_NAME_e, used for rule list filtering */
+#define RULE_BITMAP_WORDS       ((RULE_ID_SENTINEL + 31) / 32)
+#define MODULE_BITMAP_WORDS     ((MODULE_ID_SENTINEL + 31) / 32)
+#define ACS_BITMAP_SET(map, bit)  ((map)[(bit) / 32] |= (1u << ((bit) % 32)))
+#define ACS_BITMAP_TEST(map, bit) (((map)[(bit) / 32] >> ((bit) % 32)) & 1u)
+
 /* ----------------------------  Struct  Definations --------------------------------------------*/
 
 typedef uint32_t (*test_entry_fn_t)(uint32_t);
@@ -93,6 +99,7 @@ void     print_rule_test_start(uint32_t rule_enum, uint32_t indent);
 void     print_rule_test_status(uint32_t rule_enum, uint32_t indent, uint32_t status);
 void     rule_status_map_reset(void);
 bool     rule_in_list(RULE_ID_e rid, const RULE_ID_e *list, uint32_t count);
+RULE_ID_e rule_id_lookup_by_name(const char8_t *name);
 void     print_pal_validation_info(uint32_t rule_enum, uint32_t indent);
 void     rule_reference_path_reset(void);
 bool     rule_reference_path_contains(RULE_ID_e rule_id);
@@ -35,21 +35,66 @@
 #define ACS_STATUS_PASS    STATUS_SUCCESS
 #define ACS_STATUS_SKIP    STATUS_SKIP
 #define ACS_STATUS_UNKNOWN STATUS_UNKNOWN
+/*
+ * ACS_PRINT_MIN_LEVEL is the lowest print verbosity compiled into the image
+ * (1 = TRACE ... 6 = FATAL). val_print calls below it fold to nothing,
+ * argument evaluation included. The runtime -v level still applies on top.
+ */
+#ifndef ACS_PRINT_MIN_LEVEL
+#define ACS_PRINT_MIN_LEVEL 1
+#endif
+
+#define VAL_PRINT_ENABLED(level)                  \
+    ((level) >= ACS_PRINT_MIN_LEVEL &&            \
+     (level) >= acs_policy_get_print_level())
+
 /*
  * Note: val_print can be overridden by defining FAST_PRINT_ENABLE in
  * platform_override_fvp.h, provided a FASTPRINT implementation is available
  * in the PAL layer.
+ *
+ * With ACS_PRINT_DEFERRED, val_print on the primary PE only records a copy of
+ * the format string, up to 8 raw arguments and copies of the %s strings in a
+ * record buffer. Records are formatted when val_log_flush() runs. Secondary
+ * PEs format their prints directly.
  */
 #if defined(TARGET_BAREMETAL) && defined(FAST_PRINT_ENABLE)
 #define val_print(level, ...)                         \
     do {                                              \
-        if ((level) >= acs_policy_get_print_level())  \
+        if (VAL_PRINT_ENABLED(level))                 \
             pal_vfastprint(__VA_ARGS__);              \
     } while (0)
+#elif defined(ACS_PRINT_DEFERRED)
+#define VAL_LOG_CAT_(a, b) a##b
+#define VAL_LOG_CAT(a, b) VAL_LOG_CAT_(a, b)
+#define VAL_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define VAL_LOG_NARGS(...) VAL_LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define VAL_LOG_ARG(x) (uint64_t)(uintptr_t)(x)
+#define VAL_LOG_ARGS_0()
+#define VAL_LOG_ARGS_1(a) , VAL_LOG_ARG(a)
+#define VAL_LOG_ARGS_2(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_1(__VA_ARGS__)
+#define VAL_LOG_ARGS_3(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_2(__VA_ARGS__)
+#define VAL_LOG_ARGS_4(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_3(__VA_ARGS__)
+#define VAL_LOG_ARGS_5(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_4(__VA_ARGS__)
+#define VAL_LOG_ARGS_6(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_5(__VA_ARGS__)
+#define VAL_LOG_ARGS_7(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_6(__VA_ARGS__)
+#define VAL_LOG_ARGS_8(a, ...) , VAL_LOG_ARG(a) VAL_LOG_ARGS_7(__VA_ARGS__)
+
+#define VAL_LOG_DEFER(level, fmt, ...)                                        \
+    val_log_defer((level), (const char *)(fmt), VAL_LOG_NARGS(__VA_ARGS__),   \
+                  (const uint64_t []){ 0                                      \
+                      VAL_LOG_CAT(VAL_LOG_ARGS_, VAL_LOG_NARGS(__VA_ARGS__))  \
+                      (__VA_ARGS__) } + 1)
+
+#define val_print(level, ...)                     \
+    do {                                          \
+        if (VAL_PRINT_ENABLED(level))             \
+            VAL_LOG_DEFER((level), __VA_ARGS__);  \
+    } while (0)
 #else
 #define val_print(level, ...)                     \
     do {                                          \
-        if ((level) >= acs_policy_get_print_level()) \
+        if (VAL_PRINT_ENABLED(level))             \
             val_printf((level), __VA_ARGS__);     \
     } while (0)
 #endif
@@ -71,6 +116,12 @@
                                                           by default for wakeup & WD tests (1ms)*/
 #define TIMER_TIMEOUT_DEFAULT                   1000000   /*minimum timeout set
                                                           by default for timer tests (1s)*/
+#define PE_COMPLETION_TIMEOUT_US                10000000  /*deadline for secondary PEs
+                                                          to report test status (10s)*/
+#define INTR_WAIT_TIMEOUT_US                    1000000   /*deadline for an interrupt
+                                                          handler to report status (1s)*/
+#define DEADLINE_SCALE_DEFAULT                  100       /*percentage applied to every
+                                                          VAL deadline (-timeout_scale)*/
 
 /* EL1 skip-trap param defines (-el1skiptrap) */
 #define EL1SKIPTRAP_PMSIDR   (1u << 0)
@@ -103,6 +154,12 @@ typedef char char8_t;
 /* GENERIC VAL APIs */
 void val_allocate_shared_mem(void);
 uintptr_t val_get_status_region_base(void);
+uintptr_t val_get_pe_mailbox_region_base(void);
+uintptr_t val_get_pe_completion_region_base(void);
+uintptr_t val_get_pe_fanout_region_base(void);
+void val_pe_completion_reset(void);
+void val_pe_completion_signal(uint32_t index);
+uint32_t val_pe_completion_wait(uint32_t num_pe, uint32_t timeout_us);
 void val_free_shared_mem(void);
 //void val_print(uint32_t level, char8_t *string, uint64_t data);
 void val_print_raw(uint64_t uart_addr, uint32_t level, char8_t *string, uint64_t data);
@@ -123,6 +180,30 @@ uint32_t execute_tests(void);
 uint64_t val_time_delay_ms(uint64_t time_ms);
 uint64_t val_get_platform_time_us(void);
 
+/* Deadline APIs. Nominal microsecond deadlines, scaled by -timeout_scale */
+typedef struct {
+  uint64_t start;        /* CNTPCT at arm time, or elapsed microseconds in poll-count mode */
+  uint64_t ticks;        /* Deadline in counter ticks, or in microseconds in poll-count mode */
+  uint32_t use_counter;  /* 1 when the deadline is measured with the generic timer */
+} val_deadline_t;
+
+/* Wait between two probes of val_poll_until */
+#define DEADLINE_BACKOFF_NONE   0   /* Spin */
+#define DEADLINE_BACKOFF_WFE    1   /* WFE, woken by SEV or the generic timer event stream */
+#define DEADLINE_BACKOFF_DELAY  2   /* val_time_delay_ms, doubled up to DEADLINE_DELAY_MAX_US */
+
+#define DEADLINE_DELAY_MIN_US   1
+#define DEADLINE_DELAY_MAX_US   1000
+
+void val_deadline_start(val_deadline_t *dl, uint64_t timeout_us);
+void val_deadline_start_unscaled(val_deadline_t *dl, uint64_t timeout_us);
+uint32_t val_deadline_expired(val_deadline_t *dl);
+void val_deadline_wait(uint64_t timeout_us);
+uint32_t val_poll_until(uint32_t (*cond)(void *arg), void *arg, uint64_t timeout_us,
+                        uint32_t backoff);
+uint32_t val_pe_status_wait(uint32_t index, uint64_t timeout_us);
+uint32_t val_flag_wait(volatile uint32_t *flag, uint32_t value, uint64_t timeout_us);
+
 /* VAL PE APIs */
 typedef enum {
   PE_FEAT_MPAM,
@@ -135,6 +216,9 @@ void     val_pe_cache_clean_invalidate_range(uint64_t start_addr, uint64_t lengt
 void     val_pe_cache_invalidate_range(uint64_t start_addr, uint64_t length);
 void     val_pe_free_info_table(void);
 void     val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t args);
+void     val_pe_pool_release(void);
+uint32_t val_pe_fanout_execute(uint32_t num_pe, void (*payload)(void), uint64_t test_input);
+void     val_pe_fanout_complete(void);
 void     val_smbios_create_info_table(uint64_t *smbios_info_table);
 void     val_smbios_free_info_table(void);
 
@@ -160,6 +244,13 @@ uint32_t val_bsa_pe_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
 uint32_t val_pe_get_index_uid(uint32_t uid);
 uint32_t val_pe_get_uid(uint64_t mpidr);
 uint32_t val_pe_feat_check(PE_FEAT_NAME pe_feature);
+uint32_t val_pe_id_snapshot_create(void);
+void     val_pe_id_snapshot_free(void);
+void     val_pe_id_snapshot_dump(void);
+uint32_t val_pe_id_snapshot_valid(uint32_t index);
+uint32_t val_pe_id_snapshot_read(uint32_t index, uint32_t reg_id, uint64_t *value);
+uint32_t val_pe_id_snapshot_read_ccsidr(uint32_t index, uint32_t level, uint64_t *value);
+uint64_t val_pe_id_reg_read(uint32_t reg_id);
 
 uint32_t val_get_device_path(const char *hid, char hid_path[][MAX_NAMED_COMP_LENGTH]);
 uint32_t val_smmu_is_etr_behind_catu(char *etr_path);
@@ -308,6 +399,7 @@ uint32_t val_pcie_is_onchip_peripheral(uint32_t bdf);
 uint32_t val_pcie_device_port_type(uint32_t bdf);
 uint32_t val_pcie_find_capability(uint32_t bdf, uint32_t cid_type,
                                            uint32_t cid, uint32_t *cid_offset);
+void     val_pcie_invalidate_cap_cache(uint32_t bdf);
 uint32_t val_pcie_is_msa_enabled(uint32_t bdf);
 uint32_t val_pcie_is_urd(uint32_t bdf);
 uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bf_entry);
@@ -692,6 +784,10 @@ uint32_t val_pcbsa_tpm2_execute_tests(uint32_t level, uint32_t num_pe);
 /* PCC related APIs */
 void val_pcc_create_info_table(uint64_t *pcc_info_table);
 void *val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size);
+uint32_t val_pcc_cmd_submit(uint32_t subspace_id, uint32_t command, void *data,
+                            uint32_t data_size);
+uint32_t val_pcc_cmd_poll(uint32_t subspace_id);
+void *val_pcc_cmd_complete(uint32_t subspace_id);
 uint32_t val_pcc_get_ss_info_idx(uint32_t subspace_id);
 uint32_t val_pcc_map_registers(uint32_t subspace_id);
 void val_pcc_free_info_table(void);
@@ -24,11 +24,13 @@ extern "C" {
 
 #include "pal_interface.h"
 
-int val_memory_compare(void *s1, void *s2, uint32_t len);
+int val_memory_compare(void *s1, void *s2, uint64_t len);
 
-void *val_memcpy(void *dst, void *src, uint32_t len);
+void *val_memcpy(void *dst, void *src, uint64_t len);
 
-void val_memory_set(void *dst, uint32_t size, uint8_t value);
+void val_memory_set(void *dst, uint64_t size, uint8_t value);
+
+void val_memory_zero(void *dst, uint64_t size);
 
 uint32_t val_strncmp(char8_t *str1, char8_t *str2, uint32_t length);
 
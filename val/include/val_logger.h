@@ -20,6 +20,9 @@ typedef enum {
     FATAL
 } print_verbosity_t;
 
+/* Raw arguments kept per deferred record, matches VAL_LOG_ARGS_<n> in val_interface.h */
+#define VAL_LOG_DEFER_MAX_ARGS 8
+
 /**
  *   @brief    - This function prints the given string and data onto the uart
  *   @param    - verbosity  : Print Verbosity level
@@ -28,6 +31,8 @@ typedef enum {
  *   @return   - SUCCESS((Any positive number for character written)/FAILURE(0))
 **/
 uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...);
+void val_log_flush(void);
+void val_log_defer(uint32_t verbosity, const char *fmt, uint32_t nargs, const uint64_t *args);
 uint32_t val_log_get_indent(void);
 void val_log_set_indent(uint32_t indent);
 
@@ -17,6 +17,10 @@ RENAME_SYSREG_RW_FUNCS(erxctlr_el1, ERXCTLR_EL1)
 RENAME_SYSREG_RW_FUNCS(erxstatus_el1, ERXSTATUS_EL1)
 RENAME_SYSREG_RW_FUNCS(erxaddr_el1, ERXADDR_EL1)
 
+/* ERXMISC2/3_EL1 are RASv1p1, use the encodings for older assemblers */
+RENAME_SYSREG_READ_FUNC(erxmisc2_el1, S3_0_C5_C5_2)
+RENAME_SYSREG_READ_FUNC(erxmisc3_el1, S3_0_C5_C5_3)
+
 SYSREG_READ_FUNC(erxpfgf_el1)
 SYSREG_RW_FUNCS(erxpfgctl_el1)
 SYSREG_RW_FUNCS(erxpfgcdn_el1)
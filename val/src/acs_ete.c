@@ -73,10 +73,13 @@ uint64_t parse_tracestream(uint8_t *trace_bytes, uint64_t trace_size)
 
     /* Iterate through trace stream bytes until all are parsed */
     while (byte_index < trace_size) {
-        val_print_primary_pe(DEBUG, "\n       byte_value: %d ",
+        /* Per-byte prints, keep the calls out of the loop when not printed */
+        if (VAL_PRINT_ENABLED(DEBUG)) {
+            val_print_primary_pe(DEBUG, "\n       byte_value: %d ",
                                                          trace_bytes[byte_index], pe_index);
-        val_print_primary_pe(DEBUG, "\n       Trace index of the byte value: %d ",
+            val_print_primary_pe(DEBUG, "\n       Trace index of the byte value: %d ",
                                                          byte_index, pe_index);
+        }
 
         /* Identify and handle packet type based on current header packet byte */
         switch (trace_bytes[byte_index]) {
@@ -29,6 +29,7 @@ void acs_reset_execution_policy(void)
         .timeout_fail = WAKEUP_WD_PASS_TIMEOUT_DEFAULT *
                         WAKEUP_WD_FAILSAFE_TIMEOUT_MULTIPLIER,
         .timer_timeout_us = TIMER_TIMEOUT_DEFAULT,
+        .timeout_scale = DEADLINE_SCALE_DEFAULT,
         .crypto_support = 1u,
     };
 }
@@ -48,6 +49,11 @@ uint32_t acs_policy_get_print_level(void)
     return g_execution_policy.print_level;
 }
 
+uint32_t acs_policy_get_console_print_level(void)
+{
+    return g_execution_policy.console_print_level;
+}
+
 uint32_t acs_policy_get_print_mmio(void)
 {
     return g_execution_policy.print_mmio;
@@ -93,6 +99,14 @@ uint32_t acs_policy_get_timer_timeout_us(void)
     return g_execution_policy.timer_timeout_us;
 }
 
+uint32_t acs_policy_get_timeout_scale(void)
+{
+    if (g_execution_policy.timeout_scale == 0)
+        return DEADLINE_SCALE_DEFAULT;
+
+    return g_execution_policy.timeout_scale;
+}
+
 uint32_t acs_policy_get_crypto_support(void)
 {
     return g_execution_policy.crypto_support;
@@ -107,3 +121,18 @@ uint32_t acs_policy_get_el1skiptrap_mask(void)
 {
     return g_execution_policy.el1skiptrap_mask;
 }
+
+bool acs_policy_get_pe_pool(void)
+{
+    return g_execution_policy.pe_pool;
+}
+
+bool acs_policy_get_pe_fanout(void)
+{
+    return g_execution_policy.pe_fanout;
+}
+
+bool acs_policy_get_pcie_pruned_scan(void)
+{
+    return g_execution_policy.pcie_pruned_scan;
+}
@@ -20,10 +20,31 @@
 #include "acs_iovirt.h"
 #include "acs_smmu.h"
 #include "acs_mmu.h"
+#include "acs_memory.h"
 
 IOVIRT_INFO_TABLE *g_iovirt_info_table;
 uint32_t g_num_smmus;
 
+/* RID range of a root complex with the IDs it resolves to through the IORT */
+typedef struct {
+  uint32_t segment;
+  uint32_t rid_base;
+  uint32_t rid_last;     /* Inclusive */
+  uint32_t sid_base;     /* ~0 when the RC maps straight to an ITS group */
+  uint32_t did_base;
+  uint32_t smmu_index;   /* ACS_INVALID_INDEX when not behind an SMMU */
+  uint32_t its_id;
+  uint32_t status;       /* IOVIRT_RID_* */
+} IOVIRT_RID_RANGE;
+
+#define IOVIRT_RID_RESOLVED      0
+#define IOVIRT_RID_NO_DEVICE_ID  1   /* Stream ID not covered by any SMMU ID mapping */
+#define IOVIRT_RID_BAD_OUTPUT    2   /* RC output reference is not an SMMU or ITS group */
+
+static IOVIRT_RID_RANGE *g_iovirt_rid_map;
+static uint32_t g_iovirt_rid_map_count;
+static uint32_t g_iovirt_rid_map_overlap;
+
 /**
   @brief   This API is a single point of entry to retrieve
            SMMU information stored in the IoVirt Info table
@@ -145,6 +166,242 @@ val_iovirt_get_pcie_rc_info(PCIE_RC_INFO_e type, uint32_t index)
 
 }
 
+/**
+  @brief   Return the index of the SMMU block with the given base address
+
+  @param   smmu_base  SMMU base address
+
+  @return  SMMU index, or ACS_INVALID_INDEX if no SMMU has this base
+**/
+static uint32_t
+val_iovirt_smmu_base_to_index(uint64_t smmu_base)
+{
+  uint32_t num_smmu = g_iovirt_info_table->num_smmus;
+
+  /* Highest index wins, matching the per-call lookup */
+  while (num_smmu--) {
+      if (smmu_base == val_iovirt_get_smmu_info(SMMU_CTRL_BASE, num_smmu))
+          return num_smmu;
+  }
+
+  return ACS_INVALID_INDEX;
+}
+
+/**
+  @brief   Resolve one RC ID mapping into RID ranges with their final IDs.
+           An RC mapping behind an SMMU is split wherever a different SMMU
+           ID mapping takes over, so each range translates linearly.
+
+  @param   rc      Root complex block owning the mapping
+  @param   map     RC ID mapping to resolve
+  @param   ranges  Output array, or NULL to only count the ranges
+  @param   count   Number of ranges already in the array
+
+  @return  Updated number of ranges
+**/
+static uint32_t
+val_iovirt_resolve_rc_map(IOVIRT_BLOCK *rc, ID_MAP *map, IOVIRT_RID_RANGE *ranges,
+                          uint32_t count)
+{
+  uint32_t k, j;
+  uint32_t smmu_index;
+  uint64_t cur, last, end, map_last;
+  IOVIRT_BLOCK *out, *its;
+  NODE_DATA_MAP *smap;
+  IOVIRT_RID_RANGE range;
+
+  out = (IOVIRT_BLOCK *)((uint8_t *)g_iovirt_info_table + map->output_ref);
+
+  range.segment    = rc->data.rc.segment;
+  range.rid_base   = map->input_base;
+  range.rid_last   = map->input_base + map->id_count;
+  range.sid_base   = ~((uint32_t)0);
+  range.did_base   = map->output_base;
+  range.smmu_index = ACS_INVALID_INDEX;
+  range.its_id     = 0;
+  range.status     = IOVIRT_RID_RESOLVED;
+
+  if (out->type != IOVIRT_NODE_SMMU && out->type != IOVIRT_NODE_SMMU_V3) {
+      if (out->type == IOVIRT_NODE_ITS_GROUP)
+          range.its_id = out->data_map[0].id[0];
+      else
+          range.status = IOVIRT_RID_BAD_OUTPUT;
+
+      if (ranges)
+          ranges[count] = range;
+      return count + 1;
+  }
+
+  /* Output is a Stream ID; walk the SID span across the SMMU ID mappings */
+  smmu_index = val_iovirt_smmu_base_to_index(out->data.smmu.base);
+  cur = map->output_base;
+  last = (uint64_t)map->output_base + map->id_count;
+  while (cur <= last) {
+      /* The first SMMU mapping covering 'cur' is the one a lookup would pick */
+      for (k = 0, smap = &out->data_map[0]; k < out->num_data_map; k++, smap++) {
+          if (cur >= smap->map.input_base
+              && cur <= (uint64_t)smap->map.input_base + smap->map.id_count)
+              break;
+      }
+
+      if (k < out->num_data_map) {
+          map_last = (uint64_t)smap->map.input_base + smap->map.id_count;
+          end = (map_last < last) ? map_last : last;
+          range.sid_base   = (uint32_t)cur;
+          range.did_base   = (uint32_t)(cur - smap->map.input_base) + smap->map.output_base;
+          range.smmu_index = smmu_index;
+          its = (IOVIRT_BLOCK *)((uint8_t *)g_iovirt_info_table + smap->map.output_ref);
+          range.its_id     = (its->type == IOVIRT_NODE_ITS_GROUP) ? its->data_map[0].id[0] : 0;
+          range.status     = IOVIRT_RID_RESOLVED;
+      } else {
+          end = last;
+          range.sid_base   = (uint32_t)cur;
+          range.did_base   = 0;
+          range.smmu_index = ACS_INVALID_INDEX;
+          range.its_id     = 0;
+          range.status     = IOVIRT_RID_NO_DEVICE_ID;
+      }
+
+      /* Stop where an earlier SMMU mapping starts and takes over */
+      for (j = 0, smap = &out->data_map[0]; j < k; j++, smap++) {
+          if (smap->map.input_base > cur && smap->map.input_base <= end)
+              end = smap->map.input_base - 1;
+      }
+
+      range.rid_base = map->input_base + (uint32_t)(cur - map->output_base);
+      range.rid_last = range.rid_base + (uint32_t)(end - cur);
+      if (ranges)
+          ranges[count] = range;
+      count++;
+      cur = end + 1;
+  }
+
+  return count;
+}
+
+/**
+  @brief   Build the resolved RID map for all root complexes in the iovirt
+           table. Ranges are sorted by segment and RID so lookups can binary
+           search them; overlaps and gaps are reported here once.
+           1. Caller       -  val_iovirt_create_info_table
+           2. Prerequisite -  pal_iovirt_create_info_table
+
+  @return  None
+**/
+static void
+val_iovirt_build_rid_map(void)
+{
+  uint32_t i, j, count = 0;
+  IOVIRT_BLOCK *block;
+  IOVIRT_RID_RANGE *ranges, tmp;
+
+  g_iovirt_rid_map = NULL;
+  g_iovirt_rid_map_count = 0;
+  g_iovirt_rid_map_overlap = 0;
+
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+      if (block->type != IOVIRT_NODE_PCI_ROOT_COMPLEX)
+          continue;
+      for (j = 0; j < block->num_data_map; j++)
+          count = val_iovirt_resolve_rc_map(block, &block->data_map[j].map, NULL, count);
+  }
+
+  if (count == 0)
+      return;
+
+  ranges = val_memory_alloc(count * sizeof(IOVIRT_RID_RANGE));
+  if (ranges == NULL) {
+      val_print(WARN, "\n       RID map allocation failed, using IORT walk");
+      return;
+  }
+
+  count = 0;
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+      if (block->type != IOVIRT_NODE_PCI_ROOT_COMPLEX)
+          continue;
+      for (j = 0; j < block->num_data_map; j++)
+          count = val_iovirt_resolve_rc_map(block, &block->data_map[j].map, ranges, count);
+  }
+
+  /* Insertion sort keeps IORT order for equal keys; the table is small */
+  for (i = 1; i < count; i++) {
+      tmp = ranges[i];
+      for (j = i; j > 0; j--) {
+          if (ranges[j - 1].segment < tmp.segment
+              || (ranges[j - 1].segment == tmp.segment
+                  && ranges[j - 1].rid_base <= tmp.rid_base))
+              break;
+          ranges[j] = ranges[j - 1];
+      }
+      ranges[j] = tmp;
+  }
+
+  for (i = 0; i < count; i++) {
+      if (ranges[i].status == IOVIRT_RID_BAD_OUTPUT)
+          val_print(WARN, "\n       IORT: RC segment %d RIDs 0x%x-0x%x map to neither SMMU nor ITS",
+                    ranges[i].segment, ranges[i].rid_base, ranges[i].rid_last);
+      else if (ranges[i].status == IOVIRT_RID_NO_DEVICE_ID)
+          val_print(DEBUG, "\n       IORT: RC segment %d RIDs 0x%x-0x%x have no Device ID map",
+                    ranges[i].segment, ranges[i].rid_base, ranges[i].rid_last);
+
+      if (i == 0 || ranges[i].segment != ranges[i - 1].segment)
+          continue;
+
+      if (ranges[i].rid_base <= ranges[i - 1].rid_last) {
+          val_print(WARN, "\n       IORT: RC segment %d RID 0x%x has overlapping ID mappings",
+                    ranges[i].segment, ranges[i].rid_base);
+          g_iovirt_rid_map_overlap = 1;
+      } else if (ranges[i].rid_base > ranges[i - 1].rid_last + 1) {
+          val_print(DEBUG, "\n       IORT: RC segment %d RIDs 0x%x-0x%x are not mapped",
+                    ranges[i].segment, ranges[i - 1].rid_last + 1, ranges[i].rid_base - 1);
+      }
+  }
+
+  if (g_iovirt_rid_map_overlap)
+      val_print(WARN, "\n       Overlapping RC ID mappings, using IORT walk for lookups");
+
+  g_iovirt_rid_map = ranges;
+  g_iovirt_rid_map_count = count;
+  val_print(DEBUG, "\n       Resolved RID map ranges : %d", count);
+}
+
+/**
+  @brief   Find the resolved RID range containing a requester ID
+
+  @param   segment  PCIe segment number
+  @param   rid      Requester ID
+
+  @return  Matching range, or NULL if the RID is not mapped
+**/
+static IOVIRT_RID_RANGE *
+val_iovirt_find_rid_range(uint32_t segment, uint32_t rid)
+{
+  uint32_t lo = 0, hi = g_iovirt_rid_map_count, mid;
+  IOVIRT_RID_RANGE *range;
+
+  /* Find the last range starting at or before (segment, rid) */
+  while (lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      range = &g_iovirt_rid_map[mid];
+      if (range->segment < segment
+          || (range->segment == segment && range->rid_base <= rid))
+          lo = mid + 1;
+      else
+          hi = mid;
+  }
+
+  if (lo == 0)
+      return NULL;
+
+  range = &g_iovirt_rid_map[lo - 1];
+  if (range->segment != segment || rid > range->rid_last)
+      return NULL;
+
+  return range;
+}
+
 /**
   @brief  Calculate the device id and stream id orresponding to the requestor id
   @param  rid          Requestor ID
@@ -165,6 +422,7 @@ val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
   uint32_t mapping_found;
   IOVIRT_BLOCK *block;
   NODE_DATA_MAP *map;
+  IOVIRT_RID_RANGE *range;
   if (g_iovirt_info_table == NULL)
   {
       val_print(ERROR, "\n       GET_DEVICE_ID: iovirt info table is not created");
@@ -175,6 +433,34 @@ val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
       return ACS_STATUS_ERR;
   }
 
+  /* Resolved RID map gives the final IDs with a single binary search */
+  if (g_iovirt_rid_map != NULL && !g_iovirt_rid_map_overlap) {
+      range = val_iovirt_find_rid_range(segment, rid);
+      if (range == NULL) {
+          val_print(ERROR,
+                 "\n       RID to Stream/Dev ID map not found ");
+          return ACS_STATUS_ERR;
+      }
+      if (range->status == IOVIRT_RID_BAD_OUTPUT) {
+          val_print(ERROR, "\n       GET_DEVICE_ID: Invalid mapping for RC in IORT");
+          return ACS_STATUS_ERR;
+      }
+      if (range->status == IOVIRT_RID_NO_DEVICE_ID) {
+          val_print(ERROR,
+                        "\n       GET_DEVICE_ID: Stream ID to Device ID mapping not found");
+          return ACS_STATUS_ERR;
+      }
+
+      id = rid - range->rid_base;
+      if (its_id)
+          *its_id = range->its_id;
+      if (stream_id)
+          *stream_id = (range->sid_base == ~((uint32_t)0)) ? range->sid_base
+                                                           : range->sid_base + id;
+      *device_id = range->did_base + id;
+      return 0;
+  }
+
   /* Search for root complex block with same segment number, and in whose id */
   /* mapping range 'rid' falls. Calculate the output id */
   block = &g_iovirt_info_table->blocks[0];
@@ -278,6 +564,7 @@ val_iovirt_create_info_table(uint64_t *iovirt_info_table)
   g_iovirt_info_table = (IOVIRT_INFO_TABLE *)iovirt_info_table;
 
   pal_iovirt_create_info_table(g_iovirt_info_table);
+  val_iovirt_build_rid_map();
 
   g_num_smmus = (uint32_t)val_iovirt_get_smmu_info(SMMU_NUM_CTRL, 0);
   val_print(INFO,
@@ -316,6 +603,13 @@ val_iovirt_create_info_table(uint64_t *iovirt_info_table)
 void
 val_iovirt_free_info_table(void)
 {
+    if (g_iovirt_rid_map != NULL) {
+        val_memory_free((void *)g_iovirt_rid_map);
+        g_iovirt_rid_map = NULL;
+        g_iovirt_rid_map_count = 0;
+        g_iovirt_rid_map_overlap = 0;
+    }
+
     if (g_iovirt_info_table != NULL) {
         pal_mem_free_aligned((void *)g_iovirt_info_table);
         g_iovirt_info_table = NULL;
@@ -340,6 +634,16 @@ val_iovirt_get_rc_smmu_index(uint32_t rc_seg_num, uint32_t rid)
 
   uint32_t num_smmu;
   uint64_t smmu_base;
+  IOVIRT_RID_RANGE *range;
+
+  if (g_iovirt_rid_map != NULL && !g_iovirt_rid_map_overlap) {
+      range = val_iovirt_find_rid_range(rc_seg_num, rid);
+      if (range != NULL && range->smmu_index != ACS_INVALID_INDEX)
+          return range->smmu_index;
+
+      val_print(TRACE, "\n       RC with segment number %d is not behind SMMU", rc_seg_num);
+      return ACS_INVALID_INDEX;
+  }
 
   smmu_base = pal_iovirt_get_rc_smmu_base(g_iovirt_info_table, rc_seg_num, rid);
   if (smmu_base) {
@@ -27,6 +27,16 @@
 MEMORY_INFO_TABLE  *g_memory_info_table;
 extern IOREMMAP_LIST *ioremmap_list;
 
+/* Interval index over g_memory_info_table, built by val_memory_create_info_table */
+static uint32_t g_memory_info_count;     /* Sorted entries, 0 when the table is not indexed */
+static uint32_t g_memory_info_last_hit;  /* Entry which matched the previous lookup */
+static uint32_t g_memory_info_overlap;   /* Set when two entries overlap, lookups then scan */
+static uint32_t g_memory_info_unpop;     /* Set when unpopulated lookups use the table */
+
+/* Cursor of the previous val_memory_get_unpopulated_addr query */
+static val_mem_range_iter_t g_memory_unpop_iter;
+static uint32_t g_memory_unpop_instance;
+
 #define SIZE_4KB   0x00001000
 
 #define ADDR_52BIT_MASK 0xFFFFFFFFFFFFULL
@@ -77,6 +87,11 @@ uint32_t val_mmu_get_mapping_count(void)
 void
 val_memory_free_info_table(void)
 {
+    g_memory_info_count = 0;
+    g_memory_info_last_hit = 0;
+    g_memory_info_overlap = 0;
+    g_memory_info_unpop = 0;
+
     if (g_memory_info_table != NULL) {
         pal_mem_free((void *)g_memory_info_table);
         g_memory_info_table = NULL;
@@ -87,6 +102,79 @@ val_memory_free_info_table(void)
     }
 }
 
+/**
+  @brief   Sort the memory info table by physical address, merge contiguous
+           entries with the same type and attributes and drop empty ones.
+           Insertion sort is used as firmware memory maps are mostly sorted.
+           1. Caller       - val_memory_create_info_table
+           2. Prerequisite - pal_memory_create_info_table
+  @param   None
+
+  @return  None
+**/
+static void
+val_memory_index_info_table(void)
+{
+  MEM_INFO_BLOCK *info = g_memory_info_table->info;
+  MEM_INFO_BLOCK entry;
+#ifdef TARGET_BAREMETAL
+  addr_t base;
+  uint64_t size;
+#endif
+  uint32_t num = 0;
+  uint32_t out = 0;
+  uint32_t i, j;
+
+  while (info[num].type != MEMORY_TYPE_LAST_ENTRY)
+      num++;
+
+  for (i = 1; i < num; i++) {
+      entry = info[i];
+      for (j = i; (j > 0) && (info[j - 1].phy_addr > entry.phy_addr); j--)
+          info[j] = info[j - 1];
+      info[j] = entry;
+  }
+
+  g_memory_info_overlap = 0;
+  for (i = 0; i < num; i++) {
+      if (info[i].size == 0)
+          continue;
+
+      if (out != 0) {
+          if ((info[out - 1].phy_addr + info[out - 1].size) == info[i].phy_addr &&
+              (info[out - 1].virt_addr + info[out - 1].size) == info[i].virt_addr &&
+              (info[out - 1].type == info[i].type) &&
+              (info[out - 1].flags == info[i].flags)) {
+              info[out - 1].size += info[i].size;
+              continue;
+          }
+
+          if ((info[out - 1].phy_addr + info[out - 1].size) > info[i].phy_addr)
+              g_memory_info_overlap = 1;
+      }
+
+      info[out++] = info[i];
+  }
+  info[out].type = MEMORY_TYPE_LAST_ENTRY;
+
+  g_memory_info_count = out;
+  g_memory_info_last_hit = 0;
+  g_memory_unpop_instance = 0;
+  val_memory_range_iter_init(&g_memory_unpop_iter, 0);
+#ifdef TARGET_BAREMETAL
+  /* Only the baremetal PAL reports unpopulated ranges exactly. The UEFI PAL
+     also labels memory types it does not classify as not populated, so
+     there the GCD-based PAL query stays authoritative. */
+  g_memory_info_unpop = val_memory_range_iter_next(&g_memory_unpop_iter, &base, &size);
+  val_memory_range_iter_init(&g_memory_unpop_iter, 0);
+#endif
+
+  val_print(DEBUG, "\n       Memory info table: %d entries", num);
+  val_print(DEBUG, ", %d after merging", out);
+  if (g_memory_info_overlap)
+      val_print(WARN, "\n       Memory info table has overlapping entries");
+}
+
 /**
   @brief   This function will call PAL layer to fill all relevant peripheral
            information into the g_peripheral_info_table pointer.
@@ -105,6 +193,7 @@ val_memory_create_info_table(uint64_t *memory_info_table)
   val_print(TRACE, "\n       Creating MEMORY INFO table");
 
   pal_memory_create_info_table(g_memory_info_table);
+  val_memory_index_info_table();
 
 }
 #endif
@@ -138,7 +227,21 @@ val_memory_get_entry_index(uint32_t type, uint32_t instance)
 }
 
 /**
-  @brief   Returns the type and attributes of a given memory address
+  @brief   Check whether addr falls in entry index of the memory info table
+**/
+static uint32_t
+val_memory_entry_contains(uint32_t index, addr_t addr)
+{
+  MEM_INFO_BLOCK *entry = &g_memory_info_table->info[index];
+
+  return (((uint64_t)addr >= entry->phy_addr) &&
+          ((uint64_t)addr < (entry->phy_addr + entry->size)));
+}
+
+/**
+  @brief   Returns the type and attributes of a given memory address.
+           Uses the interval index when the table was built by
+           val_memory_create_info_table, otherwise scans the table.
            1. Caller       - Test Suite
            2. Prerequisite - val_memory_create_info_table
   @param   addr     - Address whose type and attributes are being requested
@@ -151,20 +254,118 @@ val_memory_get_info(addr_t addr, uint64_t *attr)
 {
 
   uint32_t index = 0;
+  uint32_t low, high, mid;
+
+  if ((g_memory_info_count == 0) || g_memory_info_overlap) {
+      while (g_memory_info_table->info[index].type != MEMORY_TYPE_LAST_ENTRY) {
+          if (val_memory_entry_contains(index, addr)) {
+              *attr =  g_memory_info_table->info[index].flags;
+              return g_memory_info_table->info[index].type;
+          }
+          index++;
+      }
 
-  while (g_memory_info_table->info[index].type != MEMORY_TYPE_LAST_ENTRY) {
-      if ((addr >= g_memory_info_table->info[index].phy_addr) &&
-        (addr < (g_memory_info_table->info[index].phy_addr +
-        g_memory_info_table->info[index].size))) {
-          *attr =  g_memory_info_table->info[index].flags;
-          return g_memory_info_table->info[index].type;
-       }
-       index++;
-      // val_print(TRACE," .");
+      return MEM_TYPE_NOT_POPULATED;
   }
 
-  return MEM_TYPE_NOT_POPULATED;
+  /* Probes of one range tend to hit the same entry again */
+  if (!val_memory_entry_contains(g_memory_info_last_hit, addr)) {
+      /* Find the last entry starting at or below addr */
+      low = 0;
+      high = g_memory_info_count;
+      while (low < high) {
+          mid = low + (high - low) / 2;
+          if (g_memory_info_table->info[mid].phy_addr <= (uint64_t)addr)
+              low = mid + 1;
+          else
+              high = mid;
+      }
+
+      if ((low == 0) || !val_memory_entry_contains(low - 1, addr))
+          return MEM_TYPE_NOT_POPULATED;
+
+      g_memory_info_last_hit = low - 1;
+  }
+
+  *attr = g_memory_info_table->info[g_memory_info_last_hit].flags;
+  return g_memory_info_table->info[g_memory_info_last_hit].type;
+}
+
+/**
+  @brief   Start an iteration over the unpopulated ranges of the memory info table
+           1. Caller       - VAL, Test Suite
+           2. Prerequisite - val_memory_create_info_table
+  @param   iter           - Iterator to initialise
+  @param   include_holes  - 1 to also return the gaps between described ranges,
+                            0 to return only entries of type MEMORY_TYPE_NOT_POPULATED
 
+  @return  None
+**/
+void
+val_memory_range_iter_init(val_mem_range_iter_t *iter, uint32_t include_holes)
+{
+  iter->index = 0;
+  iter->cursor = 0;
+  iter->include_holes = include_holes;
+}
+
+/**
+  @brief   Return the next unpopulated range in ascending address order.
+           Adjacent unpopulated pieces are returned as one range. The space
+           above the last described range is not returned.
+           1. Caller       - VAL, Test Suite
+           2. Prerequisite - val_memory_range_iter_init
+  @param   iter  - Iterator state
+  @param   base  - Physical base of the range
+  @param   size  - Size of the range in bytes
+
+  @return  1 if a range was returned, 0 when the iteration is over
+**/
+uint32_t
+val_memory_range_iter_next(val_mem_range_iter_t *iter, addr_t *base, uint64_t *size)
+{
+  MEM_INFO_BLOCK *entry;
+  uint64_t start = 0;
+  uint64_t end = 0;
+  uint32_t found = 0;
+
+  while (iter->index < g_memory_info_count) {
+      entry = &g_memory_info_table->info[iter->index];
+
+      /* Gap in front of this entry */
+      if (iter->include_holes && (entry->phy_addr > iter->cursor)) {
+          if (found && (end != iter->cursor))
+              break;
+          if (!found)
+              start = iter->cursor;
+          end = entry->phy_addr;
+          found = 1;
+          iter->cursor = entry->phy_addr;
+          continue;
+      }
+
+      if (entry->type == MEMORY_TYPE_NOT_POPULATED) {
+          if (found && (end != entry->phy_addr))
+              break;
+          if (!found)
+              start = entry->phy_addr;
+          end = entry->phy_addr + entry->size;
+          found = 1;
+      } else if (found) {
+          break;
+      }
+
+      if ((entry->phy_addr + entry->size) > iter->cursor)
+          iter->cursor = entry->phy_addr + entry->size;
+      iter->index++;
+  }
+
+  if (found) {
+      *base = start;
+      *size = end - start;
+  }
+
+  return found;
 }
 
 /**
@@ -307,6 +508,85 @@ val_memory_free(void *addr)
   pal_mem_free(addr);
 }
 
+/**
+  @brief  Begin a leak scope. Allocations made until the scope ends are
+          accounted to it. Only supported on baremetal.
+
+  @param  None
+
+  @return Scope identifier, 0 if scopes are not supported or one is open.
+**/
+uint32_t
+val_memory_leak_scope_begin(void)
+{
+#ifdef TARGET_BAREMETAL
+  return pal_mem_leak_scope_begin();
+#else
+  return 0;
+#endif
+}
+
+/**
+  @brief  End a leak scope begun by val_memory_leak_scope_begin and report
+          the allocations made in it that were never freed. The
+          allocations are not reclaimed.
+
+  @param  scope   Identifier returned by val_memory_leak_scope_begin.
+
+  @return None
+**/
+void
+val_memory_leak_scope_end(uint32_t scope)
+{
+#ifdef TARGET_BAREMETAL
+  uint64_t live_blocks;
+  uint64_t live_bytes;
+
+  if (scope == 0)
+      return;
+
+  pal_mem_leak_scope_end(scope, &live_blocks, &live_bytes);
+  if (live_blocks) {
+      val_print(DEBUG, "\n       Heap: %d allocation(s)", live_blocks);
+      val_print(DEBUG, " totalling 0x%lx bytes not freed", live_bytes);
+  }
+#else
+  (void)scope;
+#endif
+}
+
+/**
+  @brief  Print heap usage and fragmentation. Only supported on baremetal.
+
+  @param  None
+
+  @return None
+**/
+void
+val_memory_print_heap_stats(void)
+{
+#ifdef TARGET_BAREMETAL
+  MEM_HEAP_STATS stats;
+  uint64_t frag = 0;
+
+  pal_mem_get_heap_stats(&stats);
+
+  /* Share of free memory that is unusable for a single allocation */
+  if (stats.free_bytes)
+      frag = 100 - ((stats.largest_free_block * 100) / stats.free_bytes);
+
+  val_print(INFO, "\n Heap size            : 0x%lx", stats.heap_size);
+  val_print(INFO, "\n Heap used / peak     : 0x%lx", stats.used_bytes);
+  val_print(INFO, " / 0x%lx", stats.peak_used_bytes);
+  val_print(INFO, "\n Heap allocs / failed : %d", stats.total_allocs);
+  val_print(INFO, " / %d", stats.failed_allocs);
+  val_print(INFO, "\n Heap live blocks     : %d", stats.live_blocks);
+  val_print(INFO, "\n Heap free blocks     : %d", stats.free_blocks);
+  val_print(INFO, "\n Heap largest free    : 0x%lx", stats.largest_free_block);
+  val_print(INFO, "\n Heap fragmentation   : %d%%\n", frag);
+#endif
+}
+
 /**
   @brief  Returns the physical address for virtual address space.
 
@@ -535,17 +815,46 @@ val_memory_free_cacheable(uint32_t bdf, uint32_t size, void *va, void *pa)
 
 /**
   @brief  Return the address of unpopulated memory of requested
-          instance.
+          instance. On baremetal, when the memory info table describes
+          unpopulated ranges the answer comes from the interval index,
+          resuming from the previous query for consecutive instances.
+          Otherwise the PAL is asked.
 
   @param  addr      - Address of the unpopulated memory
           instance  - Instance of memory
 
-  @return unpopulated Address
+  @return MEM_MAP_SUCCESS, PCIE_NO_MAPPING once all instances were returned,
+          or a PAL error code
 **/
 uint64_t
 val_memory_get_unpopulated_addr(addr_t *addr, uint32_t instance)
 {
-  return pal_memory_get_unpopulated_addr(addr, instance);
+  val_mem_range_iter_t iter;
+  addr_t base;
+  uint64_t size;
+
+  if ((g_memory_info_count == 0) || !g_memory_info_unpop)
+      return pal_memory_get_unpopulated_addr((uint64_t *)addr, instance);
+
+  /* Resume from the previous query when the instances are walked in order */
+  if (instance < g_memory_unpop_instance) {
+      val_memory_range_iter_init(&g_memory_unpop_iter, 0);
+      g_memory_unpop_instance = 0;
+  }
+
+  while (g_memory_unpop_instance < instance) {
+      if (!val_memory_range_iter_next(&g_memory_unpop_iter, &base, &size))
+          return PCIE_NO_MAPPING;
+      g_memory_unpop_instance++;
+  }
+
+  iter = g_memory_unpop_iter;
+  if (!val_memory_range_iter_next(&iter, &base, &size))
+      return PCIE_NO_MAPPING;
+
+  *addr = base;
+  val_print(DEBUG, "\n       Unpopulated region with base address 0x%lx found", base);
+  return MEM_MAP_SUCCESS;
 }
 
 #ifndef TARGET_LINUX
@@ -31,6 +31,43 @@ static HMAT_INFO_TABLE *g_hmat_info_table;
 extern GIC_ITS_INFO    *g_gic_its_info;
 
 uint8_t **g_shared_memcpy_buffer;
+static uint64_t g_shared_memcpy_buf_size;   /* Bytes of each shared buffer, 0 when freed */
+
+static uint32_t val_mpam_pcc_xfer(uint32_t msc_index, uint32_t message_id, uint32_t reg_offset,
+                                  uint32_t count, uint32_t *data);
+
+/* MPAMF ID registers are read-only, so they are read once per MSC and kept in
+   the MSC descriptor. Registers describing a resource instance are kept per
+   RIS, indexed by the RIS selected in MPAMCFG_PART_SEL or MSMON_CFG_MON_SEL. */
+#define MPAM_IDR_SLOT_COUNT    13
+#define MPAM_IDR_VALID_32      0x1
+#define MPAM_IDR_VALID_64      0x2
+#define MPAM_RIS_UNKNOWN       0xFF
+
+typedef enum {
+  MPAM_IDR_SCOPE_MSC = 0,   /* Same for every resource instance */
+  MPAM_IDR_SCOPE_PART,      /* Resource instance selected by MPAMCFG_PART_SEL.RIS */
+  MPAM_IDR_SCOPE_MON        /* Resource instance selected by MSMON_CFG_MON_SEL.RIS */
+} MPAM_IDR_SCOPE_e;
+
+typedef struct {
+  uint64_t value64;         /* Value of a 64-bit read of the register */
+  uint32_t value32;         /* Value of a 32-bit read of the register */
+  uint32_t valid;           /* MPAM_IDR_VALID_* of the values read so far */
+} MPAM_IDR_CACHE_t;
+
+typedef struct {
+  MPAM_MSC_NODE    *node;        /* Entry of the MSC in g_mpam_info_table */
+  uint64_t         base;         /* MMIO base, or PCC subspace ID */
+  uint32_t         intrf_type;   /* MPAM_INTERFACE_TYPE_MMIO or _PCC */
+  uint32_t         rsrc_count;   /* Number of resource nodes */
+  uint8_t          ris_count;    /* RIS_MAX + 1 with RIS, 1 without, 0 until known */
+  uint8_t          part_ris;     /* RIS in MPAMCFG_PART_SEL or MPAM_RIS_UNKNOWN */
+  uint8_t          mon_ris;      /* RIS in MSMON_CFG_MON_SEL or MPAM_RIS_UNKNOWN */
+  MPAM_IDR_CACHE_t *idr;         /* ris_count * MPAM_IDR_SLOT_COUNT entries */
+} MPAM_MSC_DESC_t;
+
+static MPAM_MSC_DESC_t *g_mpam_msc_desc;
 
 static char8_t *
 mpam_reg_offset_name(uint32_t reg_offset)
@@ -181,51 +218,54 @@ val_mpam_get_info(MPAM_INFO_e type, uint32_t msc_index, uint32_t rsrc_index)
       return 0;
   }
 
-  /* Walk the MPAM info table and return requested info */
-  msc_entry = &g_mpam_info_table->msc_node[0];
-  for (i = 0; i < g_mpam_info_table->msc_count; i++, msc_entry = MPAM_NEXT_MSC(msc_entry)) {
-      if (msc_index == i) {
-          if (rsrc_index > msc_entry->rsrc_count - 1) {
-              val_print(ERROR,
-                      "\n   Invalid MSC resource index = 0x%lx for", rsrc_index);
-              val_print(ERROR, "MSC index = 0x%lx ", msc_index);
-              return MPAM_INVALID_INFO;
-          }
-          switch (type) {
-          case MPAM_MSC_RSRC_COUNT:
-              return msc_entry->rsrc_count;
-          case MPAM_MSC_RSRC_RIS:
-              return msc_entry->rsrc_node[rsrc_index].ris_index;
-          case MPAM_MSC_RSRC_TYPE:
-              return msc_entry->rsrc_node[rsrc_index].locator_type;
-          case MPAM_MSC_RSRC_DESC1:
-              return msc_entry->rsrc_node[rsrc_index].descriptor1;
-          case MPAM_MSC_RSRC_DESC2:
-              return msc_entry->rsrc_node[rsrc_index].descriptor2;
-          case MPAM_MSC_BASE_ADDR:
-              return msc_entry->msc_base_addr;
-          case MPAM_MSC_ADDR_LEN:
-              return msc_entry->msc_addr_len;
-          case MPAM_MSC_NRDY:
-              return msc_entry->max_nrdy;
-          case MPAM_MSC_OF_INTR:
-              return msc_entry->of_intr;
-          case MPAM_MSC_OF_INTR_FLAGS:
-              return msc_entry->of_intr_flags;
-          case MPAM_MSC_ERR_INTR:
-              return msc_entry->err_intr;
-          case MPAM_MSC_ERR_INTR_FLAGS:
-              return msc_entry->err_intr_flags;
-          case MPAM_MSC_ID:
-              return msc_entry->identifier;
-          case MPAM_MSC_INTERFACE_TYPE:
-              return msc_entry->intrf_type;
-          default:
-              val_print(ERROR,
-                       "\n   This MPAM info option for type %d is not supported", type);
-              return MPAM_INVALID_INFO;
-          }
-      }
+  /* Index the MSC descriptor, or walk the MPAM info table if there is none */
+  if (g_mpam_msc_desc != NULL) {
+      msc_entry = g_mpam_msc_desc[msc_index].node;
+  } else {
+      msc_entry = &g_mpam_info_table->msc_node[0];
+      for (i = 0; i < msc_index; i++)
+          msc_entry = MPAM_NEXT_MSC(msc_entry);
+  }
+
+  if (rsrc_index > msc_entry->rsrc_count - 1) {
+      val_print(ERROR,
+              "\n   Invalid MSC resource index = 0x%lx for", rsrc_index);
+      val_print(ERROR, "MSC index = 0x%lx ", msc_index);
+      return MPAM_INVALID_INFO;
+  }
+  switch (type) {
+  case MPAM_MSC_RSRC_COUNT:
+      return msc_entry->rsrc_count;
+  case MPAM_MSC_RSRC_RIS:
+      return msc_entry->rsrc_node[rsrc_index].ris_index;
+  case MPAM_MSC_RSRC_TYPE:
+      return msc_entry->rsrc_node[rsrc_index].locator_type;
+  case MPAM_MSC_RSRC_DESC1:
+      return msc_entry->rsrc_node[rsrc_index].descriptor1;
+  case MPAM_MSC_RSRC_DESC2:
+      return msc_entry->rsrc_node[rsrc_index].descriptor2;
+  case MPAM_MSC_BASE_ADDR:
+      return msc_entry->msc_base_addr;
+  case MPAM_MSC_ADDR_LEN:
+      return msc_entry->msc_addr_len;
+  case MPAM_MSC_NRDY:
+      return msc_entry->max_nrdy;
+  case MPAM_MSC_OF_INTR:
+      return msc_entry->of_intr;
+  case MPAM_MSC_OF_INTR_FLAGS:
+      return msc_entry->of_intr_flags;
+  case MPAM_MSC_ERR_INTR:
+      return msc_entry->err_intr;
+  case MPAM_MSC_ERR_INTR_FLAGS:
+      return msc_entry->err_intr_flags;
+  case MPAM_MSC_ID:
+      return msc_entry->identifier;
+  case MPAM_MSC_INTERFACE_TYPE:
+      return msc_entry->intrf_type;
+  default:
+      val_print(ERROR,
+               "\n   This MPAM info option for type %d is not supported", type);
+      return MPAM_INVALID_INFO;
   }
   return MPAM_INVALID_INFO;
 }
@@ -796,7 +836,7 @@ val_mpam_memory_configure_mbwumon(uint32_t msc_index)
     data = 0;
 
     /* Check if MPAMF_MBWUMON_IDR supports RW bandwidth selection */
-    if (BITFIELD_READ(MBWUMON_IDR_HAS_RWBW, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR)))
+    if (BITFIELD_READ(MBWUMON_IDR_HAS_RWBW, val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR)))
     {
         /* If true, configure monitor filter reg to count both read and write bandwidth */
         data = BITFIELD_SET(MBWU_FLT_RWBW, MBWU_FLT_RWBW_RW);
@@ -866,33 +906,29 @@ uint64_t
 val_mpam_memory_mbwumon_read_count(uint32_t msc_index)
 {
     uint64_t count = MPAM_MON_NOT_READY;
+    uint64_t mbwumon_idr;
+    uint64_t value;
+
+    /* ID register comes from the MSC descriptor, read the counter once per sample */
+    mbwumon_idr = val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR);
 
     /*if MSMON_MBWU_L is implemented*/
-    if (BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR))) {
-        if (BITFIELD_READ(MBWUMON_IDR_HAS_LONG,
-            val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR))) {
-            // (63 bits)
-            if (BITFIELD_READ(MSMON_MBWU_L_NRDY,
-                val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L)) == 0)
-                count = BITFIELD_READ(MSMON_MBWU_L_63BIT_VALUE,
-                                      val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L));
-        }
-        else {
-            // (44 bits)
-            if (BITFIELD_READ(MSMON_MBWU_L_NRDY,
-                val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L)) == 0)
-                count = BITFIELD_READ(MSMON_MBWU_L_44BIT_VALUE,
-                                      val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L));
+    if (BITFIELD_READ(MBWUMON_IDR_LWD, mbwumon_idr)) {
+        value = val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L);
+        if (BITFIELD_READ(MSMON_MBWU_L_NRDY, value) == 0) {
+            if (BITFIELD_READ(MBWUMON_IDR_HAS_LONG, mbwumon_idr))
+                count = BITFIELD_READ(MSMON_MBWU_L_63BIT_VALUE, value);  // (63 bits)
+            else
+                count = BITFIELD_READ(MSMON_MBWU_L_44BIT_VALUE, value);  // (44 bits)
         }
     }
     else {
         // (31 bits)
-        if (BITFIELD_READ(MSMON_MBWU_NRDY, val_mpam_mmr_read(msc_index, REG_MSMON_MBWU)) == 0) {
-            count = BITFIELD_READ(MSMON_MBWU_VALUE,
-                                  val_mpam_mmr_read(msc_index, REG_MSMON_MBWU));
+        value = val_mpam_mmr_read(msc_index, REG_MSMON_MBWU);
+        if (BITFIELD_READ(MSMON_MBWU_NRDY, value) == 0) {
+            count = BITFIELD_READ(MSMON_MBWU_VALUE, value);
             /* shift the count if scaling is enabled */
-            count = count << BITFIELD_READ(MBWUMON_IDR_SCALE,
-                                  val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
+            count = count << BITFIELD_READ(MBWUMON_IDR_SCALE, mbwumon_idr);
         }
     }
     return(count);
@@ -910,7 +946,7 @@ void
 val_mpam_memory_mbwumon_reset(uint32_t msc_index)
 {
     /*if MSMON_MBWU_L is implemented*/
-    if (BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR)))
+    if (BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR)))
         val_mpam_mmr_write64(msc_index, REG_MSMON_MBWU_L, 0);
     else
        val_mpam_mmr_write(msc_index, REG_MSMON_MBWU, 0);
@@ -982,6 +1018,67 @@ uint64_t val_mpam_memory_get_base(uint32_t msc_index, uint32_t rsrc_index)
     return val_srat_get_info(SRAT_MEM_BASE_ADDR, prox_domain);
 }
 
+/**
+  @brief   Build the MSC descriptor array from g_mpam_info_table so that MSC
+           lookups and register accesses index it instead of walking the
+           variable length MSC node list. ID registers are filled on first use.
+  @return  None
+**/
+static
+void
+mpam_msc_desc_build(void)
+{
+  uint32_t msc_index;
+  uint32_t msc_count = g_mpam_info_table->msc_count;
+  MPAM_MSC_NODE *msc_entry;
+  MPAM_MSC_DESC_t *desc;
+
+  g_mpam_msc_desc = NULL;
+  if (msc_count == 0)
+      return;
+
+  desc = val_memory_calloc(msc_count, sizeof(MPAM_MSC_DESC_t));
+  if (desc == NULL) {
+      val_print(WARN, "\n       MPAM MSC descriptor allocation failed");
+      return;
+  }
+
+  msc_entry = &g_mpam_info_table->msc_node[0];
+  for (msc_index = 0; msc_index < msc_count; msc_index++) {
+      desc[msc_index].node       = msc_entry;
+      desc[msc_index].base       = msc_entry->msc_base_addr;
+      desc[msc_index].intrf_type = msc_entry->intrf_type;
+      desc[msc_index].rsrc_count = msc_entry->rsrc_count;
+      desc[msc_index].part_ris   = MPAM_RIS_UNKNOWN;
+      desc[msc_index].mon_ris    = MPAM_RIS_UNKNOWN;
+      msc_entry = MPAM_NEXT_MSC(msc_entry);
+  }
+
+  g_mpam_msc_desc = desc;
+}
+
+/**
+  @brief   Free the MSC descriptor array and the ID register caches.
+  @return  None
+**/
+static
+void
+mpam_msc_desc_free(void)
+{
+  uint32_t msc_index;
+
+  if (g_mpam_msc_desc == NULL)
+      return;
+
+  for (msc_index = 0; msc_index < g_mpam_info_table->msc_count; msc_index++) {
+      if (g_mpam_msc_desc[msc_index].idr != NULL)
+          val_memory_free(g_mpam_msc_desc[msc_index].idr);
+  }
+
+  val_memory_free(g_mpam_msc_desc);
+  g_mpam_msc_desc = NULL;
+}
+
 static
 void
 memory_map_msc(void)
@@ -1032,6 +1129,7 @@ val_mpam_create_info_table(uint64_t *mpam_info_table)
 
   val_print(INFO,
                 "\n    MPAM_INFO: Number of MSC nodes     :  %d", g_mpam_info_table->msc_count);
+  mpam_msc_desc_build();
   val_print(DEBUG, "\n       Memory mapping MSC nodes");
 
   memory_map_msc();
@@ -1066,6 +1164,7 @@ void
 val_mpam_free_info_table(void)
 {
     if (g_mpam_info_table != NULL) {
+        mpam_msc_desc_free();
         pal_mem_free_aligned((void *)g_mpam_info_table);
         g_mpam_info_table = NULL;
     }
@@ -1697,23 +1796,43 @@ val_mpam_read_csumon(uint32_t msc_index)
 }
 
 /**
-  @brief   This API reads 32bit MPAM memory mapped register either
-           via MMIO or PCC interface.
+  @brief   Return the base address and interface type of an MSC.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   base_addr  - MMIO base address or PCC subspace ID.
+  @param   intrf_type - Interface type of the MSC.
+
+  @return  None
+**/
+static void
+mpam_msc_locate(uint32_t msc_index, uint64_t *base_addr, uint32_t *intrf_type)
+{
+  if ((g_mpam_msc_desc != NULL) && (msc_index < g_mpam_info_table->msc_count)) {
+      *base_addr  = g_mpam_msc_desc[msc_index].base;
+      *intrf_type = g_mpam_msc_desc[msc_index].intrf_type;
+      return;
+  }
+
+  *base_addr  = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
+  *intrf_type = (uint32_t)val_mpam_get_info(MPAM_MSC_INTERFACE_TYPE, msc_index, 0);
+}
+
+/**
+  @brief   Read a 32bit MPAM register from the MSC, bypassing the ID register cache.
 
   @param   msc_index  - MPAM feature page index for this MSC.
   @param   reg_offset - Register offset address.
 
   @return  Read 32 bit value.
 **/
-uint32_t
-val_mpam_mmr_read(uint32_t msc_index, uint32_t reg_offset)
+static uint32_t
+mpam_mmr_read_raw(uint32_t msc_index, uint32_t reg_offset)
 {
   uint64_t base_addr;
   uint32_t intrf_type;
   uint32_t value;
 
-  base_addr  = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
-  intrf_type = val_mpam_get_info(MPAM_MSC_INTERFACE_TYPE, msc_index, 0);
+  mpam_msc_locate(msc_index, &base_addr, &intrf_type);
 
   if (intrf_type == MPAM_INTERFACE_TYPE_MMIO) {
       value = val_mmio_read(base_addr + reg_offset);
@@ -1731,37 +1850,33 @@ val_mpam_mmr_read(uint32_t msc_index, uint32_t reg_offset)
 }
 
 /**
-  @brief   This API reads 64bit MPAM memory mapped register either
-           via MMIO or PCC interface.
+  @brief   Read a 64bit MPAM register from the MSC, bypassing the ID register cache.
 
   @param   msc_index  - MPAM feature page index for this MSC.
   @param   reg_offset - Register offset address.
 
   @return  Read 64 bit value.
 **/
-uint64_t
-val_mpam_mmr_read64(uint32_t msc_index, uint32_t reg_offset)
+static uint64_t
+mpam_mmr_read64_raw(uint32_t msc_index, uint32_t reg_offset)
 {
   uint64_t base_addr;
   uint32_t intrf_type;
   uint64_t value;
 
-  base_addr  = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
-  intrf_type = val_mpam_get_info(MPAM_MSC_INTERFACE_TYPE, msc_index, 0);
+  mpam_msc_locate(msc_index, &base_addr, &intrf_type);
 
   if (intrf_type == MPAM_INTERFACE_TYPE_MMIO) {
       value = val_mmio_read64(base_addr + reg_offset);
       MPAM_PRINT_REG("Read", reg_offset, value);
       return value;
   } else if (intrf_type == MPAM_INTERFACE_TYPE_PCC) {
-      uint32_t value_low;
-      uint32_t value_high;
+      uint32_t halves[2];
 
       /* The MPAM Fb protocol transfers one 32-bit register
          value per command. Read both halves for a 64-bit register. */
-      value_low = val_mpam_pcc_read(msc_index, reg_offset);
-      value_high = val_mpam_pcc_read(msc_index, reg_offset + sizeof(uint32_t));
-      value = ((uint64_t)value_high << 32) | value_low;
+      val_mpam_pcc_xfer(msc_index, MPAM_MSC_READ_CMD_ID, reg_offset, 2U, halves);
+      value = ((uint64_t)halves[1] << 32) | halves[0];
       MPAM_PRINT_REG("Read PCC", reg_offset, value);
       return value;
   } else {
@@ -1771,6 +1886,215 @@ val_mpam_mmr_read64(uint32_t msc_index, uint32_t reg_offset)
   }
 }
 
+/**
+  @brief   Map an MPAMF ID register to its slot in the ID register cache.
+
+  @param   reg_offset - Register offset address.
+  @param   scope      - Resource instance selector the register depends on.
+
+  @return  Slot index, or -1 if the register is not a cacheable ID register.
+**/
+static int32_t
+mpam_idr_slot(uint32_t reg_offset, MPAM_IDR_SCOPE_e *scope)
+{
+  *scope = MPAM_IDR_SCOPE_PART;
+
+  switch (reg_offset) {
+  case REG_MPAMF_IDR:            return 0;
+  case REG_MPAMF_IMPL_IDR:       return 1;
+  case REG_MPAMF_CPOR_IDR:       return 2;
+  case REG_MPAMF_CCAP_IDR:       return 3;
+  case REG_MPAMF_MBW_IDR:        return 4;
+  case REG_MPAMF_PRI_IDR:        return 5;
+  default:
+      break;
+  }
+
+  *scope = MPAM_IDR_SCOPE_MON;
+
+  switch (reg_offset) {
+  case REG_MPAMF_MSMON_IDR:      return 6;
+  case REG_MPAMF_CSUMON_IDR:     return 7;
+  case REG_MPAMF_MBWUMON_IDR:    return 8;
+  default:
+      break;
+  }
+
+  *scope = MPAM_IDR_SCOPE_MSC;
+
+  switch (reg_offset) {
+  case REG_MPAMF_SIDR:           return 9;
+  case REG_MPAMF_IIDR:           return 10;
+  case REG_MPAMF_AIDR:           return 11;
+  case REG_MPAMF_PARTID_NRW_IDR: return 12;
+  default:
+      return -1;
+  }
+}
+
+/**
+  @brief   Return the cache entry holding an ID register of an MSC for the
+           currently selected resource instance.
+
+           The ID register cache of an MSC is sized on first use from
+           MPAMF_IDR.RIS_MAX. After a write to MPAMCFG_PART_SEL or
+           MSMON_CFG_MON_SEL the selected RIS is read back once, so that RIS
+           values the MSC did not accept never select a wrong entry.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   reg_offset - Register offset address.
+
+  @return  Cache entry, or NULL if the register has to be read from the MSC.
+**/
+static MPAM_IDR_CACHE_t *
+mpam_idr_cache_entry(uint32_t msc_index, uint32_t reg_offset)
+{
+  MPAM_MSC_DESC_t *desc;
+  MPAM_IDR_SCOPE_e scope;
+  uint64_t idr;
+  uint32_t ris = 0;
+  int32_t slot;
+
+  slot = mpam_idr_slot(reg_offset, &scope);
+  if ((slot < 0) || (g_mpam_msc_desc == NULL) || (msc_index >= g_mpam_info_table->msc_count))
+      return NULL;
+
+  desc = &g_mpam_msc_desc[msc_index];
+
+  if (desc->ris_count == 0) {
+      idr = mpam_mmr_read64_raw(msc_index, REG_MPAMF_IDR);
+      if (BITFIELD_READ(IDR_EXT, idr) && BITFIELD_READ(IDR_HAS_RIS, idr))
+          desc->ris_count = BITFIELD_READ(IDR_RIS_MAX, idr) + 1;
+      else
+          desc->ris_count = 1;
+
+      desc->idr = val_memory_calloc(desc->ris_count * MPAM_IDR_SLOT_COUNT,
+                                    sizeof(MPAM_IDR_CACHE_t));
+  }
+
+  if (desc->idr == NULL)
+      return NULL;
+
+  if ((desc->ris_count > 1) && (scope == MPAM_IDR_SCOPE_PART)) {
+      if (desc->part_ris == MPAM_RIS_UNKNOWN)
+          desc->part_ris = BITFIELD_READ(PART_SEL_RIS,
+                                         mpam_mmr_read_raw(msc_index, REG_MPAMCFG_PART_SEL));
+      ris = desc->part_ris;
+  } else if ((desc->ris_count > 1) && (scope == MPAM_IDR_SCOPE_MON)) {
+      if (desc->mon_ris == MPAM_RIS_UNKNOWN)
+          desc->mon_ris = BITFIELD_READ(MON_SEL_RIS,
+                                        mpam_mmr_read_raw(msc_index, REG_MSMON_CFG_MON_SEL));
+      ris = desc->mon_ris;
+  }
+
+  if (ris >= desc->ris_count)
+      return NULL;
+
+  return &desc->idr[ris * MPAM_IDR_SLOT_COUNT + slot];
+}
+
+/**
+  @brief   Forget the resource instance selected in an MSC after a write to
+           MPAMCFG_PART_SEL or MSMON_CFG_MON_SEL.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   reg_offset - Register offset address written.
+
+  @return  None
+**/
+static void
+mpam_msc_track_ris_sel(uint32_t msc_index, uint32_t reg_offset)
+{
+  if ((g_mpam_msc_desc == NULL) || (msc_index >= g_mpam_info_table->msc_count))
+      return;
+
+  if (reg_offset == REG_MPAMCFG_PART_SEL)
+      g_mpam_msc_desc[msc_index].part_ris = MPAM_RIS_UNKNOWN;
+  else if (reg_offset == REG_MSMON_CFG_MON_SEL)
+      g_mpam_msc_desc[msc_index].mon_ris = MPAM_RIS_UNKNOWN;
+}
+
+/**
+  @brief   Check whether a value read over PCC may be kept in the ID register
+           cache. A failed PCC read returns MPAM_PCC_SAFE_RETURN, which must
+           not be remembered as the register value.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   value      - Value read.
+
+  @return  1 if the value can be cached, 0 otherwise.
+**/
+static uint32_t
+mpam_idr_cacheable(uint32_t msc_index, uint64_t value)
+{
+  return (g_mpam_msc_desc[msc_index].intrf_type != MPAM_INTERFACE_TYPE_PCC) ||
+         (value != MPAM_PCC_SAFE_RETURN);
+}
+
+/**
+  @brief   This API reads 32bit MPAM memory mapped register either
+           via MMIO or PCC interface. Read-only ID registers are read
+           from the MSC once and then returned from the MSC descriptor.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   reg_offset - Register offset address.
+
+  @return  Read 32 bit value.
+**/
+uint32_t
+val_mpam_mmr_read(uint32_t msc_index, uint32_t reg_offset)
+{
+  MPAM_IDR_CACHE_t *entry;
+  uint32_t value;
+
+  entry = mpam_idr_cache_entry(msc_index, reg_offset);
+  if (entry == NULL)
+      return mpam_mmr_read_raw(msc_index, reg_offset);
+
+  if (entry->valid & MPAM_IDR_VALID_32)
+      return entry->value32;
+
+  value = mpam_mmr_read_raw(msc_index, reg_offset);
+  if (mpam_idr_cacheable(msc_index, value)) {
+      entry->value32 = value;
+      entry->valid |= MPAM_IDR_VALID_32;
+  }
+
+  return value;
+}
+
+/**
+  @brief   This API reads 64bit MPAM memory mapped register either
+           via MMIO or PCC interface. Read-only ID registers are read
+           from the MSC once and then returned from the MSC descriptor.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   reg_offset - Register offset address.
+
+  @return  Read 64 bit value.
+**/
+uint64_t
+val_mpam_mmr_read64(uint32_t msc_index, uint32_t reg_offset)
+{
+  MPAM_IDR_CACHE_t *entry;
+  uint64_t value;
+
+  entry = mpam_idr_cache_entry(msc_index, reg_offset);
+  if (entry == NULL)
+      return mpam_mmr_read64_raw(msc_index, reg_offset);
+
+  if (entry->valid & MPAM_IDR_VALID_64)
+      return entry->value64;
+
+  value = mpam_mmr_read64_raw(msc_index, reg_offset);
+  if (mpam_idr_cacheable(msc_index, value)) {
+      entry->value64 = value;
+      entry->valid |= MPAM_IDR_VALID_64;
+  }
+
+  return value;
+}
+
 /**
   @brief   This API writes 32bit MPAM memory mapped register either
            via MMIO or PCC interface.
@@ -1787,8 +2111,7 @@ val_mpam_mmr_write(uint32_t msc_index, uint32_t reg_offset, uint32_t data)
   uint64_t base_addr;
   uint32_t intrf_type;
 
-  base_addr  = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
-  intrf_type = val_mpam_get_info(MPAM_MSC_INTERFACE_TYPE, msc_index, 0);
+  mpam_msc_locate(msc_index, &base_addr, &intrf_type);
 
   if (intrf_type == MPAM_INTERFACE_TYPE_MMIO) {
       val_mmio_write(base_addr + reg_offset, data);
@@ -1800,6 +2123,7 @@ val_mpam_mmr_write(uint32_t msc_index, uint32_t reg_offset, uint32_t data)
     val_print(ERROR,
               "\n    Invalid interface type reported for MPAM MSC index = %x", msc_index);
   }
+  mpam_msc_track_ris_sel(msc_index, reg_offset);
   val_mem_issue_dsb();
 }
 
@@ -1819,23 +2143,23 @@ val_mpam_mmr_write64(uint32_t msc_index, uint32_t reg_offset, uint64_t data)
   uint64_t base_addr;
   uint32_t intrf_type;
 
-  base_addr  = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
-  intrf_type = val_mpam_get_info(MPAM_MSC_INTERFACE_TYPE, msc_index, 0);
+  mpam_msc_locate(msc_index, &base_addr, &intrf_type);
 
   if (intrf_type == MPAM_INTERFACE_TYPE_MMIO) {
       val_mmio_write64(base_addr + reg_offset, data);
       MPAM_PRINT_REG("Write", reg_offset, data);
   } else if (intrf_type == MPAM_INTERFACE_TYPE_PCC) {
+      uint32_t halves[2] = {(uint32_t)data, (uint32_t)(data >> 32)};
+
       /* The MPAM firmware-based protocol transfers one 32-bit register
          value per command. Write both halves for a 64-bit register. */
-      val_mpam_pcc_write(msc_index, reg_offset, (uint32_t)data);
-      val_mpam_pcc_write(msc_index, reg_offset + sizeof(uint32_t),
-                         (uint32_t)(data >> 32));
+      val_mpam_pcc_xfer(msc_index, MPAM_MSC_WRITE_CMD_ID, reg_offset, 2U, halves);
       MPAM_PRINT_REG("Write PCC", reg_offset, data);
   } else {
     val_print(ERROR,
               "\n    Invalid interface type reported for MPAM MSC index = %x", msc_index);
   }
+  mpam_msc_track_ris_sel(msc_index, reg_offset);
   val_mem_issue_dsb();
 }
 
@@ -1898,20 +2222,31 @@ val_mpam_fb_payload(uint32_t message_id, uint32_t msc_id,
 }
 
 /**
-  @brief   This API constructs header and parameter for the
-           MPAM_MSC_READ PCC command and calls doorbell protocol.
+  @brief   Issue MPAM_MSC_READ or MPAM_MSC_WRITE PCC commands for consecutive
+           32-bit registers of an MSC. The subspace and MSC ID are resolved
+           once, and each payload is built while the previous command is
+           being processed by the platform.
 
   @param   msc_index  - MPAM feature page index for this MSC.
-  @param   reg_offset - Register offset address.
+  @param   message_id - MPAM_MSC_READ_CMD_ID or MPAM_MSC_WRITE_CMD_ID.
+  @param   reg_offset - Offset of the first register.
+  @param   count      - Number of 32-bit registers.
+  @param   data       - Values to write, or storage for the values read.
+                        A failed read returns MPAM_PCC_SAFE_RETURN.
 
-  @return  None
+  @return  ACS_STATUS_PASS if every command succeeded, else ACS_STATUS_FAIL.
 **/
-uint32_t
-val_mpam_pcc_read(uint32_t msc_index, uint32_t reg_offset)
+static uint32_t
+val_mpam_pcc_xfer(uint32_t msc_index, uint32_t message_id, uint32_t reg_offset,
+                  uint32_t count, uint32_t *data)
 {
+  uint32_t i;
   uint32_t header;
   uint32_t msc_id;
   uint32_t subspace_id;
+  uint32_t payload_size;
+  uint32_t status = ACS_STATUS_PASS;
+  uint32_t submitted;
   MPAM_FB_CMD_PAYLOAD payload;
   PCC_MPAM_MSC_READ_RESP_PARA *response;
 
@@ -1920,32 +2255,75 @@ val_mpam_pcc_read(uint32_t msc_index, uint32_t reg_offset)
   subspace_id = (uint32_t)val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
 
   /* Construct the MPAM Fb protocol header; token is caller-defined. */
-  header = val_mpam_fb_header(MPAM_MSC_READ_CMD_ID, MPAM_MSG_TYPE_CMD,
-                               MPAM_FB_PROTOCOL_ID, 1U);
+  header = val_mpam_fb_header(message_id, MPAM_MSG_TYPE_CMD, MPAM_FB_PROTOCOL_ID, 1U);
+  payload_size = (message_id == MPAM_MSC_READ_CMD_ID) ? sizeof(payload.read)
+                                                      : sizeof(payload.write);
 
   /* Construct the MPAM Fb protocol payload with msc_id as input */
   msc_id = (uint32_t)val_mpam_get_info(MPAM_MSC_ID, msc_index, 0);
-  payload = val_mpam_fb_payload(MPAM_MSC_READ_CMD_ID, msc_id, reg_offset, 0U);
+  payload = val_mpam_fb_payload(message_id, msc_id, reg_offset,
+                                (message_id == MPAM_MSC_WRITE_CMD_ID) ? data[0] : 0U);
+
+  for (i = 0; i < count; i++) {
+      val_print(TRACE,
+                "\n    MPAM PCC %a: msc_id=0x%x subspace=%u offset=0x%x header=0x%x",
+                (message_id == MPAM_MSC_READ_CMD_ID) ? "read" : "write",
+                msc_id, subspace_id, reg_offset + i * sizeof(uint32_t), header);
+
+      /* Submit the header and payload to the PCC channel */
+      submitted = (val_pcc_cmd_submit(subspace_id, header, (void *)&payload,
+                                      payload_size) == PCC_STATUS_SUCCESS);
+
+      /* Build the next command while the platform processes this one. The
+         read and write responses share the leading status field. */
+      if (i + 1 < count)
+          payload = val_mpam_fb_payload(message_id, msc_id,
+                                        reg_offset + (i + 1) * sizeof(uint32_t),
+                                        (message_id == MPAM_MSC_WRITE_CMD_ID) ? data[i + 1]
+                                                                              : 0U);
+
+      response = submitted ? (PCC_MPAM_MSC_READ_RESP_PARA *)val_pcc_cmd_complete(subspace_id)
+                           : NULL;
+
+      if (response == NULL || response->status != MPAM_PCC_CMD_SUCCESS) {
+          val_print(ERROR,
+                    (message_id == MPAM_MSC_READ_CMD_ID) ?
+                    "\n    Failed to read MPAM register with offset (0x%x) via PCC" :
+                    "\n    Failed to write MPAM register with offset (0x%x) via PCC",
+                    reg_offset + i * sizeof(uint32_t));
+          val_print(ERROR, " for MSC index = 0x%x", msc_index);
+          if (response != NULL) {
+              val_print(ERROR, "\n    PCC command response code = 0x%x", response->status);
+          }
+          if (message_id == MPAM_MSC_READ_CMD_ID)
+              data[i] = MPAM_PCC_SAFE_RETURN;
+          status = ACS_STATUS_FAIL;
+          continue;
+      }
 
-  val_print(TRACE,
-            "\n    MPAM PCC read: msc_id=0x%x subspace=%u offset=0x%x header=0x%x",
-                                  payload.read.msc_id, subspace_id, payload.read.offset, header);
+      if (message_id == MPAM_MSC_READ_CMD_ID)
+          data[i] = response->val;
+  }
 
-  /* Submit the header and payload to the PCC channel and get the response back from the platform */
-  response = (PCC_MPAM_MSC_READ_RESP_PARA *) val_pcc_cmd_response(
-              (uint32_t)subspace_id, header, (void *)&payload.read, sizeof(payload.read));
+  return status;
+}
 
-  if (response == NULL || response->status != MPAM_PCC_CMD_SUCCESS) {
-      val_print(ERROR,
-                "\n    Failed to read MPAM register with offset (0x%x) via PCC", reg_offset);
-      val_print(ERROR, " for MSC index = 0x%x", msc_index);
-      if (response != NULL) {
-          val_print(ERROR, "\n    PCC command response code = 0x%x", response->status);
-      }
-      return MPAM_PCC_SAFE_RETURN;
-  } else {
-      return response->val;
-  }
+/**
+  @brief   This API constructs header and parameter for the
+           MPAM_MSC_READ PCC command and calls doorbell protocol.
+
+  @param   msc_index  - MPAM feature page index for this MSC.
+  @param   reg_offset - Register offset address.
+
+  @return  Register value, or MPAM_PCC_SAFE_RETURN on failure.
+**/
+uint32_t
+val_mpam_pcc_read(uint32_t msc_index, uint32_t reg_offset)
+{
+  uint32_t value;
+
+  val_mpam_pcc_xfer(msc_index, MPAM_MSC_READ_CMD_ID, reg_offset, 1U, &value);
+  return value;
 }
 
 /**
@@ -1960,42 +2338,7 @@ val_mpam_pcc_read(uint32_t msc_index, uint32_t reg_offset)
 void
 val_mpam_pcc_write(uint32_t msc_index, uint32_t reg_offset, uint32_t data)
 {
-  uint32_t header;
-  uint32_t msc_id;
-  uint32_t subspace_id;
-  MPAM_FB_CMD_PAYLOAD payload;
-  PCC_MPAM_MSC_WRITE_RESP_PARA *response;
-
-  /* if MSC interface type is PCC (0x0A), the Base address field
-     captures index to PCCT ACPI structure */
-  subspace_id = val_mpam_get_info(MPAM_MSC_BASE_ADDR, msc_index, 0);
-
-  /* Construct the MPAM firmware-based protocol header; token is caller-defined. */
-  header = val_mpam_fb_header(MPAM_MSC_WRITE_CMD_ID, MPAM_MSG_TYPE_CMD,
-                               MPAM_FB_PROTOCOL_ID, 1U);
-
-  /* Construct the MPAM Fb protocol payload with msc_id as input */
-  msc_id = (uint32_t)val_mpam_get_info(MPAM_MSC_ID, msc_index, 0);
-  payload = val_mpam_fb_payload(MPAM_MSC_WRITE_CMD_ID, msc_id, reg_offset, data);
-
-  val_print(TRACE,
-            "\n    MPAM PCC write: msc_id=0x%x subspace=%u offset=0x%x value=0x%x header=0x%x",
-                   payload.write.msc_id, subspace_id, payload.write.offset, data, header);
-
-  /* Submit the header and payload to the PCC channel and get the response back from the platform */
-  response = (PCC_MPAM_MSC_WRITE_RESP_PARA *) val_pcc_cmd_response(
-              (uint32_t)subspace_id, header, (void *)&payload.write, sizeof(payload.write));
-
-  if (response == NULL || response->status != MPAM_PCC_CMD_SUCCESS) {
-      val_print(ERROR,
-                "\n    Failed to write MPAM register with offset (0x%x) via PCC", reg_offset);
-      val_print(ERROR, " for MSC index = 0x%x", msc_index);
-      if (response != NULL) {
-          val_print(ERROR, "\n    PCC command response code = 0x%x", response->status);
-      }
-      return;
-  }
-  return;
+  val_mpam_pcc_xfer(msc_index, MPAM_MSC_WRITE_CMD_ID, reg_offset, 1U, &data);
 }
 
 /**
@@ -2014,6 +2357,7 @@ void val_mem_free_shared_memcpybuf(uint32_t num_pe)
   }
 
   val_memory_free(g_shared_memcpy_buffer);
+  g_shared_memcpy_buf_size = 0;
 }
 
 /**
@@ -2032,6 +2376,7 @@ uint32_t val_alloc_shared_memcpybuf(uint64_t mem_base, uint64_t buffer_size, uin
 
   buffer = NULL;
   g_shared_memcpy_buffer = NULL;
+  g_shared_memcpy_buf_size = 0;
 
   buffer = (void *)val_memory_alloc(pe_count * sizeof(uint64_t));
 
@@ -2055,6 +2400,7 @@ uint32_t val_alloc_shared_memcpybuf(uint64_t mem_base, uint64_t buffer_size, uin
   }
 
   pal_pe_data_cache_ops_by_va((uint64_t)&g_shared_memcpy_buffer, CLEAN_AND_INVALIDATE);
+  g_shared_memcpy_buf_size = buffer_size;
 
   return 1;
 }
@@ -2071,6 +2417,592 @@ uint64_t val_get_shared_memcpybuf(uint32_t pe_index)
     return (uint64_t) (g_shared_memcpy_buffer[pe_index]);
 }
 
+#define MPAM_TRAFFIC_CHUNK_UNITS   16384   /* Units generated between two timer checks */
+#define MPAM_TRAFFIC_CHASE_SEED    0x9E3779B97F4A7C15ULL
+
+static MPAM_TRAFFIC_CFG_t g_mpam_traffic_cfg;
+
+/**
+ * @brief   Load every 64-byte block of a buffer with LDP pairs
+ *
+ * @param   s        source, 64-byte aligned
+ * @param   blocks   number of 64-byte blocks, non-zero
+ *
+ * @return  None
+ */
+static void mpam_traffic_read(const uint64_t *s, uint64_t blocks)
+{
+#ifdef __aarch64__
+    __asm__ volatile (
+        "1:\n"
+        "ldp x4, x5, [%[s]]\n"
+        "ldp x6, x7, [%[s], #16]\n"
+        "ldp x8, x9, [%[s], #32]\n"
+        "ldp x10, x11, [%[s], #48]\n"
+        "add %[s], %[s], #64\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [s] "+r" (s), [n] "+r" (blocks)
+        :
+        : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "cc", "memory");
+#else
+    volatile const uint64_t *v = s;
+    uint64_t sink = 0;
+
+    while (blocks--) {
+        sink ^= v[0] ^ v[1] ^ v[2] ^ v[3] ^ v[4] ^ v[5] ^ v[6] ^ v[7];
+        v += 8;
+    }
+    (void)sink;
+#endif
+}
+
+/**
+ * @brief   Store every 64-byte block of a buffer with STP pairs
+ *
+ * @param   d        destination, 64-byte aligned
+ * @param   blocks   number of 64-byte blocks, non-zero
+ *
+ * @return  None
+ */
+static void mpam_traffic_write(uint64_t *d, uint64_t blocks)
+{
+#ifdef __aarch64__
+    __asm__ volatile (
+        "1:\n"
+        "stp %[d], %[n], [%[d]]\n"
+        "stp %[d], %[n], [%[d], #16]\n"
+        "stp %[d], %[n], [%[d], #32]\n"
+        "stp %[d], %[n], [%[d], #48]\n"
+        "add %[d], %[d], #64\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [d] "+r" (d), [n] "+r" (blocks)
+        :
+        : "cc", "memory");
+#else
+    volatile uint64_t *v = d;
+
+    while (blocks--) {
+        v[0] = v[1] = v[2] = v[3] = v[4] = v[5] = v[6] = v[7] = blocks;
+        v += 8;
+    }
+#endif
+}
+
+/**
+ * @brief   Copy 64-byte blocks with LDP/STP pairs, or with the non-temporal
+ *          LDNP/STNP pairs when nt is set
+ *
+ * @param   d        destination, 64-byte aligned
+ * @param   s        source, 64-byte aligned
+ * @param   blocks   number of 64-byte blocks, non-zero
+ * @param   nt       1 to hint the accesses as non-temporal
+ *
+ * @return  None
+ */
+static void mpam_traffic_copy(uint64_t *d, const uint64_t *s, uint64_t blocks, uint32_t nt)
+{
+#ifdef __aarch64__
+    if (nt) {
+        __asm__ volatile (
+            "1:\n"
+            "ldnp x4, x5, [%[s]]\n"
+            "ldnp x6, x7, [%[s], #16]\n"
+            "ldnp x8, x9, [%[s], #32]\n"
+            "ldnp x10, x11, [%[s], #48]\n"
+            "add %[s], %[s], #64\n"
+            "stnp x4, x5, [%[d]]\n"
+            "stnp x6, x7, [%[d], #16]\n"
+            "stnp x8, x9, [%[d], #32]\n"
+            "stnp x10, x11, [%[d], #48]\n"
+            "add %[d], %[d], #64\n"
+            "subs %[n], %[n], #1\n"
+            "b.ne 1b\n"
+            : [d] "+r" (d), [s] "+r" (s), [n] "+r" (blocks)
+            :
+            : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "cc", "memory");
+        return;
+    }
+
+    __asm__ volatile (
+        "1:\n"
+        "ldp x4, x5, [%[s]]\n"
+        "ldp x6, x7, [%[s], #16]\n"
+        "ldp x8, x9, [%[s], #32]\n"
+        "ldp x10, x11, [%[s], #48]\n"
+        "add %[s], %[s], #64\n"
+        "stp x4, x5, [%[d]]\n"
+        "stp x6, x7, [%[d], #16]\n"
+        "stp x8, x9, [%[d], #32]\n"
+        "stp x10, x11, [%[d], #48]\n"
+        "add %[d], %[d], #64\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [d] "+r" (d), [s] "+r" (s), [n] "+r" (blocks)
+        :
+        : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "cc", "memory");
+#else
+    volatile uint64_t *vd = d;
+    volatile const uint64_t *vs = s;
+
+    (void)nt;
+    while (blocks--) {
+        vd[0] = vs[0]; vd[1] = vs[1]; vd[2] = vs[2]; vd[3] = vs[3];
+        vd[4] = vs[4]; vd[5] = vs[5]; vd[6] = vs[6]; vd[7] = vs[7];
+        vd += 8;
+        vs += 8;
+    }
+#endif
+}
+
+/**
+ * @brief   Issue one 64-bit load every stride bytes
+ *
+ * @param   s        first address to load, 8-byte aligned
+ * @param   count    number of loads
+ * @param   stride   distance between two loads in bytes
+ *
+ * @return  None
+ */
+static void mpam_traffic_stride(const uint8_t *s, uint64_t count, uint64_t stride)
+{
+    uint64_t sink = 0;
+
+    while (count--) {
+        sink ^= *(volatile const uint64_t *)s;
+        s += stride;
+    }
+    (void)sink;
+}
+
+/**
+ * @brief   Link the stride sized nodes of a buffer into one random cycle so
+ *          that each load of a walk depends on the previous one and the
+ *          hardware prefetchers cannot run ahead of it
+ *
+ * @param   buf      buffer base, 8-byte aligned
+ * @param   size     size of the buffer in bytes
+ * @param   stride   node size in bytes, multiple of 8
+ *
+ * @return  number of nodes in the cycle, 0 if the buffer holds fewer than two
+ */
+static uint64_t mpam_traffic_chase_init(uint8_t *buf, uint64_t size, uint64_t stride)
+{
+    uint64_t nodes = size / stride;
+    uint64_t seed = MPAM_TRAFFIC_CHASE_SEED;
+    uint64_t *node_i;
+    uint64_t *node_j;
+    uint64_t next;
+    uint64_t i;
+    uint64_t j;
+
+    if (nodes < 2)
+        return 0;
+
+    for (i = 0; i < nodes; i++)
+        *(uint64_t *)(buf + i * stride) = i;
+
+    /* Sattolo's shuffle, the resulting permutation is a single cycle */
+    for (i = nodes - 1; i > 0; i--) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        j = (seed >> 33) % i;
+        node_i = (uint64_t *)(buf + i * stride);
+        node_j = (uint64_t *)(buf + j * stride);
+        next = *node_i;
+        *node_i = *node_j;
+        *node_j = next;
+    }
+
+    /* Turn the successor indices into addresses */
+    for (i = 0; i < nodes; i++) {
+        node_i = (uint64_t *)(buf + i * stride);
+        *node_i = (uint64_t)(buf + *node_i * stride);
+    }
+
+    return nodes;
+}
+
+/**
+ * @brief   Follow a pointer-chase cycle for a number of hops
+ *
+ * @param   node     node to start from
+ * @param   hops     number of dependent loads
+ *
+ * @return  node reached after the last hop
+ */
+static uint64_t *mpam_traffic_chase(uint64_t *node, uint64_t hops)
+{
+    while (hops--)
+        node = (uint64_t *)*(volatile uint64_t *)node;
+
+    return node;
+}
+
+/**
+ * @brief   Convert a byte count and elapsed generic timer ticks into bytes/sec
+ *          without overflowing for long or large runs
+ *
+ * @param   bytes    bytes moved
+ * @param   ticks    elapsed ticks
+ * @param   freq     generic timer frequency in Hz
+ *
+ * @return  bytes per second, 0 if it cannot be computed
+ */
+static uint64_t mpam_traffic_rate(uint64_t bytes, uint64_t ticks, uint64_t freq)
+{
+    uint64_t us;
+
+    if (!ticks || !freq)
+        return 0;
+
+    us = (ticks * MICRO_SECONDS) / freq;
+    if (!us)
+        return (bytes * freq) / ticks;
+
+    return (bytes / us) * MICRO_SECONDS + ((bytes % us) * MICRO_SECONDS) / us;
+}
+
+/**
+ * @brief   Generate a known memory load from the current PE.
+ *
+ *          The buffer is walked in the pattern selected by cfg->mode until
+ *          cfg->target_bytes have been moved or cfg->duration_us has elapsed,
+ *          whichever comes first; at least one of the two must be set. A
+ *          pointer-chase buffer is linked before the timed region starts.
+ *          When cfg->set_partid is set, MPAM2_EL2 carries cfg->partid and
+ *          cfg->pmg during the run and is restored afterwards.
+ *
+ * @param   cfg      traffic description
+ * @param   result   bytes moved, ticks taken and achieved bytes/sec
+ *
+ * @return  ACS_STATUS_PASS on success, ACS_STATUS_ERR on an invalid config
+ */
+uint32_t val_mpam_traffic_run(const MPAM_TRAFFIC_CFG_t *cfg, MPAM_TRAFFIC_RESULT_t *result)
+{
+    uint8_t *src;
+    uint8_t *dst;
+    uint64_t *node = NULL;
+    uint64_t stride;
+    uint64_t pass_units;
+    uint64_t units;
+    uint64_t pos = 0;
+    uint64_t bytes = 0;
+    uint64_t byte_limit;
+    uint64_t freq;
+    uint64_t start = 0;
+    uint64_t limit_ticks = 0;
+    uint64_t mpam2_el2 = 0;
+    uint32_t use_counter;
+
+    if ((cfg == NULL) || (result == NULL))
+        return ACS_STATUS_ERR;
+
+    result->bytes = 0;
+    result->ticks = 0;
+    result->bytes_per_sec = 0;
+
+    src = (uint8_t *)cfg->buf_base;
+    dst = cfg->dst_base ? (uint8_t *)cfg->dst_base : src + cfg->buf_size;
+    stride = cfg->stride ? cfg->stride : MPAM_TRAFFIC_DEF_STRIDE;
+
+    if (!cfg->target_bytes && !cfg->duration_us) {
+        val_print(ERROR, "\n       Traffic needs a byte count or a duration");
+        return ACS_STATUS_ERR;
+    }
+
+    if ((src == NULL) || ((uint64_t)src & (MPAM_TRAFFIC_LINE_SIZE - 1)) ||
+        (cfg->buf_size < MPAM_TRAFFIC_LINE_SIZE)) {
+        val_print(ERROR, "\n       Invalid traffic buffer 0x%llx", (uint64_t)src);
+        val_print(ERROR, " size 0x%llx", cfg->buf_size);
+        return ACS_STATUS_ERR;
+    }
+
+    switch (cfg->mode) {
+    case MPAM_TRAFFIC_READ:
+    case MPAM_TRAFFIC_WRITE:
+        pass_units = cfg->buf_size / MPAM_TRAFFIC_LINE_SIZE;
+        break;
+    case MPAM_TRAFFIC_COPY:
+    case MPAM_TRAFFIC_COPY_NT:
+        if ((uint64_t)dst & (MPAM_TRAFFIC_LINE_SIZE - 1)) {
+            val_print(ERROR, "\n       Unaligned traffic destination 0x%llx", (uint64_t)dst);
+            return ACS_STATUS_ERR;
+        }
+        pass_units = cfg->buf_size / MPAM_TRAFFIC_LINE_SIZE;
+        break;
+    case MPAM_TRAFFIC_STRIDE:
+    case MPAM_TRAFFIC_CHASE:
+        if ((stride < sizeof(uint64_t)) || (stride & (sizeof(uint64_t) - 1))) {
+            val_print(ERROR, "\n       Invalid traffic stride 0x%llx", stride);
+            return ACS_STATUS_ERR;
+        }
+        if (cfg->mode == MPAM_TRAFFIC_STRIDE) {
+            pass_units = (cfg->buf_size - sizeof(uint64_t)) / stride + 1;
+            break;
+        }
+        pass_units = mpam_traffic_chase_init(src, cfg->buf_size, stride);
+        if (!pass_units) {
+            val_print(ERROR, "\n       Traffic buffer too small to chase 0x%llx", cfg->buf_size);
+            return ACS_STATUS_ERR;
+        }
+        node = (uint64_t *)src;
+        break;
+    default:
+        val_print(ERROR, "\n       Invalid traffic mode %d", cfg->mode);
+        return ACS_STATUS_ERR;
+    }
+
+    freq = val_get_counter_frequency();
+    use_counter = (freq != 0) &&
+                  !(acs_policy_get_el1skiptrap_mask() & EL1SKIPTRAP_CNTPCT);
+
+    byte_limit = cfg->target_bytes;
+    if (cfg->duration_us && !use_counter && !byte_limit) {
+        val_print(WARN, "\n       Generic timer unavailable, traffic limited to one pass");
+        byte_limit = pass_units * MPAM_TRAFFIC_LINE_SIZE;
+    }
+
+    if (cfg->set_partid) {
+        mpam2_el2 = val_mpam_reg_read(MPAM2_EL2);
+        if (val_mpam_program_el2(cfg->partid, cfg->pmg))
+            return ACS_STATUS_ERR;
+    }
+
+    if (use_counter) {
+        limit_ticks = (cfg->duration_us * freq) / MICRO_SECONDS;
+        start = syscounter_read();
+    }
+
+    do {
+        /* Generate in chunks so that the deadline and byte limit are checked often */
+        units = pass_units - pos;
+        if (units > MPAM_TRAFFIC_CHUNK_UNITS)
+            units = MPAM_TRAFFIC_CHUNK_UNITS;
+        if (byte_limit && (units > (byte_limit - bytes + MPAM_TRAFFIC_LINE_SIZE - 1) /
+                                   MPAM_TRAFFIC_LINE_SIZE))
+            units = (byte_limit - bytes + MPAM_TRAFFIC_LINE_SIZE - 1) / MPAM_TRAFFIC_LINE_SIZE;
+
+        switch (cfg->mode) {
+        case MPAM_TRAFFIC_READ:
+            mpam_traffic_read((uint64_t *)(src + pos * MPAM_TRAFFIC_LINE_SIZE), units);
+            break;
+        case MPAM_TRAFFIC_WRITE:
+            mpam_traffic_write((uint64_t *)(src + pos * MPAM_TRAFFIC_LINE_SIZE), units);
+            break;
+        case MPAM_TRAFFIC_COPY:
+        case MPAM_TRAFFIC_COPY_NT:
+            mpam_traffic_copy((uint64_t *)(dst + pos * MPAM_TRAFFIC_LINE_SIZE),
+                              (uint64_t *)(src + pos * MPAM_TRAFFIC_LINE_SIZE), units,
+                              cfg->mode == MPAM_TRAFFIC_COPY_NT);
+            break;
+        case MPAM_TRAFFIC_STRIDE:
+            mpam_traffic_stride(src + pos * stride, units, stride);
+            break;
+        default:
+            node = mpam_traffic_chase(node, units);
+            break;
+        }
+
+        bytes += units * MPAM_TRAFFIC_LINE_SIZE;
+        pos += units;
+        if (pos == pass_units)
+            pos = 0;
+
+        if (byte_limit && (bytes >= byte_limit))
+            break;
+    } while (!cfg->duration_us || !use_counter || ((syscounter_read() - start) < limit_ticks));
+
+    /* Count the stores only once they have completed */
+    dsbsy();
+
+    if (use_counter) {
+        result->ticks = syscounter_read() - start;
+        result->bytes_per_sec = mpam_traffic_rate(bytes, result->ticks, freq);
+    }
+    result->bytes = bytes;
+
+    if (cfg->set_partid)
+        val_mpam_reg_write(MPAM2_EL2, mpam2_el2);
+
+    val_print(DEBUG, "\n       Traffic mode %d", cfg->mode);
+    val_print(DEBUG, " moved 0x%llx bytes", bytes);
+    val_print(DEBUG, " at 0x%llx bytes/sec", result->bytes_per_sec);
+
+    return ACS_STATUS_PASS;
+}
+
+/**
+ * @brief   Point a traffic config at the shared memcpy buffer of a PE
+ *
+ * @param   cfg        traffic config to update
+ * @param   pe_index   PE whose buffer is used
+ *
+ * @return  None
+ */
+static void mpam_traffic_bind_pe_buffer(MPAM_TRAFFIC_CFG_t *cfg, uint32_t pe_index)
+{
+    cfg->buf_base = val_get_shared_memcpybuf(pe_index);
+    cfg->dst_base = 0;
+
+    /* Copies use the upper half of the same PE buffer as destination */
+    if ((cfg->mode == MPAM_TRAFFIC_COPY) || (cfg->mode == MPAM_TRAFFIC_COPY_NT))
+        cfg->dst_base = cfg->buf_base + cfg->buf_size;
+}
+
+/**
+ * @brief   Secondary PE payload of val_mpam_traffic_run_all_pe. Reports the
+ *          bytes and ticks of this PE through the shared test data.
+ *
+ * @return  None
+ */
+static void mpam_traffic_payload(void)
+{
+    uint32_t pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+    MPAM_TRAFFIC_CFG_t cfg;
+    MPAM_TRAFFIC_RESULT_t result;
+
+    val_pe_cache_clean_invalidate_range((uint64_t)&g_mpam_traffic_cfg,
+                                        sizeof(g_mpam_traffic_cfg));
+    val_memcpy(&cfg, &g_mpam_traffic_cfg, sizeof(cfg));
+    mpam_traffic_bind_pe_buffer(&cfg, pe_index);
+
+    if (val_mpam_traffic_run(&cfg, &result) != ACS_STATUS_PASS) {
+        val_set_test_data(pe_index, 0, 0);
+        val_set_status(pe_index, RESULT_FAIL(01));
+        return;
+    }
+
+    val_set_test_data(pe_index, result.bytes, result.ticks);
+    val_set_status(pe_index, RESULT_PASS);
+}
+
+/**
+ * @brief   Generate the same traffic concurrently on PEs [0, num_pe).
+ *
+ *          Every PE walks its own buffer from val_alloc_shared_memcpybuf(),
+ *          so cfg->buf_base and cfg->dst_base must be 0 and cfg->buf_size
+ *          must fit the shared buffers. Copies split each buffer into a
+ *          source and a destination half, so they need twice cfg->buf_size.
+ *          Secondaries are launched before the
+ *          primary starts its own share so that the loads overlap. The total
+ *          holds the summed bytes and per-PE bytes/sec and the longest run.
+ *          The status of the secondary PEs is overwritten.
+ *
+ * @param   cfg      traffic description applied to every PE
+ * @param   num_pe   number of PEs generating traffic
+ * @param   total    aggregated result
+ *
+ * @return  ACS_STATUS_PASS if every PE completed, ACS_STATUS_FAIL or
+ *          ACS_STATUS_ERR otherwise
+ */
+uint32_t val_mpam_traffic_run_all_pe(const MPAM_TRAFFIC_CFG_t *cfg, uint32_t num_pe,
+                                     MPAM_TRAFFIC_RESULT_t *total)
+{
+    MPAM_TRAFFIC_CFG_t own_cfg;
+    MPAM_TRAFFIC_RESULT_t result;
+    uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+    uint32_t timeout_us = PE_COMPLETION_TIMEOUT_US;
+    uint32_t fanout = 0;
+    uint32_t status;
+    uint32_t pe_index;
+    uint64_t freq;
+    uint64_t bytes;
+    uint64_t ticks;
+    uint64_t need;
+
+    if ((cfg == NULL) || (total == NULL) || !num_pe)
+        return ACS_STATUS_ERR;
+
+    total->bytes = 0;
+    total->ticks = 0;
+    total->bytes_per_sec = 0;
+
+    if (cfg->buf_base || cfg->dst_base || (g_shared_memcpy_buffer == NULL) ||
+        !g_shared_memcpy_buf_size) {
+        val_print(ERROR, "\n       All PE traffic needs the shared memcpy buffers");
+        return ACS_STATUS_ERR;
+    }
+
+    need = cfg->buf_size;
+    if ((cfg->mode == MPAM_TRAFFIC_COPY) || (cfg->mode == MPAM_TRAFFIC_COPY_NT))
+        need = (cfg->buf_size > g_shared_memcpy_buf_size) ? cfg->buf_size : 2 * cfg->buf_size;
+
+    if (need > g_shared_memcpy_buf_size) {
+        val_print(ERROR, "\n       Traffic needs 0x%llx bytes per PE", need);
+        val_print(ERROR, " shared buffers hold 0x%llx", g_shared_memcpy_buf_size);
+        return ACS_STATUS_ERR;
+    }
+
+    val_memcpy(&g_mpam_traffic_cfg, (void *)cfg, sizeof(g_mpam_traffic_cfg));
+    val_pe_cache_clean_invalidate_range((uint64_t)&g_mpam_traffic_cfg,
+                                        sizeof(g_mpam_traffic_cfg));
+
+    if (num_pe > 1) {
+        for (pe_index = 0; pe_index < num_pe; pe_index++) {
+            if (pe_index != my_index)
+                val_set_status(pe_index, RESULT_PENDING(0));
+        }
+
+        val_pe_completion_reset();
+        if (val_pe_fanout_execute(num_pe, mpam_traffic_payload, 0) == ACS_STATUS_PASS) {
+            fanout = 1;
+        } else {
+            for (pe_index = 0; pe_index < num_pe; pe_index++) {
+                if (pe_index != my_index)
+                    val_execute_on_pe(pe_index, mpam_traffic_payload, 0);
+            }
+        }
+    }
+
+    val_memcpy(&own_cfg, (void *)cfg, sizeof(own_cfg));
+    mpam_traffic_bind_pe_buffer(&own_cfg, my_index);
+    status = val_mpam_traffic_run(&own_cfg, &result);
+
+    if (num_pe > 1) {
+        /* The secondaries run for as long as the primary, allow for that on top */
+        if (cfg->duration_us < (uint64_t)(0xFFFFFFFFu - timeout_us))
+            timeout_us += (uint32_t)cfg->duration_us;
+        else
+            timeout_us = 0xFFFFFFFFu;
+
+        if (val_pe_completion_wait(num_pe, timeout_us))
+            status = ACS_STATUS_FAIL;
+        if (fanout)
+            val_pe_fanout_complete();
+    }
+
+    if (status != ACS_STATUS_PASS)
+        return status;
+
+    freq = val_get_counter_frequency();
+    total->bytes = result.bytes;
+    total->ticks = result.ticks;
+    total->bytes_per_sec = result.bytes_per_sec;
+
+    for (pe_index = 0; pe_index < num_pe; pe_index++) {
+        if (pe_index == my_index)
+            continue;
+
+        if (!IS_TEST_PASS(val_get_status(pe_index))) {
+            val_print(ERROR, "\n       Traffic failed on PE index %d", pe_index);
+            status = ACS_STATUS_FAIL;
+            continue;
+        }
+
+        val_get_test_data(pe_index, &bytes, &ticks);
+        total->bytes += bytes;
+        total->bytes_per_sec += mpam_traffic_rate(bytes, ticks, freq);
+        if (ticks > total->ticks)
+            total->ticks = ticks;
+    }
+
+    val_print(DEBUG, "\n       Traffic on %d PEs", num_pe);
+    val_print(DEBUG, " at 0x%llx bytes/sec", total->bytes_per_sec);
+
+    return status;
+}
+
 /**
   * @brief   This API programs MPAM2_EL2 register with given PARTID and PMG
   *
@@ -2273,10 +3205,8 @@ val_mpam_mbwu_clear_overflow_status(uint32_t msc_index)
 void
 val_mpam_mbwu_wait_for_update(uint32_t msc_index)
 {
-    uint64_t nrdy_timeout = val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0);
-
-    while (nrdy_timeout)
-        --nrdy_timeout;
+    /* MSC not-ready signalling time is given in microseconds */
+    val_deadline_wait(val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0));
 }
 
 static
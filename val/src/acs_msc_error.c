@@ -326,7 +326,6 @@ void val_mpam_msc_generate_msmon_oflow_error(uint32_t msc_index, uint16_t mon_co
 {
 
     uint64_t max_count = 0;
-    uint64_t nrdy_timeout;
 
     /* Write mon_count to MON_SEL register to configure the last monitor */
     val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MON_SEL, mon_count);
@@ -368,10 +367,8 @@ void val_mpam_msc_generate_msmon_oflow_error(uint32_t msc_index, uint16_t mon_co
 
     val_mem_issue_dsb();
 
-    nrdy_timeout = val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0);
-    while (nrdy_timeout) {
-        --nrdy_timeout;
-    };
+    /* MSC not-ready signalling time is given in microseconds */
+    val_deadline_wait(val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0));
 
     return;
 }
@@ -25,6 +25,15 @@
 
 static PCC_INFO_TABLE *g_pcc_info_table;
 
+/* Per-subspace command state, indexed like the PCC info table */
+typedef struct {
+  uint32_t        pending;          /* Doorbell rung, response not yet collected */
+  uint32_t        turnaround_armed; /* turnaround holds the last command completion */
+  val_deadline_t  turnaround;       /* Minimum request turnaround since last completion */
+} PCC_CHANNEL_STATE;
+
+static PCC_CHANNEL_STATE *g_pcc_channel;
+
 /* Doorbell registers, Command complete update/check registers are represented in GAS format.
    Each GAS format describes it's own access_size. Perform read/write based on the access_size */
 static uint64_t
@@ -176,61 +185,71 @@ val_pcc_map_shared_memory(const PCC_SUBSPACE_TYPE_3 *subspace)
 }
 
 /**
-  @brief  Wait for the platform to return ownership of a PCC channel.
+  @brief  Check the command complete bit of a PCC subspace.
+
+  @param  arg  PCC subspace containing the completion register.
+
+  @return 1 when the platform has returned ownership of the channel, else 0.
+**/
+static uint32_t
+val_pcc_cmd_complete_cond(void *arg)
+{
+  const PCC_SUBSPACE_TYPE_3 *subspace = arg;
+
+  return (val_pcc_read_gas_register(&subspace->cmd_complete_chk_reg) &
+          subspace->cmd_complete_chk_mask) != 0U;
+}
+
+/**
+  @brief  Wait for the platform to return ownership of a PCC channel. The
+          doorbell acknowledgement is polled with a backoff that starts at
+          DEADLINE_DELAY_MIN_US, so fast platforms are not held to a fixed
+          poll interval.
 
-  @param  subspace           PCC subspace containing the completion register.
-  @param  phase              Text used to identify the poll in debug output.
-  @param  initial_delay_usec Delay before the first completion check.
+  @param  subspace  PCC subspace containing the completion register.
+  @param  phase     Text used to identify the poll in debug output.
 
   @return PCC_STATUS_SUCCESS when command complete is set, or
           RETURN_FAILURE after the timeout.
 **/
 static uint32_t
-val_pcc_wait_for_completion(const PCC_SUBSPACE_TYPE_3 *subspace, const char *phase,
-                            uint32_t delay_usec)
+val_pcc_wait_for_completion(const PCC_SUBSPACE_TYPE_3 *subspace, const char *phase)
 {
-  uint64_t cmd_complete;
-  uint64_t cmd_complete_raw;
-  uint32_t remaining_usec;
-  uint32_t waited_usec = 0U;
-
-  /* Keep the advisory initial delay within the overall polling timeout. */
-  if (delay_usec > PCC_COMMAND_TIMEOUT_USEC) {
-      delay_usec = PCC_COMMAND_TIMEOUT_USEC;
+  if (val_poll_until(val_pcc_cmd_complete_cond, (void *)subspace,
+                     PCC_COMMAND_TIMEOUT_USEC, DEADLINE_BACKOFF_DELAY) != ACS_STATUS_PASS) {
+      val_print(DEBUG, "\n    PCC: %a poll timed out, raw=0x%llx", phase,
+                val_pcc_read_gas_register(&subspace->cmd_complete_chk_reg));
+      return RETURN_FAILURE;
   }
 
-  /* Initial delay before the agent can probe for command completion. */
-  if (delay_usec != 0U) {
-      val_time_delay_ms(delay_usec);
-      waited_usec = delay_usec;
-  }
+  val_print(DEBUG, "\n    PCC: %a command complete", phase);
+  return PCC_STATUS_SUCCESS;
+}
 
-  /* Probe the command complete check register to verify that the platform has processed the command
-     and agent can read the response back */
-  while (waited_usec <= PCC_COMMAND_TIMEOUT_USEC) {
-      cmd_complete_raw = val_pcc_read_gas_register(&subspace->cmd_complete_chk_reg);
-      cmd_complete = cmd_complete_raw & subspace->cmd_complete_chk_mask;
-      val_print(DEBUG,
-                "\n    PCC: %a poll raw=0x%llx masked=0x%llx waited=%u us",
-                phase, cmd_complete_raw, cmd_complete, waited_usec);
-
-      if (cmd_complete != 0U) {
-          return PCC_STATUS_SUCCESS;
-      }
+/**
+  @brief  Resolve a subspace ID to its Type 3 descriptor and channel state.
 
-      if (waited_usec >= PCC_COMMAND_TIMEOUT_USEC) {
-          break;
-      }
+  @param  subspace_id  Subspace ID from the PCCT.
+  @param  subspace     Returned Type 3 subspace descriptor.
+
+  @return Channel state, or NULL when the subspace is unknown.
+**/
+static PCC_CHANNEL_STATE *
+val_pcc_get_channel(uint32_t subspace_id, PCC_SUBSPACE_TYPE_3 **subspace)
+{
+  uint32_t pcc_idx;
+
+  pcc_idx = val_pcc_get_ss_info_idx(subspace_id);
+  if (pcc_idx == RETURN_FAILURE)
+      return NULL;
 
-      /* Poll at a fixed interval without extending the overall timeout. */
-      remaining_usec = PCC_COMMAND_TIMEOUT_USEC - waited_usec;
-      delay_usec = (remaining_usec < PCC_POLL_INTERVAL_USEC) ?
-                   remaining_usec : PCC_POLL_INTERVAL_USEC;
-      val_time_delay_ms(delay_usec);
-      waited_usec += delay_usec;
+  if (g_pcc_channel == NULL) {
+      val_print(ERROR, "\n    PCC: channel state is not allocated");
+      return NULL;
   }
 
-  return RETURN_FAILURE;
+  *subspace = &g_pcc_info_table->pcc_info[pcc_idx].type_spec_info.pcc_ss_type_3;
+  return &g_pcc_channel[pcc_idx];
 }
 
 /**
@@ -249,6 +268,16 @@ val_pcc_create_info_table(uint64_t *pcc_info_table)
   g_pcc_info_table = (PCC_INFO_TABLE *)pcc_info_table;
   pal_pcc_create_info_table(g_pcc_info_table);
 
+  if (g_pcc_info_table->subspace_cnt != 0U) {
+      g_pcc_channel = val_memory_alloc(g_pcc_info_table->subspace_cnt *
+                                       sizeof(PCC_CHANNEL_STATE));
+      if (g_pcc_channel == NULL)
+          val_print(ERROR, "\n    PCC: channel state allocation failed");
+      else
+          val_memory_zero(g_pcc_channel,
+                          g_pcc_info_table->subspace_cnt * sizeof(PCC_CHANNEL_STATE));
+  }
+
   val_print(DEBUG, "\n    PCC: info table=0x%llx subspace count=%u",
             (uint64_t)g_pcc_info_table, g_pcc_info_table->subspace_cnt);
 }
@@ -318,37 +347,40 @@ val_pcc_map_registers(uint32_t subspace_id)
 }
 
 /**
-  @brief  Submit a command using the ACPI PCC doorbell protocol.
+  @brief  Submit a command using the ACPI PCC doorbell protocol and return
+          without waiting for the platform. Collect the response with
+          val_pcc_cmd_complete; val_pcc_cmd_poll checks it without blocking.
 
   @param  subspace_id  Subspace ID from the PCCT.
   @param  command      Protocol message header.
   @param  data         Payload copied into the shared communication region.
   @param  data_size    Payload size in bytes.
 
-  @return Pointer to the response payload in shared memory, or NULL on failure.
+  @return PCC_STATUS_SUCCESS once the doorbell is rung, or RETURN_FAILURE.
 **/
-void
-*val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
+uint32_t
+val_pcc_cmd_submit(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
 {
-  uint32_t pcc_idx;
   uint64_t shared_mem_addr;
-  uint64_t response_addr;
   uint64_t cmd_complete_update_val;
   uint64_t doorbell_val;
   PCC_SUBSPACE_TYPE_3 *subspace;
+  PCC_CHANNEL_STATE *channel;
 
   if ((data == NULL) && (data_size != 0U)) {
       val_print(ERROR, "\n    PCC: command payload is NULL but its size is %u", data_size);
-      return NULL;
+      return RETURN_FAILURE;
   }
 
   /* Resolve the PCCT subspace ID to its cached Type 3 descriptor. */
-  pcc_idx = val_pcc_get_ss_info_idx(subspace_id);
-  if (pcc_idx == RETURN_FAILURE) {
-      return NULL;
-  }
+  channel = val_pcc_get_channel(subspace_id, &subspace);
+  if (channel == NULL)
+      return RETURN_FAILURE;
 
-  subspace = &g_pcc_info_table->pcc_info[pcc_idx].type_spec_info.pcc_ss_type_3;
+  if (channel->pending) {
+      val_print(ERROR, "\n    PCC: subspace id : 0x%x has a command in flight", subspace_id);
+      return RETURN_FAILURE;
+  }
 
   /* Verify that the channel can hold the PCC header and command payload. */
   if ((subspace->memory_length < PCC_TY3_COMM_SPACE) ||
@@ -356,18 +388,31 @@ void
       val_print(ERROR,
                 "\n    PCC: payload size %u exceeds channel memory length %u for subspace %u",
                 data_size, subspace->memory_length, subspace_id);
-      return NULL;
+      return RETURN_FAILURE;
+  }
+
+  /* MinimumRequestTurnaround runs from the previous completion, so only the
+     part of it not already spent by the caller is waited for here. Without
+     the generic timer that part cannot be measured, so the whole turnaround
+     is delayed. */
+  if (channel->turnaround_armed) {
+      if (channel->turnaround.use_counter) {
+          while (!val_deadline_expired(&channel->turnaround))
+              ;
+      } else {
+          val_time_delay_ms(subspace->min_req_turnaround_usec);
+      }
+      channel->turnaround_armed = 0;
   }
 
   /* Note : For information on Doorbell Protocol refer ACPI 6.5 specification; section 14.5 */
   /* OSPM checks that there is no command pending completion and the subspace is free to use.
      A set completion bit means OSPM owns the shared-memory channel. */
-  if (val_pcc_wait_for_completion(subspace, "pre-command",
-                                  subspace->min_req_turnaround_usec) != PCC_STATUS_SUCCESS) {
+  if (val_pcc_wait_for_completion(subspace, "pre-command") != PCC_STATUS_SUCCESS) {
       val_print(ERROR,
                 "\n    PCC: channel remained busy for %u us for subspace id : 0x%x",
                 PCC_COMMAND_TIMEOUT_USEC, subspace_id);
-      return NULL;
+      return RETURN_FAILURE;
   }
 
   shared_mem_addr = subspace->base_addr;
@@ -410,29 +455,111 @@ void
 
   val_print(DEBUG, "\n    PCC: doorbell write value=0x%llx", doorbell_val);
 
-  /* NominalLatency delays the first check; the ACS timeout remains the limit. */
-  if (val_pcc_wait_for_completion(subspace, "post-command",
-                                  subspace->nominal_latency_usec) != PCC_STATUS_SUCCESS) {
+  channel->pending = 1;
+  return PCC_STATUS_SUCCESS;
+}
+
+/**
+  @brief  Check without blocking whether a submitted PCC command is done.
+
+  @param  subspace_id  Subspace ID from the PCCT.
+
+  @return PCC_STATUS_SUCCESS when the response can be collected,
+          PCC_STATUS_PENDING while the platform owns the channel, or
+          RETURN_FAILURE when no command is in flight.
+**/
+uint32_t
+val_pcc_cmd_poll(uint32_t subspace_id)
+{
+  PCC_SUBSPACE_TYPE_3 *subspace;
+  PCC_CHANNEL_STATE *channel;
+
+  channel = val_pcc_get_channel(subspace_id, &subspace);
+  if ((channel == NULL) || !channel->pending)
+      return RETURN_FAILURE;
+
+  return val_pcc_cmd_complete_cond(subspace) ? PCC_STATUS_SUCCESS : PCC_STATUS_PENDING;
+}
+
+/**
+  @brief  Wait for a command submitted with val_pcc_cmd_submit to complete.
+
+  @param  subspace_id  Subspace ID from the PCCT.
+
+  @return Pointer to the response payload in shared memory, or NULL on failure.
+          The payload stays valid until the next command on the subspace.
+**/
+void
+*val_pcc_cmd_complete(uint32_t subspace_id)
+{
+  uint64_t response_addr;
+  PCC_SUBSPACE_TYPE_3 *subspace;
+  PCC_CHANNEL_STATE *channel;
+
+  channel = val_pcc_get_channel(subspace_id, &subspace);
+  if (channel == NULL)
+      return NULL;
+
+  if (!channel->pending) {
+      val_print(ERROR, "\n    PCC: no command in flight for subspace id : 0x%x", subspace_id);
+      return NULL;
+  }
+
+  /* NominalLatency is advisory; the backoff poll adapts to the actual latency
+     and the ACS timeout remains the limit. */
+  channel->pending = 0;
+  if (val_pcc_wait_for_completion(subspace, "post-command") != PCC_STATUS_SUCCESS) {
       val_print(ERROR,
           "\n    PCC: command did not complete within %u us for subspace id : 0x%x",
           PCC_COMMAND_TIMEOUT_USEC, subspace_id);
       return NULL;
   }
 
+  if (subspace->min_req_turnaround_usec != 0U) {
+      /* Platform-mandated minimum, not a timeout, so -timeout_scale does not apply */
+      val_deadline_start_unscaled(&channel->turnaround, subspace->min_req_turnaround_usec);
+      channel->turnaround_armed = 1;
+  }
+
   /* Completion transfers ownership back to OSPM; order response reads after it. */
   val_mem_issue_dsb();
 
-  response_addr = shared_mem_addr + PCC_TY3_COMM_SPACE;
+  response_addr = subspace->base_addr + PCC_TY3_COMM_SPACE;
   val_print(DEBUG, "\n    PCC: command complete response=0x%llx", response_addr);
   return (void *)response_addr;
 }
 
+/**
+  @brief  Submit a command using the ACPI PCC doorbell protocol and wait for
+          its response.
+
+  @param  subspace_id  Subspace ID from the PCCT.
+  @param  command      Protocol message header.
+  @param  data         Payload copied into the shared communication region.
+  @param  data_size    Payload size in bytes.
+
+  @return Pointer to the response payload in shared memory, or NULL on failure.
+**/
+void
+*val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
+{
+  if (val_pcc_cmd_submit(subspace_id, command, data, data_size) != PCC_STATUS_SUCCESS)
+      return NULL;
+
+  return val_pcc_cmd_complete(subspace_id);
+}
+
 /**
   @brief  Free the memory allocated for the PCC information table.
 **/
 void
 val_pcc_free_info_table(void)
 {
+  if (g_pcc_channel != NULL) {
+      val_memory_free((void *)g_pcc_channel);
+      g_pcc_channel = NULL;
+  }
+
   if (g_pcc_info_table != NULL) {
       pal_mem_free_aligned((void *)g_pcc_info_table);
       g_pcc_info_table = NULL;
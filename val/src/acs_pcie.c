@@ -31,11 +31,143 @@
 pcie_bdf_list_t *pcie_pheripherals_bdf_list = NULL;
 PCIE_INFO_TABLE *g_pcie_info_table;
 pcie_device_bdf_table *g_pcie_bdf_table;
+pcie_cap_dir *g_pcie_cap_dir;
 
 uint32_t pcie_bdf_table_list_flag;
 uint32_t g_pcie_integrated_devices;
 uint64_t pal_get_mcfg_ptr(void);
 
+/* Segment/bus to ECAM lookup, built in val_pcie_create_info_table */
+static pcie_ecam_lookup_seg *g_pcie_ecam_lookup;
+static uint32_t g_pcie_ecam_lookup_num_seg;
+static uint32_t g_pcie_ecam_lookup_last;
+
+/**
+  @brief   Build the segment/bus to config space base lookup from the ECAM
+           regions of the PCIe info table. When regions overlap the first
+           one wins, as with a linear search of the table.
+           1. Caller       -  val_pcie_create_info_table
+           2. Prerequisite -  pal_pcie_create_info_table
+
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_ecam_lookup_create(void)
+{
+  uint32_t num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+  uint32_t segment, start_bus, end_bus;
+  uint32_t i, j, bus;
+  addr_t   ecam_base;
+
+  g_pcie_ecam_lookup_num_seg = 0;
+  g_pcie_ecam_lookup_last = 0;
+
+  if (num_ecam == 0)
+      return;
+
+  /* At most one lookup block per ECAM region */
+  g_pcie_ecam_lookup = val_memory_calloc(num_ecam, sizeof(pcie_ecam_lookup_seg));
+  if (g_pcie_ecam_lookup == NULL) {
+      val_print(WARN, "\n       ECAM lookup allocation failed, using linear search");
+      return;
+  }
+
+  for (i = 0; i < num_ecam; i++) {
+      segment   = (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i);
+      start_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i);
+      end_bus   = (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i);
+      ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
+
+      if (ecam_base == 0)
+          continue;
+
+      for (j = 0; j < g_pcie_ecam_lookup_num_seg; j++) {
+          if (g_pcie_ecam_lookup[j].segment == segment)
+              break;
+      }
+
+      if (j == g_pcie_ecam_lookup_num_seg) {
+          g_pcie_ecam_lookup[j].segment = segment;
+          g_pcie_ecam_lookup_num_seg++;
+      }
+
+      if (end_bus >= PCIE_MAX_BUS)
+          end_bus = PCIE_MAX_BUS - 1;
+
+      /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
+      for (bus = start_bus; bus <= end_bus; bus++) {
+          if (g_pcie_ecam_lookup[j].bus_base[bus] == 0)
+              g_pcie_ecam_lookup[j].bus_base[bus] = ecam_base +
+                                           (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096);
+      }
+  }
+}
+
+/**
+  @brief   Free the segment/bus to ECAM lookup
+
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_ecam_lookup_free(void)
+{
+  if (g_pcie_ecam_lookup != NULL) {
+      val_memory_free((void *)g_pcie_ecam_lookup);
+      g_pcie_ecam_lookup = NULL;
+  }
+
+  g_pcie_ecam_lookup_num_seg = 0;
+  g_pcie_ecam_lookup_last = 0;
+}
+
+/**
+  @brief   Return the config space base of device 0 function 0 of a bus.
+           Served from the lookup built at info table creation, falls back to
+           a search of the ECAM regions if the lookup is not available.
+
+  @param   segment - PCIe segment number
+  @param   bus     - Bus number, must be less than PCIE_MAX_BUS
+
+  @return  Config space base of the bus, 0 if no ECAM region maps it
+**/
+static addr_t
+val_pcie_ecam_bus_base(uint32_t segment, uint32_t bus)
+{
+  uint32_t i;
+
+  if (g_pcie_ecam_lookup != NULL) {
+      /* Accesses come in runs on the same segment, check the last hit first */
+      if (g_pcie_ecam_lookup[g_pcie_ecam_lookup_last].segment == segment)
+          return g_pcie_ecam_lookup[g_pcie_ecam_lookup_last].bus_base[bus];
+
+      for (i = 0; i < g_pcie_ecam_lookup_num_seg; i++) {
+          if (g_pcie_ecam_lookup[i].segment == segment) {
+              g_pcie_ecam_lookup_last = i;
+              return g_pcie_ecam_lookup[i].bus_base[bus];
+          }
+      }
+
+      return 0;
+  }
+
+  for (i = 0; i < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0); i++) {
+      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
+           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
+           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
+          if (val_pcie_get_info(PCIE_INFO_ECAM, i) == 0)
+              return 0;
+          return val_pcie_get_info(PCIE_INFO_ECAM, i) +
+                 (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096);
+      }
+  }
+
+  return 0;
+}
+
 /**
   @brief   This API reads 32-bit data from PCIe config space pointed by Bus,
            Device, Function and register offset.
@@ -55,8 +187,7 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
   uint32_t func    = PCIE_EXTRACT_BDF_FUNC(bdf);
   uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
+  addr_t   bus_base;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ERROR, "\n       Invalid Bus/Dev/Func  %x", bdf);
@@ -68,28 +199,15 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
       return PCIE_NO_MAPPING;
   }
 
-  while (i < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
-
-  if (ecam_base == 0) {
+  bus_base = val_pcie_ecam_bus_base(segment, bus);
+  if (bus_base == 0) {
       val_print(ERROR, "\n       PCIe_CFG_RD ECAM Base is zero %08x", bdf);
       return PCIE_NO_MAPPING;
   }
 
-  /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
-  cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
-               (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
+  cfg_addr = (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
-  *data = pal_mmio_read(ecam_base + cfg_addr + offset);
+  *data = pal_mmio_read(bus_base + cfg_addr + offset);
   return 0;
 
 }
@@ -130,8 +248,7 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
   uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
+  addr_t   bus_base;
 
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
@@ -144,28 +261,15 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
       return;
   }
 
-  while (i < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
-
-  if (ecam_base == 0) {
+  bus_base = val_pcie_ecam_bus_base(segment, bus);
+  if (bus_base == 0) {
       val_print(ERROR, "\n       PCIe_CFG_WR ECAM Base is zero %08x", bdf);
       return;
   }
 
-  /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
-  cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
-               (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
+  cfg_addr = (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
-  pal_mmio_write(ecam_base + cfg_addr + offset, data);
+  pal_mmio_write(bus_base + cfg_addr + offset, data);
   val_mem_issue_dsb();
 }
 
@@ -237,9 +341,7 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
   uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  uint32_t num_ecam;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
+  addr_t   bus_base;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ERROR, "\n       Invalid Bus/Dev/Func  %x", bdf);
@@ -251,29 +353,15 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
       return 0;
   }
 
-  num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
-  while (i < num_ecam)
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
-
-  if (ecam_base == 0) {
+  bus_base = val_pcie_ecam_bus_base(segment, bus);
+  if (bus_base == 0) {
       val_print(ERROR, "\n       BDF config Read PCIe_CFG: ECAM Base is zero %x", bdf);
       return 0;
   }
 
-  /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
-  cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
-               (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
+  cfg_addr = (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
- return ecam_base + cfg_addr;
+ return bus_base + cfg_addr;
 
 }
 
@@ -458,6 +546,7 @@ val_pcie_create_info_table(uint64_t *pcie_info_table)
   g_pcie_info_table = (PCIE_INFO_TABLE *)pcie_info_table;
 
   pal_pcie_create_info_table(g_pcie_info_table);
+  val_pcie_ecam_lookup_create();
 
   num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
   val_print(INFO, "\nPCIE_INFO: Number of ECAM regions    :    %ld", num_ecam);
@@ -511,6 +600,59 @@ uint32_t val_pcie_populate_device_rootport(void)
   return 0;
 }
 
+/* Bitmap of bus numbers used by the pruned BDF scan */
+#define PCIE_BUS_MAP_WORDS          ((PCIE_MAX_BUS + 31) / 32)
+#define PCIE_BUS_MAP_SET(map, bus)  ((map)[(bus) / 32] |= (1u << ((bus) % 32)))
+#define PCIE_BUS_MAP_TEST(map, bus) (((bus) < PCIE_MAX_BUS) && \
+                                     ((map)[(bus) / 32] & (1u << ((bus) % 32))))
+
+/**
+  @brief   Mark the buses behind a bridge Function for the pruned BDF scan.
+           The secondary bus is also marked as an ARI bus when the bridge has
+           ARI Forwarding enabled.
+
+  @param   bdf     - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param   end_bus - Last bus of the ECAM region being scanned
+  @param   bus_map - Buses reachable from the ECAM start bus
+  @param   ari_map - Buses on which Functions use ARI numbering
+
+  @return  None
+**/
+static void
+val_pcie_scan_follow_bridge(uint32_t bdf, uint32_t end_bus, uint32_t *bus_map,
+                            uint32_t *ari_map)
+{
+  uint32_t reg_value;
+  uint32_t sec_bus;
+  uint32_t sub_bus;
+  uint32_t cap_base;
+  uint32_t bus;
+
+  if (val_pcie_function_header_type(bdf) != TYPE1_HEADER)
+      return;
+
+  val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+  sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
+  sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
+
+  /* Bridge not configured, or bus numbers not below this bridge */
+  if ((sec_bus <= PCIE_EXTRACT_BDF_BUS(bdf)) || (sub_bus < sec_bus))
+      return;
+
+  for (bus = sec_bus; (bus <= sub_bus) && (bus <= end_bus) && (bus < PCIE_MAX_BUS); bus++)
+      PCIE_BUS_MAP_SET(bus_map, bus);
+
+  if (sec_bus >= PCIE_MAX_BUS)
+      return;
+
+  if (val_pcie_find_capability(bdf, PCIE_CAP, CID_PCIECS, &cap_base) != PCIE_SUCCESS)
+      return;
+
+  val_pcie_read_cfg(bdf, cap_base + DCTL2R_OFFSET, &reg_value);
+  if ((reg_value >> DCTL2R_AFE_SHIFT) & DCTL2R_AFE_MASK)
+      PCIE_BUS_MAP_SET(ari_map, sec_bus);
+}
+
 /**
   @brief   This API creates the device bdf table from enumeration
 
@@ -536,6 +678,12 @@ val_pcie_create_device_bdf_table()
   uint32_t p_cap;
   uint32_t status;
   uint32_t dp_type;
+  uint32_t num_func;
+  uint32_t htr_value;
+  uint32_t ari_bus;
+  uint32_t pruned;
+  uint32_t bus_map[PCIE_BUS_MAP_WORDS];
+  uint32_t ari_map[PCIE_BUS_MAP_WORDS];
 
   /* if table is already present, return success */
   if (g_pcie_bdf_table)
@@ -568,18 +716,33 @@ val_pcie_create_device_bdf_table()
       start_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, ecam_index);
       end_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, ecam_index);
 
+      /* In pruned mode only the start bus and the buses behind bridges found
+         on scanned buses are probed */
+      pruned = acs_policy_get_pcie_pruned_scan();
+      val_memory_set(bus_map, sizeof(bus_map), 0);
+      val_memory_set(ari_map, sizeof(ari_map), 0);
+      if (start_bus < PCIE_MAX_BUS)
+          PCIE_BUS_MAP_SET(bus_map, start_bus);
+
       /* Iterate over all buses, devices and functions in this ecam */
       for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
       {
+          if (pruned && !PCIE_BUS_MAP_TEST(bus_map, bus_index))
+              continue;
+
           if (pal_pcie_check_bus_valid(bus_index)) {
               val_print(DEBUG,
                "\n       Bus 0x%x marked as invalid in Platform API...Skipping", bus_index);
               continue;
           }
 
+          /* With ARI the device number is part of the function number */
+          ari_bus = PCIE_BUS_MAP_TEST(ari_map, bus_index);
+
           for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
           {
-              for (func_index = 0; func_index < PCIE_MAX_FUNC; func_index++)
+              num_func = PCIE_MAX_FUNC;
+              for (func_index = 0; func_index < num_func; func_index++)
               {
                   /* Form bdf using seg, bus, device, function numbers */
                   bdf = PCIE_CREATE_BDF(seg_num, bus_index, dev_index, func_index);
@@ -592,6 +755,22 @@ val_pcie_create_device_bdf_table()
                       return 1;
                   }
 
+                  if (pruned && (reg_value != PCIE_UNKNOWN_RESPONSE))
+                      val_pcie_scan_follow_bridge(bdf, end_bus, bus_map, ari_map);
+
+                  /* Functions 1-7 exist only if Function 0 is present and
+                     reports a multi-function device */
+                  if (pruned && !ari_bus && (func_index == 0)) {
+                      if (reg_value == PCIE_UNKNOWN_RESPONSE)
+                          num_func = 1;
+                      else {
+                          val_pcie_read_cfg(bdf, TYPE01_CLSR, &htr_value);
+                          if (!((htr_value >> (TYPE01_HTR_SHIFT + HTR_MFD_SHIFT)) &
+                                HTR_MFD_MASK))
+                              num_func = 1;
+                      }
+                  }
+
                   /* Store the Function's BDF if there was a valid response */
                   if (reg_value != PCIE_UNKNOWN_RESPONSE)
                   {
@@ -656,6 +835,9 @@ val_pcie_create_device_bdf_table()
   /* Sanity Check : Confirm all EP (normal, integrated) have a rootport */
   val_pcie_populate_device_rootport();
 
+  /* Record the capability offsets of every function in one pass */
+  val_pcie_create_cap_dir();
+
   val_print(INFO,
     "\nPCIE_INFO: Number of BDFs found      :    %d", g_pcie_bdf_table->num_entries);
 
@@ -740,6 +922,9 @@ val_pcie_bdf_table_ptr()
 void
 val_pcie_free_info_table(void)
 {
+    val_pcie_ecam_lookup_free();
+    val_pcie_free_cap_dir();
+
     if (g_pcie_info_table != NULL) {
         pal_mem_free_aligned((void *)g_pcie_info_table);
         g_pcie_info_table = NULL;
@@ -970,9 +1155,13 @@ val_pcie_device_port_type(uint32_t bdf)
   return dp_type;
 }
 
+/* Upper bound on the capability list length, guards against malformed chains */
+#define PCIE_CAP_DIR_MAX_CAPS   48
+#define PCIE_CAP_DIR_MAX_ECAPS  ((0x1000 - PCIE_ECAP_START) / 4)
+
 /**
-  @brief  Find a Function's config capability offset matching it's input parameter
-          cid. cid_offset set to the matching cpability offset w.r.t. zero.
+  @brief  Search a Function's config space for a capability by walking the
+          capability list or the extended capability chain.
 
   @param  bdf        - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
   @param  cid_type   - PCI capability or Extended PCIe capability
@@ -981,8 +1170,8 @@ val_pcie_device_port_type(uint32_t bdf)
   @return PCIE_CAP_NOT_FOUND, if there was a failure in finding required capability.
           PCIE_SUCCESS, if the search was successful.
 **/
-uint32_t
-val_pcie_find_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t *cid_offset)
+static uint32_t
+val_pcie_walk_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t *cid_offset)
 {
 
   uint32_t reg_value;
@@ -1033,6 +1222,249 @@ val_pcie_find_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t
   return PCIE_CAP_NOT_FOUND;
 }
 
+/**
+  @brief  Hash a BDF into the capability directory hash table
+**/
+static uint32_t
+val_pcie_cap_dir_hash(uint32_t bdf, uint32_t hash_size)
+{
+  bdf ^= bdf >> 16;
+  bdf *= 0x45D9F3B;
+  bdf ^= bdf >> 16;
+
+  return bdf & (hash_size - 1);
+}
+
+/**
+  @brief  Return the capability directory entry of a Function
+
+  @param  bdf - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return Directory entry, NULL if the Function is not in the directory
+**/
+static pcie_cap_dir_entry *
+val_pcie_cap_dir_get(uint32_t bdf)
+{
+  uint32_t slot;
+  uint32_t i;
+
+  if (g_pcie_cap_dir == NULL)
+      return NULL;
+
+  slot = val_pcie_cap_dir_hash(bdf, g_pcie_cap_dir->hash_size);
+  for (i = 0; i < g_pcie_cap_dir->hash_size; i++) {
+      if (g_pcie_cap_dir->hash[slot] == 0)
+          return NULL;
+
+      if (g_pcie_cap_dir->entry[g_pcie_cap_dir->hash[slot] - 1].bdf == bdf)
+          return &g_pcie_cap_dir->entry[g_pcie_cap_dir->hash[slot] - 1];
+
+      slot = (slot + 1) & (g_pcie_cap_dir->hash_size - 1);
+  }
+
+  return NULL;
+}
+
+/**
+  @brief  Record every capability and extended capability offset of a Function.
+          The first instance of a capability is recorded, matching the order
+          in which val_pcie_walk_capability finds it.
+
+  @param  entry - Directory entry of the Function, bdf must be set
+  @return None
+**/
+static void
+val_pcie_cap_dir_scan(pcie_cap_dir_entry *entry)
+{
+  uint32_t reg_value;
+  uint32_t next_cap_offset;
+  uint32_t cid;
+  uint32_t count;
+
+  val_memory_set(entry->cap_offset, sizeof(entry->cap_offset), 0);
+  val_memory_set(entry->ecap_offset, sizeof(entry->ecap_offset), 0);
+  entry->ecap_miss = PCIE_CAP_NOT_FOUND;
+  entry->state = PCIE_CAP_DIR_UNCACHED;
+
+  if (val_pcie_read_cfg(entry->bdf, TYPE01_CPR, &reg_value) == PCIE_NO_MAPPING ||
+      reg_value == PCIE_UNKNOWN_RESPONSE)
+      return;
+
+  count = 0;
+  next_cap_offset = (reg_value & TYPE01_CPR_MASK);
+  while (next_cap_offset)
+  {
+      if (++count > PCIE_CAP_DIR_MAX_CAPS)
+          return;
+
+      val_pcie_read_cfg(entry->bdf, next_cap_offset, &reg_value);
+      cid = reg_value & PCIE_CIDR_MASK;
+      if ((cid < PCIE_CAP_DIR_NUM_CID) && (entry->cap_offset[cid] == 0))
+          entry->cap_offset[cid] = next_cap_offset;
+
+      next_cap_offset = ((reg_value >> PCIE_NCPR_SHIFT) & PCIE_NCPR_MASK);
+  }
+
+  count = 0;
+  next_cap_offset = PCIE_ECAP_START;
+  while (next_cap_offset)
+  {
+      if (++count > PCIE_CAP_DIR_MAX_ECAPS)
+          return;
+
+      val_pcie_read_cfg(entry->bdf, next_cap_offset, &reg_value);
+
+      /* The walk stops here, IDs not seen so far report the same failure */
+      if (reg_value == PCIE_UNKNOWN_RESPONSE) {
+          entry->ecap_miss = PCIE_UNKNOWN_RESPONSE;
+          break;
+      }
+
+      cid = reg_value & PCIE_ECAP_CIDR_MASK;
+      if ((cid < PCIE_CAP_DIR_NUM_ECID) && (entry->ecap_offset[cid] == 0))
+          entry->ecap_offset[cid] = next_cap_offset;
+
+      next_cap_offset = ((reg_value >> PCIE_ECAP_NCPR_SHIFT) & PCIE_ECAP_NCPR_MASK);
+  }
+
+  entry->state = PCIE_CAP_DIR_VALID;
+}
+
+/**
+  @brief  Build the capability directory of all Functions in the BDF table.
+          1. Caller       -  val_pcie_create_device_bdf_table
+          2. Prerequisite -  g_pcie_bdf_table populated
+
+  @param  None
+  @return 0 if Success, 1 if the directory could not be allocated
+**/
+uint32_t
+val_pcie_create_cap_dir(void)
+{
+  uint32_t num_entries;
+  uint32_t hash_size;
+  uint32_t slot;
+  uint32_t i;
+
+  if ((g_pcie_bdf_table == NULL) || (g_pcie_cap_dir != NULL))
+      return 0;
+
+  num_entries = g_pcie_bdf_table->num_entries;
+  if (num_entries == 0)
+      return 0;
+
+  hash_size = 1;
+  while (hash_size < (2 * num_entries))
+      hash_size <<= 1;
+
+  g_pcie_cap_dir = val_memory_calloc(1, sizeof(pcie_cap_dir) +
+                                        (num_entries * sizeof(pcie_cap_dir_entry)));
+  if (g_pcie_cap_dir == NULL) {
+      val_print(WARN, "\n       PCIe capability directory allocation failed");
+      return 1;
+  }
+
+  g_pcie_cap_dir->hash = val_memory_calloc(hash_size, sizeof(uint32_t));
+  if (g_pcie_cap_dir->hash == NULL) {
+      val_print(WARN, "\n       PCIe capability directory allocation failed");
+      val_memory_free((void *)g_pcie_cap_dir);
+      g_pcie_cap_dir = NULL;
+      return 1;
+  }
+
+  g_pcie_cap_dir->hash_size = hash_size;
+
+  for (i = 0; i < num_entries; i++) {
+      g_pcie_cap_dir->entry[i].bdf = g_pcie_bdf_table->device[i].bdf;
+      val_pcie_cap_dir_scan(&g_pcie_cap_dir->entry[i]);
+
+      slot = val_pcie_cap_dir_hash(g_pcie_cap_dir->entry[i].bdf, hash_size);
+      while (g_pcie_cap_dir->hash[slot] != 0)
+          slot = (slot + 1) & (hash_size - 1);
+
+      g_pcie_cap_dir->hash[slot] = i + 1;
+      g_pcie_cap_dir->num_entries++;
+  }
+
+  return 0;
+}
+
+/**
+  @brief  Free the capability directory
+
+  @param  None
+  @return None
+**/
+void
+val_pcie_free_cap_dir(void)
+{
+  if (g_pcie_cap_dir == NULL)
+      return;
+
+  if (g_pcie_cap_dir->hash != NULL)
+      val_memory_free((void *)g_pcie_cap_dir->hash);
+
+  val_memory_free((void *)g_pcie_cap_dir);
+  g_pcie_cap_dir = NULL;
+}
+
+/**
+  @brief  Mark the recorded capabilities of a Function as stale, so that they
+          are read again from config space on the next lookup. Tests which
+          reset, hot-plug or reprogram a Function must call this.
+
+  @param  bdf - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return None
+**/
+void
+val_pcie_invalidate_cap_cache(uint32_t bdf)
+{
+  pcie_cap_dir_entry *entry = val_pcie_cap_dir_get(bdf);
+
+  if (entry != NULL)
+      entry->state = PCIE_CAP_DIR_STALE;
+}
+
+/**
+  @brief  Find a Function's config capability offset matching it's input parameter
+          cid. cid_offset set to the matching cpability offset w.r.t. zero.
+          Served from the capability directory when the Function is in it.
+
+  @param  bdf        - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param  cid_type   - PCI capability or Extended PCIe capability
+  @param  cid        - Capability ID
+  @param  cid_offset - On return, points to cid offset in Function config space
+  @return PCIE_CAP_NOT_FOUND, if there was a failure in finding required capability.
+          PCIE_SUCCESS, if the search was successful.
+**/
+uint32_t
+val_pcie_find_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t *cid_offset)
+{
+  pcie_cap_dir_entry *entry = val_pcie_cap_dir_get(bdf);
+
+  if (entry != NULL) {
+      if (entry->state == PCIE_CAP_DIR_STALE)
+          val_pcie_cap_dir_scan(entry);
+
+      if (entry->state == PCIE_CAP_DIR_VALID) {
+          if ((cid_type == PCIE_CAP) && (cid < PCIE_CAP_DIR_NUM_CID)) {
+              if (entry->cap_offset[cid] == 0)
+                  return PCIE_CAP_NOT_FOUND;
+              *cid_offset = entry->cap_offset[cid];
+              return PCIE_SUCCESS;
+          }
+
+          if ((cid_type == PCIE_ECAP) && (cid < PCIE_CAP_DIR_NUM_ECID)) {
+              if (entry->ecap_offset[cid] == 0)
+                  return entry->ecap_miss;
+              *cid_offset = entry->ecap_offset[cid];
+              return PCIE_SUCCESS;
+          }
+      }
+  }
+
+  return val_pcie_walk_capability(bdf, cid_type, cid, cid_offset);
+}
+
 /**
   @brief  Disables bus master by clearing Bus Master Enable bit in the command register.
           When BME bit is clear, it disables the ability of a Function to issue Memory
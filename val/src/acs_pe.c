@@ -25,6 +25,7 @@
 #include "val_sysreg_mpam.h"
 #include "acs_std_smc.h"
 #include "acs_timer.h"
+#include "acs_memory.h"
 
 /**
   @brief   Pointer to the memory location of the PE Information table
@@ -738,3 +739,365 @@ uint32_t val_cache_get_associativity(uint64_t cache_id)
     val_print(ERROR, "\n       Invalid Cache ID: %d", cache_id);
     return 0;
 }
+
+/* Feature a snapshot register depends on. Registers of an unimplemented
+   feature are not accessed and are recorded as zero. */
+#define PE_ID_DEP_NONE   0
+#define PE_ID_DEP_RAS    1
+#define PE_ID_DEP_SPE    2
+#define PE_ID_DEP_LOR    3
+#define PE_ID_DEP_AA32   4
+#define PE_ID_DEP_PMUV3  5
+#define PE_ID_DEP_SVE    6
+#define PE_ID_DEP_SVE2   7
+#define PE_ID_DEP_MPAM   8
+#define PE_ID_DEP_SME    9
+#define PE_ID_DEP_AA64   10
+
+typedef struct {
+  uint32_t reg_id;
+  uint32_t dependency;
+  char     reg_desc[20];
+} PE_ID_SNAPSHOT_REG;
+
+/**
+  @brief   Fixed register list of the PE ID snapshot. The position of a
+           register in this list is its slot in PE_ID_SNAPSHOT_ENTRY.reg,
+           append only and bump PE_ID_SNAPSHOT_VERSION on change.
+**/
+static const PE_ID_SNAPSHOT_REG g_pe_id_snapshot_regs[PE_ID_SNAPSHOT_NUM_REGS] = {
+  {MIDR_EL1,         PE_ID_DEP_NONE,  "MIDR_EL1"},
+  {MPIDR_EL1,        PE_ID_DEP_NONE,  "MPIDR_EL1"},
+  {CTR_EL0,          PE_ID_DEP_NONE,  "CTR_EL0"},
+  {CLIDR_EL1,        PE_ID_DEP_NONE,  "CLIDR_EL1"},
+  {ID_AA64PFR0_EL1,  PE_ID_DEP_NONE,  "ID_AA64PFR0_EL1"},
+  {ID_AA64PFR1_EL1,  PE_ID_DEP_NONE,  "ID_AA64PFR1_EL1"},
+  {ID_AA64DFR0_EL1,  PE_ID_DEP_NONE,  "ID_AA64DFR0_EL1"},
+  {ID_AA64DFR1_EL1,  PE_ID_DEP_NONE,  "ID_AA64DFR1_EL1"},
+  {ID_AA64MMFR0_EL1, PE_ID_DEP_NONE,  "ID_AA64MMFR0_EL1"},
+  {ID_AA64MMFR1_EL1, PE_ID_DEP_NONE,  "ID_AA64MMFR1_EL1"},
+  {ID_AA64MMFR2_EL1, PE_ID_DEP_NONE,  "ID_AA64MMFR2_EL1"},
+  {ID_AA64MMFR3_EL1, PE_ID_DEP_NONE,  "ID_AA64MMFR3_EL1"},
+  {ID_AA64ISAR0_EL1, PE_ID_DEP_NONE,  "ID_AA64ISAR0_EL1"},
+  {ID_AA64ISAR1_EL1, PE_ID_DEP_NONE,  "ID_AA64ISAR1_EL1"},
+  {ID_AA64ISAR2_EL1, PE_ID_DEP_NONE,  "ID_AA64ISAR2_EL1"},
+  {ID_AA64ZFR0_EL1,  PE_ID_DEP_SVE,   "ID_AA64ZFR0_EL1"},
+  {ID_AA64ZFR1_EL1,  PE_ID_DEP_SVE2,  "ID_AA64ZFR1_EL1"},
+  {ID_AA64SMFR0_EL1, PE_ID_DEP_SME,   "ID_AA64SMFR0_EL1"},
+  {ID_AA64PFR2_EL1,  PE_ID_DEP_AA64,  "ID_AA64PFR2_EL1"},
+  {PE_MPAMIDR_EL1,   PE_ID_DEP_MPAM,  "MPAMIDR_EL1"},
+  {CNTFRQ_EL0,       PE_ID_DEP_NONE,  "CNTFRQ_EL0"},
+  {PMCEID0_EL0,      PE_ID_DEP_PMUV3, "PMCEID0_EL0"},
+  {PMCEID1_EL0,      PE_ID_DEP_PMUV3, "PMCEID1_EL0"},
+  {PMCR_EL0,         PE_ID_DEP_PMUV3, "PMCR_EL0"},
+  {PMBIDR_EL1,       PE_ID_DEP_SPE,   "PMBIDR_EL1"},
+  {PMSIDR_EL1,       PE_ID_DEP_SPE,   "PMSIDR_EL1"},
+  {ERRIDR_EL1,       PE_ID_DEP_RAS,   "ERRIDR_EL1"},
+  {LORID_EL1,        PE_ID_DEP_LOR,   "LORID_EL1"},
+  {ID_DFR0_EL1,      PE_ID_DEP_AA32,  "ID_DFR0_EL1"},
+  {ID_ISAR0_EL1,     PE_ID_DEP_AA32,  "ID_ISAR0_EL1"},
+  {ID_ISAR1_EL1,     PE_ID_DEP_AA32,  "ID_ISAR1_EL1"},
+  {ID_ISAR2_EL1,     PE_ID_DEP_AA32,  "ID_ISAR2_EL1"},
+  {ID_ISAR3_EL1,     PE_ID_DEP_AA32,  "ID_ISAR3_EL1"},
+  {ID_ISAR4_EL1,     PE_ID_DEP_AA32,  "ID_ISAR4_EL1"},
+  {ID_ISAR5_EL1,     PE_ID_DEP_AA32,  "ID_ISAR5_EL1"},
+  {ID_MMFR0_EL1,     PE_ID_DEP_AA32,  "ID_MMFR0_EL1"},
+  {ID_MMFR1_EL1,     PE_ID_DEP_AA32,  "ID_MMFR1_EL1"},
+  {ID_MMFR2_EL1,     PE_ID_DEP_AA32,  "ID_MMFR2_EL1"},
+  {ID_MMFR3_EL1,     PE_ID_DEP_AA32,  "ID_MMFR3_EL1"},
+  {ID_MMFR4_EL1,     PE_ID_DEP_AA32,  "ID_MMFR4_EL1"},
+  {ID_PFR0_EL1,      PE_ID_DEP_AA32,  "ID_PFR0_EL1"},
+  {ID_PFR1_EL1,      PE_ID_DEP_AA32,  "ID_PFR1_EL1"},
+  {MVFR0_EL1,        PE_ID_DEP_AA32,  "MVFR0_EL1"},
+  {MVFR1_EL1,        PE_ID_DEP_AA32,  "MVFR1_EL1"},
+  {MVFR2_EL1,        PE_ID_DEP_AA32,  "MVFR2_EL1"}
+};
+
+/**
+  @brief   Pointer to the PE ID register snapshot, NULL until captured
+**/
+PE_ID_SNAPSHOT_TABLE *g_pe_id_snapshot;
+
+/* Register id to (slot + 1) of g_pe_id_snapshot_regs, 0 if not captured */
+static uint8_t g_pe_id_snapshot_slot[ZCR_EL1 + 1];
+
+/**
+  @brief   Check whether the feature a snapshot register depends on is
+           implemented on the current PE.
+  @param   dependency - PE_ID_DEP_* value of the register.
+  @return  1 if the register can be accessed, else 0.
+**/
+static uint32_t
+val_pe_id_snapshot_dep_met(uint32_t dependency)
+{
+  uint64_t pfr0 = val_pe_reg_read(ID_AA64PFR0_EL1);
+  uint64_t data;
+
+  switch (dependency) {
+  case PE_ID_DEP_NONE:
+      return 1;
+  case PE_ID_DEP_RAS:
+      return (VAL_EXTRACT_BITS(pfr0, 28, 31) == 1);
+  case PE_ID_DEP_SPE:
+      return (VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64DFR0_EL1), 32, 35) == 1);
+  case PE_ID_DEP_LOR:
+      return (VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64MMFR1_EL1), 16, 19) == 1);
+  case PE_ID_DEP_AA32:
+      /* AArch32 ID registers are UNKNOWN in a pure AArch64 implementation */
+      return ((pfr0 & 0x1) == 0);
+  case PE_ID_DEP_PMUV3:
+      data = VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64DFR0_EL1), 8, 11);
+      return (data != 0 && data != 0xF);
+  case PE_ID_DEP_SVE:
+      return (VAL_EXTRACT_BITS(pfr0, 32, 35) != 0);
+  case PE_ID_DEP_SVE2:
+      if (VAL_EXTRACT_BITS(pfr0, 32, 35) == 0)
+          return 0;
+      return (VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64ZFR0_EL1), 0, 3) != 0);
+  case PE_ID_DEP_MPAM:
+      return (VAL_EXTRACT_BITS(pfr0, 40, 43) > 0) ||
+             (VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64PFR1_EL1), 16, 19) > 0);
+  case PE_ID_DEP_SME:
+      return (VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64PFR1_EL1), 24, 27) != 0);
+  case PE_ID_DEP_AA64:
+      return (VAL_EXTRACT_BITS(pfr0, 4, 7) != EL_IMPL_NONE);
+  default:
+      return 0;
+  }
+}
+
+/**
+  @brief   Payload run on every PE to fill its entry of the PE ID snapshot.
+           1. Caller       -  val_pe_id_snapshot_create through val_run_test_payload.
+           2. Prerequisite -  g_pe_id_snapshot allocated.
+  @param   None
+  @return  None
+**/
+static void
+val_pe_id_snapshot_capture(void)
+{
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+  PE_ID_SNAPSHOT_ENTRY *entry;
+  uint64_t clidr;
+  uint32_t i;
+
+  if ((g_pe_id_snapshot == NULL) || (index >= g_pe_id_snapshot->num_of_pe)) {
+      val_set_status(index, RESULT_SKIP(1));
+      return;
+  }
+
+  entry = &g_pe_id_snapshot->entry[index];
+
+  for (i = 0; i < PE_ID_SNAPSHOT_NUM_REGS; i++) {
+      /* Honour -el1skiptrap for registers which trap on some platforms */
+      if ((g_pe_id_snapshot_regs[i].reg_id == PMSIDR_EL1) &&
+          (acs_policy_get_el1skiptrap_mask() & EL1SKIPTRAP_PMSIDR))
+          continue;
+
+      if (val_pe_id_snapshot_dep_met(g_pe_id_snapshot_regs[i].dependency))
+          entry->reg[i] = val_pe_reg_read(g_pe_id_snapshot_regs[i].reg_id);
+  }
+
+  /* CCSIDR of every implemented data or unified cache level */
+  clidr = val_pe_reg_read(CLIDR_EL1);
+  for (i = 0; i < PE_ID_SNAPSHOT_MAX_CACHE_LVL; i++) {
+      if (clidr & (0x7ull << (i * 3))) {
+          val_pe_reg_write(CSSELR_EL1, i << 1);
+          entry->ccsidr[i] = val_pe_reg_read(CCSIDR_EL1);
+      }
+  }
+
+  entry->valid = 1;
+  val_pe_cache_clean_range((uint64_t)entry, sizeof(PE_ID_SNAPSHOT_ENTRY));
+
+  val_set_status(index, RESULT_PASS);
+}
+
+/**
+  @brief   Capture the ID and feature registers of every PE once, so that tests
+           can compare them without waking the secondary PEs again.
+           1. Caller       -  Application layer.
+           2. Prerequisite -  val_pe_create_info_table, val_allocate_shared_mem.
+  @param   None
+  @return  ACS_STATUS_PASS if the snapshot holds the primary PE, else ACS_STATUS_ERR.
+**/
+uint32_t
+val_pe_id_snapshot_create(void)
+{
+  uint32_t num_pe = val_pe_get_num();
+  uint32_t size;
+  uint32_t i, captured = 0;
+
+  if (g_pe_id_snapshot != NULL)
+      return ACS_STATUS_PASS;
+
+  size = sizeof(PE_ID_SNAPSHOT_TABLE) + (num_pe * sizeof(PE_ID_SNAPSHOT_ENTRY));
+  g_pe_id_snapshot = (PE_ID_SNAPSHOT_TABLE *)val_memory_calloc(1, size);
+  if (g_pe_id_snapshot == NULL) {
+      val_print(ERROR, "\n       Allocation for PE ID snapshot failed");
+      return ACS_STATUS_ERR;
+  }
+
+  g_pe_id_snapshot->version     = PE_ID_SNAPSHOT_VERSION;
+  g_pe_id_snapshot->num_of_pe   = num_pe;
+  g_pe_id_snapshot->num_of_regs = PE_ID_SNAPSHOT_NUM_REGS;
+  g_pe_id_snapshot->entry_size  = sizeof(PE_ID_SNAPSHOT_ENTRY);
+
+  for (i = 0; i < PE_ID_SNAPSHOT_NUM_REGS; i++)
+      g_pe_id_snapshot_slot[g_pe_id_snapshot_regs[i].reg_id] = i + 1;
+
+  val_pe_cache_clean_invalidate_range((uint64_t)g_pe_id_snapshot, size);
+  val_data_cache_ops_by_va((addr_t)&g_pe_id_snapshot, CLEAN_AND_INVALIDATE);
+
+  for (i = 0; i < num_pe; i++)
+      val_set_status(i, RESULT_PENDING(0));
+
+  val_run_test_payload(0, num_pe, val_pe_id_snapshot_capture, 0);
+
+  val_pe_cache_invalidate_range((uint64_t)g_pe_id_snapshot, size);
+  for (i = 0; i < num_pe; i++) {
+      if (g_pe_id_snapshot->entry[i].valid)
+          captured++;
+      else
+          val_print(WARN, "\n       PE ID snapshot not captured for PE index %d", i);
+  }
+
+  val_print(INFO, "\nPE_INFO: ID snapshot captured on PEs : %4d", captured);
+  val_pe_id_snapshot_dump();
+
+  if (!val_pe_id_snapshot_valid(val_pe_get_primary_index()))
+      return ACS_STATUS_ERR;
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Free the memory allocated for the PE ID snapshot.
+  @param   None
+  @return  None
+**/
+void
+val_pe_id_snapshot_free(void)
+{
+  if (g_pe_id_snapshot != NULL) {
+      val_memory_free((void *)g_pe_id_snapshot);
+      g_pe_id_snapshot = NULL;
+  }
+}
+
+/**
+  @brief   Check whether the PE ID snapshot holds the registers of a PE.
+  @param   index - PE index.
+  @return  1 if the entry is valid, else 0.
+**/
+uint32_t
+val_pe_id_snapshot_valid(uint32_t index)
+{
+  if ((g_pe_id_snapshot == NULL) || (index >= g_pe_id_snapshot->num_of_pe))
+      return 0;
+
+  return g_pe_id_snapshot->entry[index].valid;
+}
+
+/**
+  @brief   Return a register of a PE from the PE ID snapshot.
+           1. Caller       -  Test Suite.
+           2. Prerequisite -  val_pe_id_snapshot_create.
+  @param   index  - PE index.
+  @param   reg_id - register from BSA_ACS_PE_REGS.
+  @param   value  - returns the captured value.
+  @return  ACS_STATUS_PASS if found, ACS_STATUS_SKIP if the register is not part
+           of the snapshot, else ACS_STATUS_ERR.
+**/
+uint32_t
+val_pe_id_snapshot_read(uint32_t index, uint32_t reg_id, uint64_t *value)
+{
+  uint32_t slot;
+
+  if ((value == NULL) || !val_pe_id_snapshot_valid(index))
+      return ACS_STATUS_ERR;
+
+  if ((reg_id > ZCR_EL1) || (g_pe_id_snapshot_slot[reg_id] == 0))
+      return ACS_STATUS_SKIP;
+
+  slot = g_pe_id_snapshot_slot[reg_id] - 1;
+  *value = g_pe_id_snapshot->entry[index].reg[slot];
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Return the CCSIDR_EL1 of a cache level of a PE from the PE ID snapshot.
+  @param   index - PE index.
+  @param   level - zero based cache level as selected through CSSELR_EL1.Level.
+  @param   value - returns the captured value, 0 if the level is not implemented.
+  @return  ACS_STATUS_PASS if found, else ACS_STATUS_ERR.
+**/
+uint32_t
+val_pe_id_snapshot_read_ccsidr(uint32_t index, uint32_t level, uint64_t *value)
+{
+  if ((value == NULL) || (level >= PE_ID_SNAPSHOT_MAX_CACHE_LVL) ||
+      !val_pe_id_snapshot_valid(index))
+      return ACS_STATUS_ERR;
+
+  *value = g_pe_id_snapshot->entry[index].ccsidr[level];
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Read an ID register of the current PE, served from the PE ID
+           snapshot when it holds the register, else read from the PE.
+  @param   reg_id - register from BSA_ACS_PE_REGS.
+  @return  the register value.
+**/
+uint64_t
+val_pe_id_reg_read(uint32_t reg_id)
+{
+  uint64_t value;
+
+  if (val_pe_id_snapshot_read(val_pe_get_index_mpid(val_pe_get_mpid()), reg_id, &value)
+      == ACS_STATUS_PASS)
+      return value;
+
+  return val_pe_reg_read(reg_id);
+}
+
+/**
+  @brief   Print the PE ID snapshot, one line per register per PE, so that
+           captures of different systems can be compared.
+  @param   None
+  @return  None
+**/
+void
+val_pe_id_snapshot_dump(void)
+{
+  PE_ID_SNAPSHOT_ENTRY *entry;
+  uint32_t i, j;
+
+  if (g_pe_id_snapshot == NULL) {
+      val_print(TRACE, "\n       PE ID snapshot not captured");
+      return;
+  }
+
+  val_print(TRACE, "\n PE ID snapshot version %d", g_pe_id_snapshot->version);
+  val_print(TRACE, ", %d registers", g_pe_id_snapshot->num_of_regs);
+
+  for (i = 0; i < g_pe_id_snapshot->num_of_pe; i++) {
+      entry = &g_pe_id_snapshot->entry[i];
+      if (!entry->valid)
+          continue;
+
+      val_print(TRACE, "\n   PE index %d", i);
+      for (j = 0; j < PE_ID_SNAPSHOT_NUM_REGS; j++) {
+          val_print(TRACE, "\n     %a", (uint64_t)g_pe_id_snapshot_regs[j].reg_desc);
+          val_print(TRACE, "\t: 0x%016llx", entry->reg[j]);
+      }
+      for (j = 0; j < PE_ID_SNAPSHOT_MAX_CACHE_LVL; j++) {
+          if (entry->ccsidr[j] == 0)
+              continue;
+          val_print(TRACE, "\n     CCSIDR_EL1 L%d", j + 1);
+          val_print(TRACE, "\t: 0x%016llx", entry->ccsidr[j]);
+      }
+  }
+}
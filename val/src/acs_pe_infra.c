@@ -20,6 +20,7 @@
 #include "acs_common.h"
 #include "acs_std_smc.h"
 #include "acs_exception.h"
+#include "acs_memory.h"
 #include "val_interface.h"
 #include "pal_interface.h"
 
@@ -41,6 +42,11 @@ ARM_SMC_ARGS g_smc_args;
 /* global variable to store primary PE index */
 uint32_t g_primary_pe_index = ACS_INVALID_INDEX;
 
+#ifndef TARGET_LINUX
+/* Key of the last fan-out launch, only updated by the primary PE */
+static uint32_t g_pe_fanout_seq;
+#endif
+
 /**
   @brief   This API will call PAL layer to fill in the PE information
            into the g_pe_info_table pointer.
@@ -117,6 +123,9 @@ val_print(INFO, "\nPrimary PE: MIDR_EL1                 :    0x%llx",
 void
 val_pe_free_info_table(void)
 {
+#ifndef TARGET_LINUX
+    val_pe_id_snapshot_free();
+#endif
     if (g_pe_info_table != NULL) {
         pal_mem_free_aligned((void *)g_pe_info_table);
         g_pe_info_table = NULL;
@@ -223,9 +232,520 @@ val_pe_get_index_mpid(uint64_t mpid)
 }
 
 
+/**
+  @brief   Issue PSCI CPU_ON for the PE indicated by index, retrying while the
+           PE still reports ALREADY_ON. Does not print, so it is safe to call
+           from secondary PEs.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index      - Index of the PE to be woken up
+  @param   payload    - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @param   smc_args   - SMC argument block owned by the caller
+  @return  None, PSCI return code is left in smc_args->Arg0
+**/
+static void
+val_pe_cpu_on(uint32_t index, void (*payload)(void), uint64_t test_input,
+              ARM_SMC_ARGS *smc_args)
+{
+  int timeout = TIMEOUT_LARGE;
+
+  do {
+      smc_args->Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
+
+      /* Set the TEST function pointer in a shared memory location. This location is
+         read by the Secondary PE (val_test_entry()) and executes the test. */
+      smc_args->Arg1 = val_pe_get_mpid_index(index);
+
+      val_set_test_data(index, (uint64_t)payload, test_input);
+      pal_pe_execute_payload(smc_args);
+
+  } while (smc_args->Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON && timeout--);
+}
+
+#ifndef TARGET_LINUX
+/**
+  @brief   Return the PE pool mailbox of the PE indicated by index
+  @param   index - PE index
+  @return  Pointer to the mailbox in shared memory
+**/
+static volatile VAL_PE_MAILBOX_t *
+val_pe_pool_get_mailbox(uint32_t index)
+{
+  return (volatile VAL_PE_MAILBOX_t *)val_get_pe_mailbox_region_base() + index;
+}
+
+/**
+  @brief   val_poll_until condition: the PE pool mailbox reports PE_POOL_STATE_OFF
+**/
+static uint32_t
+val_pe_pool_off_cond(void *arg)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = (volatile VAL_PE_MAILBOX_t *)arg;
+
+  val_data_cache_ops_by_va((addr_t)mbox, INVALIDATE);
+  return (mbox->state == PE_POOL_STATE_OFF);
+}
+
+/**
+  @brief   val_poll_until condition: the PE pool mailbox no longer reports a PE
+           that is running a payload or still on its way to the pool
+**/
+static uint32_t
+val_pe_pool_idle_cond(void *arg)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = (volatile VAL_PE_MAILBOX_t *)arg;
+
+  val_data_cache_ops_by_va((addr_t)mbox, INVALIDATE);
+  return ((mbox->state != PE_POOL_STATE_BUSY) && (mbox->state != PE_POOL_STATE_WAKING));
+}
+
+/**
+  @brief   Update the PE pool state of the PE indicated by index
+  @param   index - PE index
+  @param   state - PE_POOL_STATE_*
+  @return  None
+**/
+static void
+val_pe_pool_set_state(uint32_t index, uint32_t state)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+
+  mbox->state = state;
+  val_data_cache_ops_by_va((addr_t)mbox, CLEAN_AND_INVALIDATE);
+}
+
+/**
+  @brief   Record in the mailbox of the PE indicated by index the fan-out launch
+           it is about to be woken for. Must be called before the wake-up.
+  @param   index      - PE index
+  @param   fanout_seq - Fan-out launch key, 0 when not woken by a fan-out launch
+  @return  None
+**/
+static void
+val_pe_set_fanout_seq(uint32_t index, uint32_t fanout_seq)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+
+  mbox->fanout_seq = fanout_seq;
+  val_data_cache_ops_by_va((addr_t)mbox, CLEAN_AND_INVALIDATE);
+}
+
+/**
+  @brief   Wait until the PE indicated by index is back in the pool. A PE posts
+           its test status before it returns to the park loop, so right after
+           a payload completes its mailbox may still read BUSY or WAKING.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem, policy pe_pool set
+  @param   index - Index of the PE
+  @return  PE_POOL_STATE_* seen last, BUSY or WAKING only on timeout
+**/
+static uint32_t
+val_pe_pool_wait_parked(uint32_t index)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+
+  if (!val_pe_pool_idle_cond((void *)mbox))
+      (void)val_poll_until(val_pe_pool_idle_cond, (void *)mbox, PE_POOL_PARK_TIMEOUT_US,
+                           DEADLINE_BACKOFF_NONE);
+
+  return mbox->state;
+}
+
+/**
+  @brief   Post a request to a parked secondary PE and signal it with SEV.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   index - Index of the PE
+  @param   cmd   - PE_POOL_CMD_* request
+  @return  None
+**/
+static void
+val_pe_pool_post(uint32_t index, uint32_t cmd)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+
+  mbox->cmd = cmd;
+  mbox->state = PE_POOL_STATE_BUSY;
+  mbox->seq = mbox->seq + 1;
+  val_data_cache_ops_by_va((addr_t)mbox, CLEAN_AND_INVALIDATE);
+
+  dsbsy();
+  sev();
+}
+
+/**
+  @brief   Hand a payload to a PE parked in the PE pool. Does not print.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem, policy pe_pool set
+  @param   index      - Index of the PE
+  @param   payload    - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @param   fanout_seq - Fan-out launch key, 0 when not part of a fan-out launch
+  @return  PE_POOL_STATE_* seen before dispatch, payload was posted only if
+           PE_POOL_STATE_PARKED is returned
+**/
+static uint32_t
+val_pe_pool_dispatch(uint32_t index, void (*payload)(void), uint64_t test_input,
+                     uint32_t fanout_seq)
+{
+  uint32_t state;
+
+  state = val_pe_pool_wait_parked(index);
+
+  if (state == PE_POOL_STATE_PARKED) {
+      val_set_test_data(index, (uint64_t)payload, test_input);
+      val_pe_set_fanout_seq(index, fanout_seq);
+      val_pe_pool_post(index, PE_POOL_CMD_RUN);
+  }
+
+  return state;
+}
+
+#endif
+
+/**
+  @brief   Wake a PE for a payload, from the PE pool when the PE is parked there
+           or through PSCI CPU_ON otherwise. A PE still busy in the pool is
+           given PE_POOL_PARK_TIMEOUT_US to park before CPU_ON is tried.
+           Does not print, so it is safe to call from secondary PEs.
+  @param   index      - Index of the PE to be woken up
+  @param   payload    - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @param   fanout_seq - Fan-out launch key, 0 when not part of a fan-out launch
+  @param   smc_args   - SMC argument block owned by the caller
+  @return  PE_POOL_STATE_* seen before the wake-up, PE_POOL_STATE_OFF when the
+           pool is not in use. PSCI return code is left in smc_args->Arg0, 0
+           if the payload was dispatched from the pool.
+**/
+static uint32_t
+val_pe_wake(uint32_t index, void (*payload)(void), uint64_t test_input,
+            uint32_t fanout_seq, ARM_SMC_ARGS *smc_args)
+{
+  uint32_t state = PE_POOL_STATE_OFF;
+
+#ifndef TARGET_LINUX
+  if (acs_policy_get_pe_pool()) {
+      state = val_pe_pool_dispatch(index, payload, test_input, fanout_seq);
+      if (state == PE_POOL_STATE_PARKED) {
+          smc_args->Arg0 = 0;
+          return state;
+      }
+
+      /* Keep the PE owned by the pool until it parks after this payload */
+      if (state == PE_POOL_STATE_OFF)
+          val_pe_pool_set_state(index, PE_POOL_STATE_WAKING);
+  }
+
+  val_pe_set_fanout_seq(index, fanout_seq);
+#else
+  (void)fanout_seq;
+#endif
+
+  val_pe_cpu_on(index, payload, test_input, smc_args);
+
+#ifndef TARGET_LINUX
+  if (acs_policy_get_pe_pool() && (state == PE_POOL_STATE_OFF) && (smc_args->Arg0 != 0))
+      val_pe_pool_set_state(index, PE_POOL_STATE_OFF);
+#endif
+
+  return state;
+}
+
+#ifndef TARGET_LINUX
+/**
+  @brief   Return the fan-out descriptor slot used by the launch with key seq.
+           Successive launches use different slots, so a PE still reading the
+           previous launch cannot see it overwritten by the next one.
+**/
+static volatile VAL_PE_FANOUT_t *
+val_pe_fanout_get_desc(uint32_t seq)
+{
+  return (volatile VAL_PE_FANOUT_t *)val_get_pe_fanout_region_base() +
+         (seq % PE_FANOUT_SLOTS);
+}
+
+/**
+  @brief   Copy the fan-out launch the calling PE was woken for, if any.
+  @param   index  - Index of the calling PE
+  @param   fanout - Filled with the launch descriptor
+  @return  ACS_STATUS_PASS if the PE must wake its children, else ACS_STATUS_SKIP
+**/
+static uint32_t
+val_pe_fanout_get(uint32_t index, VAL_PE_FANOUT_t *fanout)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+  volatile VAL_PE_FANOUT_t *desc;
+  uint32_t seq;
+
+  val_data_cache_ops_by_va((addr_t)mbox, INVALIDATE);
+  seq = mbox->fanout_seq;
+  if (seq == 0)
+      return ACS_STATUS_SKIP;
+
+  desc = val_pe_fanout_get_desc(seq);
+  val_pe_cache_invalidate_range((uint64_t)desc, sizeof(VAL_PE_FANOUT_t));
+  *fanout = *desc;
+
+  /* The slot belongs to a later launch, or this launch already completed */
+  if ((fanout->seq != seq) || !fanout->active || (index >= fanout->num_pe))
+      return ACS_STATUS_SKIP;
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Map a position in the fan-out tree to a PE index. Position 0 is the
+           root (primary) PE, positions 1..num_pe-1 are the remaining PEs in
+           index order.
+**/
+static uint32_t
+val_pe_fanout_pos_to_index(uint32_t pos, uint32_t root)
+{
+  return (pos <= root) ? (pos - 1) : pos;
+}
+
+/**
+  @brief   Map a PE index to its position in the fan-out tree
+**/
+static uint32_t
+val_pe_fanout_index_to_pos(uint32_t index, uint32_t root)
+{
+  if (index == root)
+      return 0;
+
+  return (index < root) ? (index + 1) : index;
+}
+
+/**
+  @brief   Wake a single PE on behalf of the fan-out tree, either from the PE
+           pool or through PSCI CPU_ON. Records SKIP/FAIL status for the PE on
+           failure in the same way as val_execute_on_pe. Does not print.
+  @param   index  - Index of the PE to be woken up
+  @param   fanout - Fan-out launch the PE is woken for
+  @return  ACS_STATUS_PASS if the PE is running the payload, else ACS_STATUS_ERR
+**/
+static uint32_t
+val_pe_fanout_wake(uint32_t index, const VAL_PE_FANOUT_t *fanout)
+{
+  ARM_SMC_ARGS smc_args;
+  uint32_t state;
+
+  state = val_pe_wake(index, (void (*)(void))fanout->payload, fanout->arg, fanout->seq,
+                      &smc_args);
+  if (smc_args.Arg0 == 0)
+      return ACS_STATUS_PASS;
+
+  /* ALREADY_ON is only a skip for a PE the pool does not own */
+  if ((state == PE_POOL_STATE_OFF) &&
+      (smc_args.Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON))
+      val_set_status(index, RESULT_SKIP(0x120 - (int)smc_args.Arg0));
+  else
+      val_set_status(index, RESULT_FAIL(0x120 - (int)smc_args.Arg0));
+
+  return ACS_STATUS_ERR;
+}
+
+/**
+  @brief   Wake the children of the fan-out tree node at position pos. If a
+           child cannot be woken, its own subtree is woken from here so that
+           no PE is left behind.
+           1. Caller       -  Primary PE and every woken secondary PE
+           2. Prerequisite -  val_pe_fanout_execute
+  @param   pos    - Position of the calling PE in the fan-out tree
+  @param   fanout - Copy of the fan-out descriptor
+  @return  None
+**/
+static void
+val_pe_fanout_wake_children(uint32_t pos, const VAL_PE_FANOUT_t *fanout)
+{
+  uint32_t child;
+  uint32_t first = (pos * fanout->degree) + 1;
+
+  for (child = first; (child < first + fanout->degree) && (child < fanout->num_pe); child++) {
+      if (val_pe_fanout_wake(val_pe_fanout_pos_to_index(child, fanout->root), fanout)
+          != ACS_STATUS_PASS)
+          val_pe_fanout_wake_children(child, fanout);
+  }
+}
+#endif
+
+/**
+  @brief   Run the payload posted for the calling secondary PE. When a fan-out
+           launch is in progress the PE first wakes its own children.
+           1. Caller       -  val_test_entry, PE pool
+           2. Prerequisite -  val_set_test_data
+  @param   index - Index of the calling PE
+  @return  None
+**/
+static void
+val_pe_run_payload(uint32_t index)
+{
+  uint64_t test_arg;
+  void (*vector)(uint64_t args);
+#ifndef TARGET_LINUX
+  VAL_PE_FANOUT_t fanout;
+
+  if (val_pe_fanout_get(index, &fanout) == ACS_STATUS_PASS)
+      val_pe_fanout_wake_children(val_pe_fanout_index_to_pos(index, fanout.root), &fanout);
+#endif
+
+  val_get_test_data(index, (uint64_t *)&vector, &test_arg);
+  vector(test_arg);
+}
+
+#ifndef TARGET_LINUX
+/**
+  @brief   Park the calling secondary PE in a WFE loop on its mailbox and run
+           the payloads posted by the primary PE, until asked to exit.
+           1. Caller       -  val_test_entry
+           2. Prerequisite -  val_allocate_shared_mem, policy pe_pool set
+  @param   index - Index of the calling PE
+  @return  None, returns once PE_POOL_CMD_EXIT is received
+**/
+static void
+val_pe_pool_park(uint32_t index)
+{
+  volatile VAL_PE_MAILBOX_t *mbox = val_pe_pool_get_mailbox(index);
+  uint32_t seq;
+
+  val_data_cache_ops_by_va((addr_t)mbox, INVALIDATE);
+  seq = mbox->seq;
+
+  while (1) {
+      mbox->state = PE_POOL_STATE_PARKED;
+      val_data_cache_ops_by_va((addr_t)mbox, CLEAN_AND_INVALIDATE);
+
+      /* SEV from the primary after the check below is latched in the event
+         register, so the following WFE cannot miss a request */
+      while (1) {
+          val_data_cache_ops_by_va((addr_t)mbox, INVALIDATE);
+          if (mbox->seq != seq)
+              break;
+          wfe();
+      }
+
+      seq = mbox->seq;
+      if (mbox->cmd != PE_POOL_CMD_RUN)
+          break;
+
+      val_pe_run_payload(index);
+  }
+
+  mbox->state = PE_POOL_STATE_OFF;
+  val_data_cache_ops_by_va((addr_t)mbox, CLEAN_AND_INVALIDATE);
+}
+#endif
+
+/**
+  @brief   Power off all secondary PEs parked in the PE pool. Mailboxes live in
+           the shared region, so this must run before it is freed.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   None
+  @return  None
+**/
+void
+val_pe_pool_release(void)
+{
+#ifndef TARGET_LINUX
+  volatile VAL_PE_MAILBOX_t *mbox;
+  uint32_t i;
+
+  if (!acs_policy_get_pe_pool() || (pal_mem_get_shared_addr() == 0))
+      return;
+
+  for (i = 0; i < val_pe_get_num(); i++) {
+      if (val_pe_pool_wait_parked(i) == PE_POOL_STATE_PARKED)
+          val_pe_pool_post(i, PE_POOL_CMD_EXIT);
+  }
+
+  for (i = 0; i < val_pe_get_num(); i++) {
+      mbox = val_pe_pool_get_mailbox(i);
+      if (val_poll_until(val_pe_pool_off_cond, (void *)mbox, PE_POOL_EXIT_TIMEOUT_US,
+                         DEADLINE_BACKOFF_NONE))
+          val_print(WARN, "\n       PE pool: PE index %d did not power off", i);
+  }
+#endif
+}
+
+/**
+  @brief   Launch a payload on PEs [0, num_pe) other than the primary using a
+           tree of wake-ups. The primary wakes PE_FANOUT_DEGREE PEs, and each
+           woken PE wakes its own children before running the payload, so the
+           number of sequential PSCI calls grows with log(num_pe). Only used
+           when the pe_fanout policy is set.
+           1. Caller       -  val_run_test_payload
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   num_pe     - Number of PEs to run the payload on
+  @param   payload    - Function pointer of the test to be executed on the PEs
+  @param   test_input - arguments to be passed to the test.
+  @return  ACS_STATUS_PASS if the launch was done through the tree,
+           ACS_STATUS_SKIP if the caller must wake the PEs itself
+**/
+uint32_t
+val_pe_fanout_execute(uint32_t num_pe, void (*payload)(void), uint64_t test_input)
+{
+#ifndef TARGET_LINUX
+  VAL_PE_FANOUT_t launch;
+  volatile VAL_PE_FANOUT_t *fanout;
+  uint32_t root = val_pe_get_primary_index();
+
+  if (!acs_policy_get_pe_fanout() || (num_pe < PE_FANOUT_MIN_PE) || (root >= num_pe))
+      return ACS_STATUS_SKIP;
+
+  /* Key 0 marks a PE that was not woken by a fan-out launch */
+  g_pe_fanout_seq++;
+  if (g_pe_fanout_seq == 0)
+      g_pe_fanout_seq = 1;
+
+  launch.payload = (uint64_t)payload;
+  launch.arg = test_input;
+  launch.root = root;
+  launch.num_pe = num_pe;
+  launch.degree = PE_FANOUT_DEGREE;
+  launch.active = 1;
+  launch.seq = g_pe_fanout_seq;
+  launch.reserved = 0;
+
+  fanout = val_pe_fanout_get_desc(launch.seq);
+  *fanout = launch;
+  val_pe_cache_clean_invalidate_range((uint64_t)fanout, sizeof(VAL_PE_FANOUT_t));
+
+  val_print(TRACE, "\n       Fan-out launch on %d PEs", num_pe);
+  val_pe_fanout_wake_children(0, &launch);
+  return ACS_STATUS_PASS;
+#else
+  (void)num_pe;
+  (void)payload;
+  (void)test_input;
+  return ACS_STATUS_SKIP;
+#endif
+}
+
+/**
+  @brief   Mark the fan-out launch as finished, so that PEs woken later by
+           val_execute_on_pe do not forward the wake-up.
+           1. Caller       -  val_run_test_payload
+           2. Prerequisite -  val_pe_fanout_execute
+  @param   None
+  @return  None
+**/
+void
+val_pe_fanout_complete(void)
+{
+#ifndef TARGET_LINUX
+  volatile VAL_PE_FANOUT_t *fanout = val_pe_fanout_get_desc(g_pe_fanout_seq);
+
+  fanout->active = 0;
+  val_pe_cache_clean_invalidate_range((uint64_t)fanout, sizeof(VAL_PE_FANOUT_t));
+#endif
+}
+
 /**
   @brief   'C' Entry point for Secondary PE.
-           Uses PSCI_CPU_OFF to switch off PE after payload execution.
+           Uses PSCI_CPU_OFF to switch off PE after payload execution, or parks
+           the PE on its mailbox when the PE pool is enabled.
            1. Caller       -  PAL code
            2. Prerequisite -  Stack pointer for this PE is setup by PAL
                               MMU/caches enabled by ModuleEntryPoint
@@ -236,12 +756,17 @@ val_pe_get_index_mpid(uint64_t mpid)
 void
 val_test_entry(void)
 {
-  uint64_t test_arg;
+  uint32_t index;
   ARM_SMC_ARGS smc_args;
-  void (*vector)(uint64_t args);
 
-  val_get_test_data(val_pe_get_index_mpid(val_pe_get_mpid()), (uint64_t *)&vector, &test_arg);
-  vector(test_arg);
+  index = val_pe_get_index_mpid(val_pe_get_mpid());
+  val_pe_run_payload(index);
+
+#ifndef TARGET_LINUX
+  /* Stay powered and wait for further payloads until the pool is released */
+  if (acs_policy_get_pe_pool())
+      val_pe_pool_park(index);
+#endif
 
   // We have completed our TEST code. So, switch off the PE now
   smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_OFF;
@@ -263,25 +788,29 @@ val_test_entry(void)
 void
 val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
 {
+  uint32_t state;
 
-  int timeout = TIMEOUT_LARGE;
   if (index > g_pe_info_table->header.num_of_pe) {
       val_print(ERROR, "\n       Input Index exceeds Num of PE %x", index);
       val_report_status(index, RESULT_FAIL(0xFF), NULL);
       return;
   }
 
-  do {
-      g_smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
-
-      /* Set the TEST function pointer in a shared memory location. This location is
-         read by the Secondary PE (val_test_entry()) and executes the test. */
-      g_smc_args.Arg1 = val_pe_get_mpid_index(index);
+  /* A PE already parked in the pool only needs its mailbox updated, PEs that
+     are still off are woken through PSCI and join the pool afterwards */
+  state = val_pe_wake(index, payload, test_input, 0, &g_smc_args);
 
-      val_set_test_data(index, (uint64_t)payload, test_input);
-      pal_pe_execute_payload(&g_smc_args);
+  if (state == PE_POOL_STATE_PARKED) {
+      val_print(TRACE, "\n       PE pool: dispatched to PE index %d", index);
+      return;
+  }
 
-  } while (g_smc_args.Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON && timeout--);
+  /* The pool still owns a PE that never parked, so ALREADY_ON is a failure */
+  if ((state != PE_POOL_STATE_OFF) && (g_smc_args.Arg0 != 0)) {
+      val_print(ERROR, "\n       PE pool: PE index %d did not return to the pool", index);
+      val_set_status(index, RESULT_FAIL(0x120 - (int)g_smc_args.Arg0));
+      return;
+  }
 
   if (g_smc_args.Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON) {
       val_print(ERROR, "\n       PSCI_CPU_ON: cpu already on");
@@ -408,6 +937,9 @@ val_pe_default_esr(uint64_t interrupt_type, void *context)
     }
 #endif
 
+    /* Keep the exception report in the log file if the run does not recover */
+    val_log_flush();
+
     val_set_status(index, RESULT_FAIL(1));
     val_pe_update_elr(context, g_exception_ret_addr);
 }
@@ -20,10 +20,94 @@
 #include "acs_common.h"
 #include "acs_pe.h"
 #include "acs_ras.h"
+#include "acs_memory.h"
 
 static RAS_INFO_TABLE  *g_ras_info_table;
 static RAS2_INFO_TABLE *g_ras2_info_table;
 
+/* Per-node register access data, resolved once from the RAS info table */
+typedef struct {
+  uint32_t intf_type;
+  uint32_t start_rec_index;
+  uint32_t num_err_rec;
+  uint64_t err_rec_implement;  /* Bit[n] set: record n is not implemented */
+  uint64_t base;               /* MMIO base, record 0 */
+  uint64_t rec_base;           /* MMIO base of the first record of the node */
+} RAS_NODE_DESC;
+
+static RAS_NODE_DESC *g_ras_node_desc;
+static uint32_t g_ras_sr_misc23;  /* ERXMISC2/3_EL1 implemented (RASv1p1) */
+
+/**
+  @brief   Fill the register access descriptor of a RAS node
+
+  @param   node_index  RAS Node index in the info table
+  @param   desc        Descriptor to fill
+
+  @return  None
+**/
+static void
+val_ras_fill_node_desc(uint32_t node_index, RAS_NODE_DESC *desc)
+{
+  RAS_INTERFACE_INFO *intf = &g_ras_info_table->node[node_index].intf_info;
+
+  desc->intf_type         = intf->intf_type;
+  desc->start_rec_index   = intf->start_rec_index;
+  desc->num_err_rec       = intf->num_err_rec;
+  desc->err_rec_implement = intf->err_rec_implement;
+  desc->base              = intf->base_addr;
+  desc->rec_base          = intf->base_addr + (uint64_t)ERR_RECORD_SIZE * intf->start_rec_index;
+}
+
+/**
+  @brief   Build the per-node descriptors used by the RAS register accessors
+           1. Caller       -  val_ras_create_info_table
+           2. Prerequisite -  pal_ras_create_info_table
+
+  @return  None
+**/
+static void
+val_ras_build_node_desc(void)
+{
+  uint32_t i, ras;
+
+  ras = VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64PFR0_EL1), 28, 31);
+  g_ras_sr_misc23 = (ras >= RAS_VERSION_1P1) ||
+                    (ras == 1 && VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64PFR1_EL1), 12, 15) == 1);
+
+  g_ras_node_desc = NULL;
+  if (g_ras_info_table->num_nodes == 0)
+      return;
+
+  g_ras_node_desc = val_memory_alloc(g_ras_info_table->num_nodes * sizeof(RAS_NODE_DESC));
+  if (g_ras_node_desc == NULL) {
+      val_print(DEBUG, "\n       RAS node descriptor allocation failed");
+      return;
+  }
+
+  for (i = 0; i < g_ras_info_table->num_nodes; i++)
+      val_ras_fill_node_desc(i, &g_ras_node_desc[i]);
+}
+
+/**
+  @brief   Return the register access descriptor of a RAS node. Falls back to
+           filling the caller's buffer when the descriptors were not built.
+
+  @param   node_index  RAS Node index in the info table
+  @param   local       Caller storage used for the fallback
+
+  @return  Descriptor of the node
+**/
+static RAS_NODE_DESC *
+val_ras_get_node_desc(uint32_t node_index, RAS_NODE_DESC *local)
+{
+  if (g_ras_node_desc != NULL)
+      return &g_ras_node_desc[node_index];
+
+  val_ras_fill_node_desc(node_index, local);
+  return local;
+}
+
 
 /**
   @brief   This API will call PAL layer to fill in the RAS information
@@ -45,6 +129,7 @@ val_ras_create_info_table(uint64_t *ras_info_table)
   g_ras_info_table = (RAS_INFO_TABLE *)ras_info_table;
 
   pal_ras_create_info_table(g_ras_info_table);
+  val_ras_build_node_desc();
 
   val_print(INFO, "\n    RAS_INFO: Number of RAS nodes        : %4d",
                            g_ras_info_table->num_nodes);
@@ -58,6 +143,11 @@ val_ras_create_info_table(uint64_t *ras_info_table)
 void
 val_ras_free_info_table(void)
 {
+    if (g_ras_node_desc != NULL) {
+        val_memory_free((void *)g_ras_node_desc);
+        g_ras_node_desc = NULL;
+    }
+
     if (g_ras_info_table != NULL) {
         pal_mem_free((void *)g_ras_info_table);
         g_ras_info_table = NULL;
@@ -365,28 +455,26 @@ val_ras2_get_mem_info(RAS2_MEM_INFO_e type, uint32_t index)
 uint64_t
 val_ras_reg_read(uint32_t node_index, uint32_t reg, uint32_t err_rec_idx)
 {
-  uint64_t base, value = INVALID_RAS_REG_VAL;
-  uint32_t start_rec_index, offset = 0;
-  uint64_t num_err_recs, err_rec_impl_bitmap;
+  uint64_t addr, value = INVALID_RAS_REG_VAL;
+  uint32_t start_rec_index;
+  RAS_NODE_DESC local, *desc;
 
-  start_rec_index = g_ras_info_table->node[node_index].intf_info.start_rec_index;
+  desc = val_ras_get_node_desc(node_index, &local);
+  start_rec_index = desc->start_rec_index;
 
   /* err_rec_idx = 0 means the first error record of the node */
   if (err_rec_idx == 0)
       err_rec_idx = start_rec_index;
 
   /* Check if err record index is valid */
-  val_ras_get_info(RAS_INFO_NUM_ERR_REC, node_index, &num_err_recs);
-  if ((err_rec_idx - start_rec_index) >= num_err_recs) {
+  if ((err_rec_idx - start_rec_index) >= desc->num_err_rec) {
       val_print(ERROR,
                 "\n       RAS_REG_READ : Invalid Input error record index(%d)\n", err_rec_idx);
       return INVALID_RAS_REG_VAL;
   }
 
   /* check if err record is implemented for given node index*/
-  val_ras_get_info(RAS_INFO_ERR_REC_IMP, node_index, &err_rec_impl_bitmap);
-
-  if ((err_rec_impl_bitmap >> err_rec_idx) & 0x1) {
+  if ((desc->err_rec_implement >> err_rec_idx) & 0x1) {
       val_print(ERROR,
                 "\n       RAS_REG_READ : Error record index(%d) is unimplemented ", err_rec_idx);
       val_print(ERROR,
@@ -394,106 +482,72 @@ val_ras_reg_read(uint32_t node_index, uint32_t reg, uint32_t err_rec_idx)
       return INVALID_RAS_REG_VAL;
   }
 
-  if (g_ras_info_table->node[node_index].intf_info.intf_type == RAS_INTF_TYPE_MMIO) {
-      /* MMIO based RAS register read */
-
-      /* Get the Base address for this node */
-      base = g_ras_info_table->node[node_index].intf_info.base_addr;
+  /* ERR<n>PFGCDN and ERR<n>PFGCTL are valid only for the first error record */
+  if ((reg == RAS_ERR_PFGCDN || reg == RAS_ERR_PFGCTL) && err_rec_idx != start_rec_index) {
+      val_print(ERROR, "\n       RAS_REG_READ : ERR<%d>", err_rec_idx);
+      val_print(ERROR, (reg == RAS_ERR_PFGCDN) ? "PFGCDN is RES0 for node index : %d"
+                                               : "PFGCTL is RES0 for node index : %d",
+                node_index);
+      return INVALID_RAS_REG_VAL;
+  }
 
+  if (desc->intf_type == RAS_INTF_TYPE_MMIO) {
+      /* MMIO based RAS register read. ERR<n>FR and ERR<n>CTLR of the first
+         standard error record are shared across the records of the node */
       switch (reg) {
       case RAS_ERR_FR:
-          /* ERR<n>FR RAS register of first standard error record is
-            shared across multiple error records if exists */
-          offset = ERR_FR_OFFSET + (64 * start_rec_index);
+          addr = desc->rec_base + ERR_FR_OFFSET;
           break;
       case RAS_ERR_CTLR:
-          /* ERR<n>CTLR RAS register of first standard error record is
-            shared across multiple error records if exists */
-          offset = ERR_CTLR_OFFSET + (64 * start_rec_index);
+          addr = desc->rec_base + ERR_CTLR_OFFSET;
           break;
       case RAS_ERR_STATUS:
-          offset = ERR_STATUS_OFFSET + (64 * err_rec_idx);
+          addr = desc->base + (uint64_t)ERR_RECORD_SIZE * err_rec_idx + ERR_STATUS_OFFSET;
           break;
       case RAS_ERR_ADDR:
-          offset = ERR_ADDR_OFFSET + (64 * err_rec_idx);
+          addr = desc->base + (uint64_t)ERR_RECORD_SIZE * err_rec_idx + ERR_ADDR_OFFSET;
           break;
       case RAS_ERR_PFGCDN:
-          /* ERR<n>PFGCDN RAS register is valid only for first error record */
-          if (err_rec_idx == start_rec_index)
-              offset = ERR_PFGCDN_OFFSET + (64 * start_rec_index);
-          else {
-              val_print(ERROR,
-                "\n       RAS_REG_READ : ERR<%d>PFGCDN is RES0 for node index :", err_rec_idx);
-              val_print(ERROR, " %d", node_index);
-              return INVALID_RAS_REG_VAL;
-          }
+          addr = desc->rec_base + ERR_PFGCDN_OFFSET;
           break;
       case RAS_ERR_PFGCTL:
-          /* ERR<n>PFGCTL RAS register is valid only for first error record */
-          if (err_rec_idx == start_rec_index)
-              offset = ERR_PFGCTL_OFFSET + (64 * start_rec_index);
-          else {
-              val_print(ERROR,
-                "\n       RAS_REG_READ : ERR<%d>PFGCTL is RES0 for node index :", err_rec_idx);
-              val_print(ERROR, " %d", node_index);
-              return INVALID_RAS_REG_VAL;
-          }
+          addr = desc->rec_base + ERR_PFGCTL_OFFSET;
           break;
       case RAS_ERR_ERRDEVAFF:
           /* only valid for MMIO interface */
-          offset = ERR_ERRDEVAFF_OFFSET;
+          addr = desc->base + ERR_ERRDEVAFF_OFFSET;
+          break;
       default:
+          addr = desc->base;
           break;
       }
-      value = val_mmio_read64(base + offset);
+      value = val_mmio_read64(addr);
   } else {
-      /* System register based read */
-
-      /* RAS registers reads with ERRSELR_EL1.SEL set to start error record index */
-      write_errselr_el1(start_rec_index);
-
+      /* System register based read, with ERRSELR_EL1.SEL set to the start
+         record for shared registers and to err_rec_idx for per-record ones */
       switch (reg) {
       case RAS_ERR_FR:
+          write_errselr_el1(start_rec_index);
           value = read_erxfr_el1();
           break;
       case RAS_ERR_CTLR:
+          write_errselr_el1(start_rec_index);
           value = read_erxctlr_el1();
           break;
       case RAS_ERR_PFGCDN:
-          /* ERR<n>PFGCDN RAS register is valid only for first error record */
-          if (err_rec_idx == start_rec_index)
-              value = read_erxpfgcdn_el1();
-          else {
-              val_print(ERROR,
-                "\n       RAS_REG_READ : ERR<%d>PFGCDN is RES0 for the node index :", err_rec_idx);
-              val_print(ERROR, " %d", node_index);
-              return INVALID_RAS_REG_VAL;
-          }
+          write_errselr_el1(start_rec_index);
+          value = read_erxpfgcdn_el1();
           break;
       case RAS_ERR_PFGCTL:
-          /* ERR<n>PFGCTL RAS register is valid only for first error record */
-          if (err_rec_idx == start_rec_index)
-              value = read_erxpfgctl_el1();
-          else {
-              val_print(ERROR,
-                "\n       RAS_REG_READ : ERR<%d>PFGCTL is RES0 for the node index :", err_rec_idx);
-              val_print(ERROR, " %d", node_index);
-              return INVALID_RAS_REG_VAL;
-          }
-          break;
-      default:
+          write_errselr_el1(start_rec_index);
+          value = read_erxpfgctl_el1();
           break;
-      }
-
-      /* RAS registers reads with ERRSELR_EL1.SEL set to current error record index
-        These registers are unique to given error record */
-      write_errselr_el1(err_rec_idx);
-
-      switch (reg) {
       case RAS_ERR_STATUS:
+          write_errselr_el1(err_rec_idx);
           value = read_erxstatus_el1();
           break;
       case RAS_ERR_ADDR:
+          write_errselr_el1(err_rec_idx);
           value = read_erxaddr_el1();
           break;
       default:
@@ -516,43 +570,40 @@ val_ras_reg_read(uint32_t node_index, uint32_t reg, uint32_t err_rec_idx)
 void
 val_ras_reg_write(uint32_t node_index, uint32_t reg, uint64_t write_data)
 {
-  uint64_t base;
-  uint32_t rec_index, offset = 0;
-
-  rec_index = g_ras_info_table->node[node_index].intf_info.start_rec_index;
+  uint64_t addr;
+  RAS_NODE_DESC local, *desc;
 
-  if (g_ras_info_table->node[node_index].intf_info.intf_type == RAS_INTF_TYPE_MMIO) {
-    /* MMIO Based Write */
-
-    /* Get the Base address for this node */
-    base = g_ras_info_table->node[node_index].intf_info.base_addr;
+  desc = val_ras_get_node_desc(node_index, &local);
 
+  if (desc->intf_type == RAS_INTF_TYPE_MMIO) {
+    /* MMIO Based Write to the first error record of the node */
     switch (reg) {
     case RAS_ERR_FR:
-      offset = ERR_FR_OFFSET + (64 * rec_index);
+      addr = desc->rec_base + ERR_FR_OFFSET;
       break;
     case RAS_ERR_CTLR:
-      offset = ERR_CTLR_OFFSET + (64 * rec_index);
+      addr = desc->rec_base + ERR_CTLR_OFFSET;
       break;
     case RAS_ERR_STATUS:
-      offset = ERR_STATUS_OFFSET + (64 * rec_index);
+      addr = desc->rec_base + ERR_STATUS_OFFSET;
       break;
     case RAS_ERR_PFGCDN:
-      offset = ERR_PFGCDN_OFFSET + (64 * rec_index);
+      addr = desc->rec_base + ERR_PFGCDN_OFFSET;
       break;
     case RAS_ERR_PFGCTL:
-      offset = ERR_PFGCTL_OFFSET + (64 * rec_index);
+      addr = desc->rec_base + ERR_PFGCTL_OFFSET;
       break;
     default:
+      addr = desc->base;
       break;
     }
 
-    val_mmio_write64(base + offset, write_data);
+    val_mmio_write64(addr, write_data);
   } else {
     /* System register based Write */
 
     /* Update ERRSELR_EL1.SEL to choose which record index to use */
-    write_errselr_el1(rec_index);
+    write_errselr_el1(desc->start_rec_index);
 
     switch (reg) {
     case RAS_ERR_CTLR:
@@ -573,6 +624,67 @@ val_ras_reg_write(uint32_t node_index, uint32_t reg, uint64_t write_data)
   }
 }
 
+/**
+  @brief   Read ERR<n>STATUS, ERR<n>ADDR and ERR<n>MISC0-3 of every error
+           record of a node in one pass.
+           1. Caller       -  Test layer.
+           2. Prerequisite -  val_ras_create_info_table.
+  @param   node_index  RAS Node index in the info table.
+  @param   snapshot    Output array, entry i is record (start index + i).
+  @param   max_recs    Number of entries in snapshot.
+  @return  Number of entries filled. Unimplemented records, and MISC2/3 on a
+           system register interface without RASv1p1, read as INVALID_RAS_REG_VAL.
+**/
+uint32_t
+val_ras_snapshot_node(uint32_t node_index, RAS_ERR_REC_SNAPSHOT *snapshot, uint32_t max_recs)
+{
+  uint32_t i, rec, num_recs;
+  uint64_t addr;
+  RAS_NODE_DESC local, *desc;
+
+  if (g_ras_info_table == NULL || snapshot == NULL ||
+      node_index >= g_ras_info_table->num_nodes)
+      return 0;
+
+  desc = val_ras_get_node_desc(node_index, &local);
+  num_recs = (desc->num_err_rec < max_recs) ? desc->num_err_rec : max_recs;
+
+  for (i = 0; i < num_recs; i++) {
+      rec = desc->start_rec_index + i;
+
+      /* Same implemented-record check as val_ras_reg_read */
+      if (rec < 64 && ((desc->err_rec_implement >> rec) & 0x1)) {
+          snapshot[i].status  = INVALID_RAS_REG_VAL;
+          snapshot[i].addr    = INVALID_RAS_REG_VAL;
+          snapshot[i].misc[0] = INVALID_RAS_REG_VAL;
+          snapshot[i].misc[1] = INVALID_RAS_REG_VAL;
+          snapshot[i].misc[2] = INVALID_RAS_REG_VAL;
+          snapshot[i].misc[3] = INVALID_RAS_REG_VAL;
+          continue;
+      }
+
+      if (desc->intf_type == RAS_INTF_TYPE_MMIO) {
+          addr = desc->rec_base + (uint64_t)ERR_RECORD_SIZE * i;
+          snapshot[i].status  = val_mmio_read64(addr + ERR_STATUS_OFFSET);
+          snapshot[i].addr    = val_mmio_read64(addr + ERR_ADDR_OFFSET);
+          snapshot[i].misc[0] = val_mmio_read64(addr + ERR_MISC0_OFFSET);
+          snapshot[i].misc[1] = val_mmio_read64(addr + ERR_MISC1_OFFSET);
+          snapshot[i].misc[2] = val_mmio_read64(addr + ERR_MISC2_OFFSET);
+          snapshot[i].misc[3] = val_mmio_read64(addr + ERR_MISC3_OFFSET);
+      } else {
+          write_errselr_el1(rec);
+          snapshot[i].status  = read_erxstatus_el1();
+          snapshot[i].addr    = read_erxaddr_el1();
+          snapshot[i].misc[0] = read_erxmisc0_el1();
+          snapshot[i].misc[1] = read_erxmisc1_el1();
+          snapshot[i].misc[2] = g_ras_sr_misc23 ? read_erxmisc2_el1() : INVALID_RAS_REG_VAL;
+          snapshot[i].misc[3] = g_ras_sr_misc23 ? read_erxmisc3_el1() : INVALID_RAS_REG_VAL;
+      }
+  }
+
+  return num_recs;
+}
+
 /**
   @brief  Function to clear the RAS error status after an error interrupt.
 
@@ -682,7 +794,8 @@ val_ras_setup_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param)
 }
 
 /**
-  @brief  Platform Defined way of Timeout/Wait loop
+  @brief  Wait for count RAS_WAIT_UNIT_US intervals, measured with
+          val_deadline_wait so the wait does not depend on the PE speed
 
   @param  count  - Timeout/Wait Multiplier.
 
@@ -691,7 +804,7 @@ val_ras_setup_error(RAS_ERR_IN_t in_param, RAS_ERR_OUT_t *out_param)
 void
 val_ras_wait_timeout(uint32_t count)
 {
-  pal_ras_wait_timeout(count);
+  val_deadline_wait((uint64_t)count * RAS_WAIT_UNIT_US);
 }
 
 void
@@ -88,5 +88,7 @@ val_report_status(uint32_t index, uint32_t status, char8_t *ruleid)
           else
             val_print(INFO, ": Result:  %8x\n", status);
 
+  /* Test boundary, write out the buffered log records */
+  val_log_flush();
 }
 
@@ -22,6 +22,11 @@
 #include "pal_interface.h"
 #include "val_interface.h"
 #include "val_status.h"
+#ifdef COMPILE_RB_EXE
+#include "rule_based_execution.h"
+
+extern rule_test_map_t rule_test_map[RULE_ID_SENTINEL];
+#endif
 
 uint32_t g_override_skip;
 static acs_test_status_counters_t g_rule_test_stats;
@@ -91,6 +96,8 @@ val_log_context(char8_t *file, char8_t *func, uint32_t line)
  **/
 void val_print_primary_pe(uint32_t level, char8_t *string, uint64_t data, uint32_t index)
 {
+  if (!VAL_PRINT_ENABLED(level))
+      return;
 
   if (index == val_pe_get_primary_index())
       val_print(level, string, data);
@@ -371,6 +378,22 @@ val_check_skip_module(uint32_t module_base)
 
   return ACS_STATUS_PASS;
 }
+
+/**
+  @brief  This API checks if any test of a module can run with the user
+          override options.
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param module_base Base number of the module
+
+  @return         true if the module is selected, false otherwise
+ **/
+bool
+acs_is_module_enabled(uint32_t module_base)
+{
+  return (val_check_skip_module(module_base) == ACS_STATUS_PASS);
+}
 #else
 uint32_t
 val_check_skip_module(uint32_t module_base)
@@ -378,6 +401,65 @@ val_check_skip_module(uint32_t module_base)
   (void)module_base;
   return ACS_STATUS_PASS;
 }
+
+/* Return true if value is present in list */
+static bool
+val_list_contains(const uint32_t *list, uint32_t count, uint32_t value)
+{
+  uint32_t i;
+
+  if (list == NULL)
+      return false;
+
+  for (i = 0; i < count; i++) {
+      if (list[i] == value)
+          return true;
+  }
+
+  return false;
+}
+
+/**
+  @brief  This API checks if any test of a module can run with the run
+          request selections (-m, -r and -skipmodule).
+          1. Caller       - Application layer
+          2. Prerequisite - Run request populated from the command line or
+                            EL3 parameters.
+
+  @param module_base Base number of the module
+
+  @return         true if the module is selected, false otherwise
+ **/
+bool
+acs_is_module_enabled(uint32_t module_base)
+{
+  const acs_run_request_t *ctx = acs_get_run_request();
+  RULE_ID_e rule;
+  uint32_t i;
+
+  /* -skipmodule has highest priority */
+  if (val_list_contains(ctx->skip_modules, ctx->num_skip_modules, module_base))
+      return false;
+
+  /* No overrides: enable everything */
+  if (ctx->rule_count == 0 && ctx->num_modules == 0)
+      return true;
+
+  if (val_list_contains(ctx->execute_modules, ctx->num_modules, module_base))
+      return true;
+
+  for (i = 0; i < ctx->rule_count; i++) {
+      rule = ctx->rule_list[i];
+
+      if (rule >= RULE_ID_SENTINEL)
+          continue;
+
+      if (rule_test_map[rule].module_id == module_base)
+          return true;
+  }
+
+  return false;
+}
 #endif /* COMPILE_RB_EXE */
 
 /**
@@ -474,12 +556,25 @@ val_allocate_shared_mem()
 {
   uint32_t num_pe = val_pe_get_num();
 
+  /* Extra cache line lets the PE pool mailbox region be aligned up */
   uint32_t total_size =
         (num_pe * sizeof(VAL_SHARED_MEM_t)) +
-        (num_pe * sizeof(val_test_status_t));
+        (num_pe * sizeof(val_test_status_t)) +
+        (num_pe * sizeof(VAL_PE_MAILBOX_t)) + VAL_PE_MAILBOX_ALIGN +
+        (PE_COMPLETION_WORDS(num_pe) * sizeof(uint64_t)) +
+        (PE_FANOUT_SLOTS * sizeof(VAL_PE_FANOUT_t));
+  uint32_t pe_ctrl_size =
+        (num_pe * sizeof(VAL_PE_MAILBOX_t)) +
+        (PE_COMPLETION_WORDS(num_pe) * sizeof(uint64_t)) +
+        (PE_FANOUT_SLOTS * sizeof(VAL_PE_FANOUT_t));
 
   pal_mem_allocate_shared(1, total_size);
 
+  /* All secondary PEs start powered off, with no completion reported and
+     no fan-out launch in progress */
+  val_memory_set((void *)val_get_pe_mailbox_region_base(), pe_ctrl_size, 0);
+  val_pe_cache_clean_invalidate_range((uint64_t)val_get_pe_mailbox_region_base(),
+                                      pe_ctrl_size);
 }
 
 uintptr_t val_get_status_region_base(void)
@@ -492,6 +587,52 @@ uintptr_t val_get_status_region_base(void)
     return base;
 }
 
+/**
+  @brief  Return the base of the PE pool mailbox region. Mailboxes follow the
+          status region and are aligned so that each one owns a cache line.
+
+  @param  None
+
+  @result Base address of the mailbox array, indexed by PE index
+**/
+uintptr_t val_get_pe_mailbox_region_base(void)
+{
+    uintptr_t base = val_get_status_region_base();
+    uint32_t npe = val_pe_get_num();
+
+    base += (uintptr_t)(npe * sizeof(val_test_status_t));
+    base = (base + VAL_PE_MAILBOX_ALIGN - 1) & ~((uintptr_t)VAL_PE_MAILBOX_ALIGN - 1);
+    return base;
+}
+
+/**
+  @brief  Return the base of the PE completion bitmap, which follows the PE
+          pool mailboxes. Bit n is set once PE n reports a final status.
+
+  @param  None
+
+  @result Base address of the completion bitmap
+**/
+uintptr_t val_get_pe_completion_region_base(void)
+{
+    return val_get_pe_mailbox_region_base() +
+           (uintptr_t)(val_pe_get_num() * sizeof(VAL_PE_MAILBOX_t));
+}
+
+/**
+  @brief  Return the base of the PE fan-out descriptors, which follow the PE
+          completion bitmap.
+
+  @param  None
+
+  @result Address of the first of PE_FANOUT_SLOTS fan-out descriptors
+**/
+uintptr_t val_get_pe_fanout_region_base(void)
+{
+    return val_get_pe_completion_region_base() +
+           (uintptr_t)(PE_COMPLETION_WORDS(val_pe_get_num()) * sizeof(uint64_t));
+}
+
 /**
   @brief  Free the memory which was allocated by allocate_shared_mem
         1. Caller       - Application Layer
@@ -505,6 +646,8 @@ void
 val_free_shared_mem()
 {
 
+  /* Parked secondary PEs poll the shared region, power them off first */
+  val_pe_pool_release();
   pal_mem_free_shared();
 }
 
@@ -578,46 +721,180 @@ val_get_test_data(uint32_t index, uint64_t *data0, uint64_t *data1)
 
 }
 
+#ifndef TARGET_LINUX
+/**
+  @brief  Atomically OR a mask into a 64-bit word in shared memory
+**/
+static inline void
+val_atomic_or64(volatile uint64_t *addr, uint64_t mask)
+{
+  uint64_t tmp;
+  uint32_t fail;
+
+  __asm__ volatile (
+      "1: ldxr  %0, [%2]\n"
+      "   orr   %0, %0, %3\n"
+      "   stxr  %w1, %0, [%2]\n"
+      "   cbnz  %w1, 1b\n"
+      : "=&r" (tmp), "=&r" (fail)
+      : "r" (addr), "r" (mask)
+      : "memory");
+}
+#endif
+
+/**
+  @brief  Clear the PE completion bitmap before a multi-PE payload is launched.
+          1. Caller       - VAL
+          2. Prerequisite - val_allocate_shared_mem
+
+  @param  None
+
+  @return None
+ **/
+void
+val_pe_completion_reset(void)
+{
+  volatile uint64_t *done = (volatile uint64_t *)val_get_pe_completion_region_base();
+  uint32_t words = PE_COMPLETION_WORDS(val_pe_get_num());
+  uint32_t i;
+
+  for (i = 0; i < words; i++)
+      done[i] = 0;
+
+  val_pe_cache_clean_invalidate_range((uint64_t)done, words * sizeof(uint64_t));
+}
+
+/**
+  @brief  Mark the status slot of a PE as complete and wake the primary PE.
+          1. Caller       - val_set_status
+          2. Prerequisite - val_allocate_shared_mem
+
+  @param  index  PE index whose status became final
+
+  @return None
+ **/
+void
+val_pe_completion_signal(uint32_t index)
+{
+#ifndef TARGET_LINUX
+  volatile uint64_t *done = (volatile uint64_t *)val_get_pe_completion_region_base();
+
+  val_atomic_or64(&done[index / 64], 1ull << (index % 64));
+  val_data_cache_ops_by_va((addr_t)&done[index / 64], CLEAN);
+
+  dsbsy();
+  sev();
+#else
+  (void)index;
+#endif
+}
+
+/**
+  @brief  Check whether all PEs in [0, num_pe) have reported completion
+**/
+static uint32_t
+val_pe_completion_done(volatile uint64_t *done, uint32_t num_pe)
+{
+  uint32_t i;
+  uint64_t mask;
+
+  for (i = 0; i < PE_COMPLETION_WORDS(num_pe); i++) {
+      mask = ((num_pe - (i * 64)) >= 64) ? ~0ull : ((1ull << (num_pe % 64)) - 1);
+      val_data_cache_ops_by_va((addr_t)&done[i], INVALIDATE);
+      if ((done[i] & mask) != mask)
+          return 0;
+  }
+
+  return 1;
+}
+
+/**
+  @brief  val_poll_until condition: every PE in [0, num_pe) reported completion
+**/
+typedef struct {
+  volatile uint64_t *done;
+  uint32_t num_pe;
+} pe_completion_cond_t;
+
+static uint32_t
+val_pe_completion_cond(void *arg)
+{
+  pe_completion_cond_t *cond = (pe_completion_cond_t *)arg;
+#ifndef TARGET_LINUX
+  return val_pe_completion_done(cond->done, cond->num_pe);
+#else
+  uint32_t i;
+
+  for (i = 0; i < cond->num_pe; i++) {
+      if (IS_RESULT_PENDING(val_get_status(i)))
+          return 0;
+  }
+
+  return 1;
+#endif
+}
+
+/**
+  @brief  Wait until all PEs have reported a final status. Secondary PEs set
+          their bit in the completion bitmap and issue SEV, the primary PE
+          sleeps in WFE and is woken by SEV or the generic timer event stream.
+          The deadline is handled by val_poll_until.
+          1. Caller       - VAL
+          2. Prerequisite - val_pe_completion_reset
+
+  @param  num_pe      Number of PEs executing the payload
+  @param  timeout_us  Deadline in microseconds
+
+  @return Number of PEs which missed the deadline. Each of them is marked failed.
+ **/
+uint32_t
+val_pe_completion_wait(uint32_t num_pe, uint32_t timeout_us)
+{
+  pe_completion_cond_t cond;
+  uint32_t missed = 0;
+  uint32_t i;
+
+  cond.done = (volatile uint64_t *)val_get_pe_completion_region_base();
+  cond.num_pe = num_pe;
+  val_poll_until(val_pe_completion_cond, &cond, timeout_us, DEADLINE_BACKOFF_WFE);
+
+  /* Report every PE which is still pending, not just the last one */
+  for (i = 0; i < num_pe; i++) {
+      if (!IS_RESULT_PENDING(val_get_status(i)))
+          continue;
+
+      val_print(ERROR, "\n       PE index %d did not report status before deadline", i);
+      val_set_status(i, RESULT_FAIL(0xF));
+      missed++;
+  }
+
+  return missed;
+}
+
 /**
   @brief  This function will wait for all PEs to report their status
-          or we timeout and set a failure for the PE which timed-out
+          or we timeout and set a failure for each PE which timed-out
           1. Caller       - Application layer
           2. Prerequisite - val_set_status
 
-  @param test_num  Unique test number
-  @param num_pe    Number of PE who are executing this test
-  @param timeout   integer value ob expiry the API will timeout and return
+  @param test_num    Unique test number
+  @param num_pe      Number of PE who are executing this test
+  @param timeout_us  Deadline in microseconds after which the API returns
 
   @return        None
  **/
 
 static void
-val_wait_for_test_completion(uint32_t test_num, uint32_t num_pe, uint32_t timeout)
+val_wait_for_test_completion(uint32_t test_num, uint32_t num_pe, uint32_t timeout_us)
 {
 
-  uint32_t i = 0, j = 0;
-
   val_print(TRACE, "\n       Test_num= %d", test_num);
 
   //For single PE tests, there is no need to wait for the results
   if (num_pe == 1)
       return;
 
-  while(--timeout)
-  {
-      j = 0;
-      for (i = 0; i < num_pe; i++)
-      {
-          if (IS_RESULT_PENDING(val_get_status(i))) {
-              j = i+1;
-          }
-      }
-      //If None of the PE have the status as Pending, return
-      if (!j)
-          return;
-  }
-  //We are here if we timed-out, set the last index PE as failed
-  val_set_status(j-1, RESULT_FAIL(0xF));
+  val_pe_completion_wait(num_pe, timeout_us);
 }
 
 /**
@@ -639,17 +916,26 @@ val_run_test_payload(uint32_t test_num, uint32_t num_pe, void (*payload)(void),
   uint32_t my_index = val_pe_get_primary_index();
   uint32_t i;
 
+  if (num_pe > 1)
+      val_pe_completion_reset();
+
   payload();  //this is test run separately on present PE
   if (num_pe == 1)
       return;
 
-  //Now run the test on all other PE
+  //Now run the test on all other PE, through a wake-up tree on large systems
+  if (val_pe_fanout_execute(num_pe, payload, test_input) == ACS_STATUS_PASS) {
+      val_wait_for_test_completion(test_num, num_pe, PE_COMPLETION_TIMEOUT_US);
+      val_pe_fanout_complete();
+      return;
+  }
+
   for (i = 0; i < num_pe; i++) {
       if (i != my_index)
           val_execute_on_pe(i, payload, test_input);
   }
 
-  val_wait_for_test_completion(test_num, num_pe, TIMEOUT_LARGE);
+  val_wait_for_test_completion(test_num, num_pe, PE_COMPLETION_TIMEOUT_US);
 }
 
 /**
@@ -862,6 +1148,280 @@ val_get_platform_time_us(void)
   return pal_get_platform_time_us();
 }
 
+/**
+  @brief  Arm a deadline timeout_us microseconds from now, scaled by the
+          timeout_scale policy percentage. The deadline is measured with the
+          generic timer when CNTPCT_EL0 is accessible. Otherwise every call to
+          val_deadline_expired delays for one microsecond and counts as such.
+          1. Caller       - VAL
+          2. Prerequisite - None
+
+  @param  dl          Deadline to arm
+  @param  timeout_us  Nominal deadline in microseconds
+
+  @return None
+ **/
+void
+val_deadline_start(val_deadline_t *dl, uint64_t timeout_us)
+{
+  val_deadline_start_unscaled(dl,
+      (timeout_us * acs_policy_get_timeout_scale()) / DEADLINE_SCALE_DEFAULT);
+}
+
+/**
+  @brief  Arm a deadline exactly timeout_us microseconds from now, ignoring the
+          timeout_scale policy. For architected minimum intervals that must
+          not be shortened. Callers must check use_counter and not rely on
+          the poll-count fallback for such intervals.
+          1. Caller       - VAL
+          2. Prerequisite - None
+
+  @param  dl          Deadline to arm
+  @param  timeout_us  Deadline in microseconds
+
+  @return None
+ **/
+void
+val_deadline_start_unscaled(val_deadline_t *dl, uint64_t timeout_us)
+{
+  uint64_t freq = 0;
+
+#ifndef TARGET_LINUX
+  if (!(acs_policy_get_el1skiptrap_mask() & EL1SKIPTRAP_CNTPCT))
+      freq = val_get_counter_frequency();
+#endif
+
+  dl->use_counter = (freq != 0);
+  dl->ticks = timeout_us;
+  dl->start = 0;
+#ifndef TARGET_LINUX
+  if (dl->use_counter) {
+      dl->ticks = (timeout_us * freq) / MICRO_SECONDS;
+      dl->start = syscounter_read();
+  }
+#endif
+}
+
+/**
+  @brief  Check whether a deadline armed by val_deadline_start has passed
+          1. Caller       - VAL
+          2. Prerequisite - val_deadline_start
+
+  @param  dl  Deadline to check
+
+  @return 1 if the deadline has passed, 0 otherwise
+ **/
+uint32_t
+val_deadline_expired(val_deadline_t *dl)
+{
+#ifndef TARGET_LINUX
+  if (dl->use_counter)
+      return ((syscounter_read() - dl->start) >= dl->ticks);
+#endif
+
+  if (++dl->start > dl->ticks)
+      return 1;
+
+  /* No counter to read, so make every poll take at least the microsecond
+     it accounts for */
+  val_time_delay_ms(1);
+  return 0;
+}
+
+/**
+  @brief  Spin until timeout_us microseconds, scaled by the timeout_scale
+          policy percentage, have passed. Only falls back to the PAL delay
+          service when the generic timer cannot be read.
+          1. Caller       - VAL
+          2. Prerequisite - None
+
+  @param  timeout_us  Nominal wait in microseconds
+
+  @return None
+ **/
+void
+val_deadline_wait(uint64_t timeout_us)
+{
+  val_deadline_t dl;
+
+  val_deadline_start(&dl, timeout_us);
+  while (!val_deadline_expired(&dl))
+      ;
+}
+
+#ifndef TARGET_LINUX
+/**
+  @brief  Enable the generic timer event stream of the current EL, so that WFE
+          also wakes up periodically. At EL2 the stream is controlled by
+          CNTHCTL_EL2 whatever the value of HCR_EL2.{E2H,TGE}, at EL1 by
+          CNTKCTL_EL1.
+
+  @param  reg    Set to the timer register that controls the stream
+  @param  saved  Set to the previous value of that register
+
+  @return 1 if the event stream reads back as enabled, 0 otherwise
+ **/
+static uint32_t
+val_event_stream_enable(ARM_ARCH_TIMER_REGS *reg, uint64_t *saved)
+{
+  uint64_t ctl;
+
+  *reg = (val_pe_reg_read(CurrentEL) == AARCH64_EL2) ? CnthCtl : CntkCtl;
+  *saved = ArmArchTimerReadReg(*reg);
+  ctl = (*saved & ~CNTKCTL_EVNTI_MASK) | CNTKCTL_EVNTEN |
+        (PE_COMPLETION_EVNTI << CNTKCTL_EVNTI_SHIFT);
+  ArmArchTimerWriteReg(*reg, &ctl);
+
+  ctl = ArmArchTimerReadReg(*reg);
+  return ((ctl & (CNTKCTL_EVNTEN | CNTKCTL_EVNTI_MASK)) ==
+          (CNTKCTL_EVNTEN | (PE_COMPLETION_EVNTI << CNTKCTL_EVNTI_SHIFT)));
+}
+#endif
+
+/**
+  @brief  Probe cond until it returns non-zero or the deadline passes. Between
+          two probes the PE spins, waits in WFE or delays for an interval that
+          doubles from DEADLINE_DELAY_MIN_US to DEADLINE_DELAY_MAX_US.
+          WFE relies on the generic timer event stream to bound each wait. It
+          degrades to spinning when the counter is not used, and to the delay
+          backoff when the event stream cannot be enabled.
+          1. Caller       - VAL
+          2. Prerequisite - None
+
+  @param  cond        Condition to probe, called with arg
+  @param  arg         Argument passed to cond
+  @param  timeout_us  Nominal deadline in microseconds
+  @param  backoff     DEADLINE_BACKOFF_NONE, DEADLINE_BACKOFF_WFE or DEADLINE_BACKOFF_DELAY
+
+  @return ACS_STATUS_PASS if cond was met, ACS_STATUS_FAIL on timeout
+ **/
+uint32_t
+val_poll_until(uint32_t (*cond)(void *arg), void *arg, uint64_t timeout_us, uint32_t backoff)
+{
+  val_deadline_t dl;
+  uint64_t delay_us = DEADLINE_DELAY_MIN_US;
+  uint32_t status = ACS_STATUS_FAIL;
+#ifndef TARGET_LINUX
+  ARM_ARCH_TIMER_REGS evnt_reg = CntkCtl;
+  uint64_t evnt_ctl = 0;
+#endif
+
+  val_deadline_start(&dl, timeout_us);
+
+#ifndef TARGET_LINUX
+  if ((backoff == DEADLINE_BACKOFF_WFE) && dl.use_counter) {
+      /* Generate a periodic event so WFE also wakes up to check the deadline
+         when nobody issues SEV. Without it WFE could block forever. */
+      if (!val_event_stream_enable(&evnt_reg, &evnt_ctl)) {
+          ArmArchTimerWriteReg(evnt_reg, &evnt_ctl);
+          backoff = DEADLINE_BACKOFF_DELAY;
+      }
+  } else if (backoff == DEADLINE_BACKOFF_WFE) {
+      backoff = DEADLINE_BACKOFF_NONE;
+  }
+#else
+  if (backoff == DEADLINE_BACKOFF_WFE)
+      backoff = DEADLINE_BACKOFF_NONE;
+#endif
+
+  while (1) {
+      if (cond(arg)) {
+          status = ACS_STATUS_PASS;
+          break;
+      }
+
+      if (val_deadline_expired(&dl))
+          break;
+
+      if (backoff == DEADLINE_BACKOFF_DELAY) {
+          val_time_delay_ms(delay_us);
+          /* In poll-count mode account for the time spent in the delay */
+          if (!dl.use_counter)
+              dl.start += delay_us;
+          if (delay_us < DEADLINE_DELAY_MAX_US)
+              delay_us <<= 1;
+      }
+#ifndef TARGET_LINUX
+      else if (backoff == DEADLINE_BACKOFF_WFE) {
+          wfe();
+      }
+#endif
+  }
+
+#ifndef TARGET_LINUX
+  if (backoff == DEADLINE_BACKOFF_WFE)
+      ArmArchTimerWriteReg(evnt_reg, &evnt_ctl);
+#endif
+
+  return status;
+}
+
+/**
+  @brief  val_poll_until condition: the PE at index reported a final status
+**/
+static uint32_t
+val_pe_status_cond(void *arg)
+{
+  return !IS_RESULT_PENDING(val_get_status(*(uint32_t *)arg));
+}
+
+/**
+  @brief  Wait until the PE at index reports a final status, sleeping in WFE
+          between probes as val_set_status issues SEV
+          1. Caller       - Test Suite
+          2. Prerequisite - val_execute_on_pe
+
+  @param  index       PE index executing the payload
+  @param  timeout_us  Nominal deadline in microseconds
+
+  @return ACS_STATUS_PASS if the PE reported, ACS_STATUS_FAIL on timeout
+ **/
+uint32_t
+val_pe_status_wait(uint32_t index, uint64_t timeout_us)
+{
+  return val_poll_until(val_pe_status_cond, &index, timeout_us, DEADLINE_BACKOFF_WFE);
+}
+
+typedef struct {
+  volatile uint32_t *flag;
+  uint32_t          value;
+} VAL_FLAG_WAIT_t;
+
+/**
+  @brief  val_poll_until condition: the flag holds the awaited value
+**/
+static uint32_t
+val_flag_cond(void *arg)
+{
+  VAL_FLAG_WAIT_t *wait = (VAL_FLAG_WAIT_t *)arg;
+
+  return (*wait->flag == wait->value);
+}
+
+/**
+  @brief  Wait until a flag updated by an interrupt handler or another PE
+          holds value, sleeping in WFE between probes. An interrupt taken
+          on this PE or the generic timer event stream ends each WFE.
+          1. Caller       - Test Suite
+          2. Prerequisite - None
+
+  @param  flag        Flag written by the handler or the other PE
+  @param  value       Value to wait for
+  @param  timeout_us  Nominal deadline in microseconds
+
+  @return ACS_STATUS_PASS once the flag holds value, ACS_STATUS_FAIL on timeout
+ **/
+uint32_t
+val_flag_wait(volatile uint32_t *flag, uint32_t value, uint64_t timeout_us)
+{
+  VAL_FLAG_WAIT_t wait;
+
+  wait.flag = flag;
+  wait.value = value;
+
+  return val_poll_until(val_flag_cond, &wait, timeout_us, DEADLINE_BACKOFF_WFE);
+}
+
 /**
    Calls pal API to dump dtb
 
@@ -51,6 +51,115 @@ bool rule_in_list(RULE_ID_e rid, const RULE_ID_e *list, uint32_t count)
     return 0;
 }
 
+/* Rule IDs which have a name, ordered by name for binary search. Built on the
+ * first lookup since rule_id_string[] is ordered by RULE_ID_e. */
+static uint16_t rule_name_index[RULE_ID_SENTINEL];
+static uint32_t rule_name_index_count;
+
+/**
+ * @brief Order two rules by their ID string, ties ordered by RULE_ID_e.
+ *
+ * @return <0, 0 or >0 as rule a sorts before, equal to or after rule b.
+ */
+static int32_t rule_name_order(uint32_t a, uint32_t b)
+{
+    const char8_t *sa = rule_id_string[a];
+    const char8_t *sb = rule_id_string[b];
+
+    while (*sa && (*sa == *sb)) {
+        sa++;
+        sb++;
+    }
+
+    if (*sa != *sb)
+        return (int32_t)(uint8_t)*sa - (int32_t)(uint8_t)*sb;
+
+    return (int32_t)a - (int32_t)b;
+}
+
+/**
+ * @brief Build rule_name_index with a shell sort of all named rules.
+ */
+static void rule_name_index_build(void)
+{
+    uint32_t gap;
+    uint32_t i;
+    uint32_t j;
+    uint16_t tmp;
+
+    rule_name_index_count = 0;
+    for (i = 0; i < RULE_ID_SENTINEL; i++) {
+        if (rule_id_string[i] != NULL)
+            rule_name_index[rule_name_index_count++] = (uint16_t)i;
+    }
+
+    for (gap = rule_name_index_count / 2; gap > 0; gap /= 2) {
+        for (i = gap; i < rule_name_index_count; i++) {
+            tmp = rule_name_index[i];
+            for (j = i; (j >= gap) && (rule_name_order(rule_name_index[j - gap], tmp) > 0);
+                 j -= gap)
+                rule_name_index[j] = rule_name_index[j - gap];
+            rule_name_index[j] = tmp;
+        }
+    }
+}
+
+/**
+ * @brief Resolve a rule ID string to its RULE_ID_e.
+ *
+ * Binary search over the rule names, sorted once on first use. When a name
+ * is shared by several rule IDs the lowest one is returned.
+ *
+ * @param name NUL terminated rule ID string, e.g. "B_PE_01".
+ * @return Matching RULE_ID_e, or RULE_ID_SENTINEL if the name is unknown.
+ */
+RULE_ID_e rule_id_lookup_by_name(const char8_t *name)
+{
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+    const char8_t *sa;
+    const char8_t *sb;
+    int32_t cmp;
+
+    if (name == NULL)
+        return RULE_ID_SENTINEL;
+
+    if (rule_name_index_count == 0)
+        rule_name_index_build();
+
+    /* Find the first entry whose name is not below the input */
+    lo = 0;
+    hi = rule_name_index_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        sa = rule_id_string[rule_name_index[mid]];
+        sb = name;
+        while (*sa && (*sa == *sb)) {
+            sa++;
+            sb++;
+        }
+        cmp = (int32_t)(uint8_t)*sa - (int32_t)(uint8_t)*sb;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < rule_name_index_count) {
+        sa = rule_id_string[rule_name_index[lo]];
+        sb = name;
+        while (*sa && (*sa == *sb)) {
+            sa++;
+            sb++;
+        }
+        if (*sa == *sb)
+            return (RULE_ID_e)rule_name_index[lo];
+    }
+
+    return RULE_ID_SENTINEL;
+}
+
 /**
  * @brief Reset the current rule reference path.
  *
@@ -396,6 +505,10 @@ print_rule_test_status(uint32_t rule_enum, uint32_t indent, uint32_t status)
     }
 
     test_report_status(status);
+
+    /* Rule boundary, write out the buffered log records */
+    if (top_level_rule)
+        val_log_flush();
     return;
 }
 
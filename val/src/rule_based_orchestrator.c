@@ -332,6 +332,110 @@ exit_rule:
     return rule_test_status;
 }
 
+#define ARCH_TBL_INDEX_NONE 0xFFFF
+
+/**
+ * @brief Return the rule ID at an index of the selected arch rule table.
+ */
+static RULE_ID_e arch_tbl_rule_id(ARCH_SEL_e arch, uint32_t ti)
+{
+    switch (arch) {
+    case ARCH_BSA:
+        return bsa_rule_list[ti].rule_id;
+    case ARCH_SBSA:
+        return sbsa_rule_list[ti].rule_id;
+    case ARCH_PCBSA:
+        return pcbsa_rule_list[ti].rule_id;
+    case ARCH_VBSA:
+        return vbsa_rule_list[ti].rule_id;
+    case ARCH_PFDI:
+        return pfdi_rule_list[ti].rule_id;
+    default:
+        return RULE_ID_SENTINEL;
+    }
+}
+
+/**
+ * @brief Return the number of entries of the selected arch rule table.
+ */
+static uint32_t arch_tbl_len(ARCH_SEL_e arch)
+{
+    switch (arch) {
+    case ARCH_BSA:
+        return bsa_rule_list_len;
+    case ARCH_SBSA:
+        return sbsa_rule_list_len;
+    case ARCH_PCBSA:
+        return pcbsa_rule_list_len;
+    case ARCH_VBSA:
+        return vbsa_rule_list_len;
+    case ARCH_PFDI:
+        return pfdi_rule_list_len;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Apply level and software view filters to an arch rule table entry.
+ *
+ * @param ctx Run request holding the level and software view selections.
+ * @param ti  Index of the rule in the selected arch rule table.
+ * @return true if the rule must be skipped, false otherwise.
+ */
+static bool arch_tbl_entry_filtered(const acs_run_request_t *ctx, uint32_t ti)
+{
+    uint32_t level;
+    uint32_t level_fr;
+    uint32_t bit;
+
+    switch (ctx->arch_selection) {
+    case ARCH_BSA:
+        /* Software view filter if requested: keep if any selected */
+        if (ctx->bsa_sw_view_mask != 0) {
+            bit = (1u << (uint32_t)bsa_rule_list[ti].sw_view);
+            if ((ctx->bsa_sw_view_mask & bit) == 0)
+                return 1;
+        }
+        level = (uint32_t)bsa_rule_list[ti].level;
+        level_fr = (uint32_t)BSA_LEVEL_FR;
+        break;
+    case ARCH_SBSA:
+        level = (uint32_t)sbsa_rule_list[ti].level;
+        level_fr = (uint32_t)SBSA_LEVEL_FR;
+        break;
+    case ARCH_PCBSA:
+        level = (uint32_t)pcbsa_rule_list[ti].level;
+        level_fr = (uint32_t)PCBSA_LEVEL_FR;
+        break;
+    case ARCH_VBSA:
+        level = (uint32_t)vbsa_rule_list[ti].level;
+        level_fr = (uint32_t)VBSA_LEVEL_FR;
+        break;
+    case ARCH_PFDI:
+        /* PFDI has no FR level, FR mode does not filter */
+        level = (uint32_t)pfdi_rule_list[ti].level;
+        level_fr = 0xFFFFFFFF;
+        break;
+    default:
+        return 0;
+    }
+
+    if (ctx->level_filter_mode == LVL_FILTER_FR) {
+        /* Treat FR mode as MAX up to FR */
+        if (level > level_fr)
+            return 1;
+    } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
+        if (level != ctx->level_value)
+            return 1;
+    } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
+        if (level > ctx->level_value)
+            return 1;
+    }
+
+    return 0;
+}
+
 /**
  * @brief Filter the provided rule list in place based on CLI selections.
  *
@@ -342,8 +446,11 @@ exit_rule:
  * - If ctx->execute_modules is provided and non-empty, only rules whose module
  *   is in that list are kept.
  *
- * No new memory is allocated. Elements beyond the returned count remain
- * unchanged but are considered out of range by callers.
+ * Skip, module and dedupe checks use bitsets keyed by RULE_ID_e and
+ * MODULE_NAME_e, and arch table entries are found through a rule-indexed
+ * table, so the cost is linear in the size of the lists. Elements beyond
+ * the returned count remain unchanged but are considered out of range by
+ * callers.
  *
  * @return New count of rules after filtering.
  */
@@ -351,95 +458,57 @@ uint32_t filter_rule_list_by_cli(acs_run_request_t *ctx)
 {
     uint32_t out;
     uint32_t i;
-    uint32_t si;
-    uint32_t mi;
+    uint32_t ti;
     RULE_ID_e rule;
+    RULE_ID_e rid;
     bool skip;
     MODULE_NAME_e module;
-    bool found;
-    /* Pointers to lookup tables for selected arch (if any) */
-    const bsa_rule_entry_t   *bsa_tbl   = NULL;
-    const sbsa_rule_entry_t  *sbsa_tbl  = NULL;
-    const pcbsa_rule_entry_t *pcbsa_tbl = NULL;
-    const vbsa_rule_entry_t  *vbsa_tbl  = NULL;
-    const pfdi_rule_entry_t  *pfdi_tbl  = NULL;
+    bool arch_filter;
     uint32_t tbl_count = 0;
+    uint16_t *arch_index = NULL;
+    uint32_t seen[RULE_BITMAP_WORDS];
+    uint32_t skip_rules[RULE_BITMAP_WORDS];
+    uint32_t skip_modules[MODULE_BITMAP_WORDS];
+    uint32_t exec_modules[MODULE_BITMAP_WORDS];
 
     if (ctx == NULL)
         return 0;
 
-    /* If architecture is selected (-a), merge its rules into the list, deduped */
-    if (ctx->arch_selection != ARCH_NONE) {
-        uint32_t add_count = 0;
-
-        if (ctx->arch_selection == ARCH_BSA) {
-            bsa_tbl = bsa_rule_list;
-            add_count = bsa_rule_list_len;
-        } else if (ctx->arch_selection == ARCH_SBSA) {
-            sbsa_tbl = sbsa_rule_list;
-            add_count = sbsa_rule_list_len;
-        } else if (ctx->arch_selection == ARCH_PCBSA) {
-            pcbsa_tbl = pcbsa_rule_list;
-            add_count = pcbsa_rule_list_len;
-        } else if (ctx->arch_selection == ARCH_VBSA) {
-            vbsa_tbl = vbsa_rule_list;
-            add_count = vbsa_rule_list_len;
-        } else if (ctx->arch_selection == ARCH_PFDI) {
-            pfdi_tbl = pfdi_rule_list;
-            add_count = pfdi_rule_list_len;
-        }
+    tbl_count = arch_tbl_len(ctx->arch_selection);
 
-        tbl_count = add_count;
-
-        if (add_count > 0) {
-            /* Allocate a new buffer sized for worst-case unique merge */
-            RULE_ID_e *old_list = ctx->rule_list;
-            uint32_t old_count = ctx->rule_count;
-            RULE_ID_e *new_list = (RULE_ID_e *)val_memory_alloc((old_count + add_count)
-                                   * sizeof(RULE_ID_e));
-            if (new_list != NULL) {
-                /* Copy existing */
-                for (i = 0; i < old_count; i++) new_list[i] = old_list[i];
-                uint32_t new_count = old_count;
-                /* Append unique entries from table */
-                if (bsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = bsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (sbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = sbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (pcbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = pcbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (vbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = vbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (pfdi_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = pfdi_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                }
+    /* If architecture is selected (-a), merge its rules into the list, deduped */
+    if (tbl_count > 0) {
+        /* Allocate a new buffer sized for worst-case unique merge */
+        RULE_ID_e *old_list = ctx->rule_list;
+        uint32_t old_count = ctx->rule_count;
+        RULE_ID_e *new_list = (RULE_ID_e *)val_memory_alloc((old_count + tbl_count)
+                               * sizeof(RULE_ID_e));
+        if (new_list != NULL) {
+            uint32_t new_count = old_count;
+
+            val_memory_set(seen, sizeof(seen), 0);
+
+            /* Copy existing */
+            for (i = 0; i < old_count; i++) {
+                new_list[i] = old_list[i];
+                if ((uint32_t)old_list[i] < RULE_ID_SENTINEL)
+                    ACS_BITMAP_SET(seen, old_list[i]);
+            }
 
-                if (ctx->rule_list_owned && old_list != NULL)
-                    val_memory_free(old_list);
-                ctx->rule_list = new_list;
-                ctx->rule_count = new_count;
-                ctx->rule_list_owned = true;
+            /* Append unique entries from table */
+            for (ti = 0; ti < tbl_count; ti++) {
+                rid = arch_tbl_rule_id(ctx->arch_selection, ti);
+                if ((uint32_t)rid >= RULE_ID_SENTINEL || ACS_BITMAP_TEST(seen, rid))
+                    continue;
+                ACS_BITMAP_SET(seen, rid);
+                new_list[new_count++] = rid;
             }
+
+            if (ctx->rule_list_owned && old_list != NULL)
+                val_memory_free(old_list);
+            ctx->rule_list = new_list;
+            ctx->rule_count = new_count;
+            ctx->rule_list_owned = true;
         }
     }
 
@@ -447,157 +516,90 @@ uint32_t filter_rule_list_by_cli(acs_run_request_t *ctx)
     if (ctx->rule_list == NULL || ctx->rule_count == 0)
         return 0;
 
-    out = 0;
-    for (i = 0; i < ctx->rule_count; i++) {
-        rule = ctx->rule_list[i];
-        skip = 0;
-
-        /* Skip explicit rule IDs provided via -skip */
-        if (!skip && ctx->skip_rule_count > 0 && ctx->skip_rule_list != NULL) {
-            for (si = 0; si < ctx->skip_rule_count; si++) {
-                if (ctx->skip_rule_list[si] == rule) {
-                    skip = 1;
-                    break;
-                }
-            }
+    /* Skip explicit rule IDs provided via -skip */
+    val_memory_set(skip_rules, sizeof(skip_rules), 0);
+    if (ctx->skip_rule_count > 0 && ctx->skip_rule_list != NULL) {
+        for (i = 0; i < ctx->skip_rule_count; i++) {
+            if ((uint32_t)ctx->skip_rule_list[i] < RULE_ID_SENTINEL)
+                ACS_BITMAP_SET(skip_rules, ctx->skip_rule_list[i]);
         }
+    }
 
-        module = rule_test_map[rule].module_id;
+    /* Skip rules belonging to modules listed in -skipmodule */
+    val_memory_set(skip_modules, sizeof(skip_modules), 0);
+    if (ctx->num_skip_modules > 0 && ctx->skip_modules != NULL) {
+        for (i = 0; i < ctx->num_skip_modules; i++) {
+            if (ctx->skip_modules[i] < MODULE_ID_SENTINEL)
+                ACS_BITMAP_SET(skip_modules, ctx->skip_modules[i]);
+        }
+    }
 
-        /* Skip rules belonging to modules listed in -skipmodule */
-        if (!skip && ctx->num_skip_modules > 0 && ctx->skip_modules != NULL) {
-            for (mi = 0; mi < ctx->num_skip_modules; mi++) {
-                if (ctx->skip_modules[mi] == (uint32_t)module) {
-                    skip = 1;
-                    break;
-                }
-            }
+    /* If -m provided, keep only selected modules */
+    val_memory_set(exec_modules, sizeof(exec_modules), 0);
+    if (ctx->num_modules > 0 && ctx->execute_modules != NULL) {
+        for (i = 0; i < ctx->num_modules; i++) {
+            if (ctx->execute_modules[i] < MODULE_ID_SENTINEL)
+                ACS_BITMAP_SET(exec_modules, ctx->execute_modules[i]);
         }
+    }
 
-        /* If -m provided, keep only selected modules */
-        if (!skip && ctx->num_modules > 0 && ctx->execute_modules != NULL) {
-            found = 0;
-            for (mi = 0; mi < ctx->num_modules; mi++) {
-                if (ctx->execute_modules[mi] == (uint32_t)module) {
-                    found = 1;
-                    break; }
+    /* Level-based filtering and software view filtering (BSA) need the arch
+       table entry of each rule, index the table by rule once */
+    arch_filter = (tbl_count > 0) &&
+                  (ctx->level_filter_mode != LVL_FILTER_NONE ||
+                   (ctx->arch_selection == ARCH_BSA && ctx->bsa_sw_view_mask != 0));
+    if (arch_filter) {
+        /* On allocation failure fall back to a linear table search per rule */
+        arch_index = (uint16_t *)val_memory_alloc(RULE_ID_SENTINEL * sizeof(uint16_t));
+        if (arch_index != NULL) {
+            for (i = 0; i < RULE_ID_SENTINEL; i++)
+                arch_index[i] = ARCH_TBL_INDEX_NONE;
+
+            /* First table entry of a rule wins */
+            for (ti = tbl_count; ti-- > 0; ) {
+                rid = arch_tbl_rule_id(ctx->arch_selection, ti);
+                if ((uint32_t)rid < RULE_ID_SENTINEL)
+                    arch_index[rid] = (uint16_t)ti;
             }
-            if (!found)
-                skip = 1;
         }
+    }
 
-        /* Level-based filtering and software view filtering (BSA) */
-        if (!skip && ctx->arch_selection != ARCH_NONE) {
-            if (ctx->level_filter_mode != LVL_FILTER_NONE ||
-                (ctx->arch_selection == ARCH_BSA && ctx->bsa_sw_view_mask != 0)) {
-                /* Find rule in the selected arch table */
-                bool found_entry = 0;
-                if (bsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (bsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            /* Software view filter if requested: keep if any selected */
-                            if (ctx->bsa_sw_view_mask != 0) {
-                                uint32_t bit = (1u << (uint32_t)bsa_tbl[ti].sw_view);
-                                if ((ctx->bsa_sw_view_mask & bit) == 0) {
-                                    skip = 1;
-                                    break;
-                                }
-                            }
-                            /* Level filtering */
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)bsa_tbl[ti].level > (uint32_t)BSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)bsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)bsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (sbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (sbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)sbsa_tbl[ti].level > (uint32_t)SBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)sbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)sbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (pcbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (pcbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)pcbsa_tbl[ti].level > (uint32_t)PCBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)pcbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)pcbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (vbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (vbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)vbsa_tbl[ti].level > (uint32_t)VBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)vbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)vbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (pfdi_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (pfdi_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)pfdi_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)pfdi_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                }
+    out = 0;
+    for (i = 0; i < ctx->rule_count; i++) {
+        rule = ctx->rule_list[i];
+        module = rule_test_map[rule].module_id;
+
+        skip = ACS_BITMAP_TEST(skip_rules, rule);
+
+        if (!skip && ctx->num_skip_modules > 0 && ctx->skip_modules != NULL &&
+            (uint32_t)module < MODULE_ID_SENTINEL)
+            skip = ACS_BITMAP_TEST(skip_modules, module);
 
-                /* If not found in table, conservatively skip or keep? Keep by default */
-                (void)found_entry; /* silence unused if not used */
+        if (!skip && ctx->num_modules > 0 && ctx->execute_modules != NULL)
+            skip = ((uint32_t)module >= MODULE_ID_SENTINEL) ||
+                   !ACS_BITMAP_TEST(exec_modules, module);
+
+        /* Rules not found in the arch table are kept */
+        if (!skip && arch_filter) {
+            if (arch_index != NULL) {
+                ti = arch_index[rule];
+            } else {
+                for (ti = 0; ti < tbl_count; ti++) {
+                    if (arch_tbl_rule_id(ctx->arch_selection, ti) == rule)
+                        break;
+                }
             }
+            if (ti < tbl_count)
+                skip = arch_tbl_entry_filtered(ctx, ti);
         }
 
         if (!skip)
             ctx->rule_list[out++] = rule;
     }
 
+    if (arch_index != NULL)
+        val_memory_free(arch_index);
+
     ctx->rule_count = out;
     return out;
 }
@@ -618,6 +620,7 @@ run_tests(const acs_run_request_t *ctx)
     uint32_t rule_test_status = 0;
     uint32_t rule_support_status;
     uint32_t num_pe;
+    uint32_t leak_scope;
     RULE_ID_e *rule_list;
     uint32_t list_size;
 
@@ -660,13 +663,17 @@ run_tests(const acs_run_request_t *ctx)
             goto report_status;
         }
 
+        /* Report heap allocations made by the rule that are never freed */
+        leak_scope = val_memory_leak_scope_begin();
         rule_test_status = execute_rule_recursive(ctx, rule_list[i], 0, num_pe, 0);
+        val_memory_leak_scope_end(leak_scope);
 report_status:
         /* Record and print overall rule status */
         rule_status_map[rule_list[i]] = rule_test_status;
         print_rule_test_status(rule_list[i], 0, rule_test_status);
 
     }
+    val_memory_print_heap_stats();
     val_print(INFO,
               "\n\n----------------- Suite run complete ----------------\n");
 }
@@ -17,9 +17,97 @@
 
 #include "val_libc.h"
 
+/* Buffers shorter than this are handled one byte at a time */
+#define LIBC_WORD_THRESHOLD    32
+#define LIBC_WORD_SIZE         sizeof(uint64_t)
+#define LIBC_BLOCK_SIZE        64
+#define LIBC_IS_WORD_ALIGNED(p) ((((uintptr_t)(p)) & (LIBC_WORD_SIZE - 1)) == 0)
+
+/* DCZID_EL0 fields */
+#define LIBC_DCZID_DZP         (1u << 4)
+#define LIBC_DCZID_BS_MASK     0xFu
+
+/**
+  @brief  Copy whole 64-byte blocks between 8-byte aligned buffers with
+          LDP/STP pairs of general purpose registers.
+
+  @param  d       Destination, 8-byte aligned
+  @param  s       Source, 8-byte aligned
+  @param  blocks  Number of 64-byte blocks, non-zero
+
+  @return None
+**/
+static void libc_copy_blocks(uint64_t *d, const uint64_t *s, uint64_t blocks)
+{
+#ifdef __aarch64__
+    __asm__ volatile (
+        "1:\n"
+        "ldp x4, x5, [%[s]]\n"
+        "ldp x6, x7, [%[s], #16]\n"
+        "ldp x8, x9, [%[s], #32]\n"
+        "ldp x10, x11, [%[s], #48]\n"
+        "add %[s], %[s], #64\n"
+        "stp x4, x5, [%[d]]\n"
+        "stp x6, x7, [%[d], #16]\n"
+        "stp x8, x9, [%[d], #32]\n"
+        "stp x10, x11, [%[d], #48]\n"
+        "add %[d], %[d], #64\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [d] "+r" (d), [s] "+r" (s), [n] "+r" (blocks)
+        :
+        : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "cc", "memory");
+#else
+    while (blocks--) {
+        d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+        d[4] = s[4]; d[5] = s[5]; d[6] = s[6]; d[7] = s[7];
+        d += 8;
+        s += 8;
+    }
+#endif
+}
+
+/**
+  @brief  Fill whole 64-byte blocks of an 8-byte aligned buffer with STP
+          pairs of a 64-bit pattern.
+
+  @param  d        Destination, 8-byte aligned
+  @param  pattern  Value byte replicated into all 8 bytes
+  @param  blocks   Number of 64-byte blocks, non-zero
+
+  @return None
+**/
+static void libc_set_blocks(uint64_t *d, uint64_t pattern, uint64_t blocks)
+{
+#ifdef __aarch64__
+    __asm__ volatile (
+        "1:\n"
+        "stp %[p], %[p], [%[d]]\n"
+        "stp %[p], %[p], [%[d], #16]\n"
+        "stp %[p], %[p], [%[d], #32]\n"
+        "stp %[p], %[p], [%[d], #48]\n"
+        "add %[d], %[d], #64\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [d] "+r" (d), [n] "+r" (blocks)
+        : [p] "r" (pattern)
+        : "cc", "memory");
+#else
+    while (blocks--) {
+        d[0] = pattern; d[1] = pattern; d[2] = pattern; d[3] = pattern;
+        d[4] = pattern; d[5] = pattern; d[6] = pattern; d[7] = pattern;
+        d += 8;
+    }
+#endif
+}
+
 /**
   @brief  Compare two memory buffers
 
+  Buffers with the same alignment are compared a word at a time and the
+  first differing word is rescanned bytewise, so the result is the same as
+  a plain byte compare.
+
   @param  s1   First buffer
   @param  s2   Second buffer
   @param  len  Number of bytes to compare
@@ -27,10 +115,34 @@
   @return 0  If buffers are identical
   @return Non-zero  If buffers differ
 **/
-int val_memory_compare(void *s1, void *s2, uint32_t len)
+int val_memory_compare(void *s1, void *s2, uint64_t len)
 {
     const unsigned char *p1 = s1;
     const unsigned char *p2 = s2;
+    const uint64_t *w1;
+    const uint64_t *w2;
+
+    if ((len >= LIBC_WORD_THRESHOLD) &&
+        ((((uintptr_t)p1 ^ (uintptr_t)p2) & (LIBC_WORD_SIZE - 1)) == 0)) {
+        while (!LIBC_IS_WORD_ALIGNED(p1)) {
+            if (*p1 != *p2)
+                return (int)(*p1 - *p2);
+            p1++;
+            p2++;
+            len--;
+        }
+
+        w1 = (const uint64_t *)p1;
+        w2 = (const uint64_t *)p2;
+        while ((len >= LIBC_WORD_SIZE) && (*w1 == *w2)) {
+            w1++;
+            w2++;
+            len -= LIBC_WORD_SIZE;
+        }
+
+        p1 = (const unsigned char *)w1;
+        p2 = (const unsigned char *)w2;
+    }
 
     while (len--) {
         if (*p1 != *p2)
@@ -44,16 +156,43 @@ int val_memory_compare(void *s1, void *s2, uint32_t len)
 /**
   @brief  Copy memory from source to destination
 
+  Buffers with the same alignment are copied in 64-byte LDP/STP blocks,
+  with bytewise heads and tails. Other buffers are copied bytewise.
+
   @param  dst  Destination buffer
   @param  src  Source buffer
   @param  len  Number of bytes to copy
 
   @return Pointer to destination buffer
 **/
-void *val_memcpy(void *dst, void *src, uint32_t len)
+void *val_memcpy(void *dst, void *src, uint64_t len)
 {
     const unsigned char *s = src;
     unsigned char *d = dst;
+    uint64_t blocks;
+
+    if ((len >= LIBC_WORD_THRESHOLD) &&
+        ((((uintptr_t)d ^ (uintptr_t)s) & (LIBC_WORD_SIZE - 1)) == 0)) {
+        while (!LIBC_IS_WORD_ALIGNED(d)) {
+            *d++ = *s++;
+            len--;
+        }
+
+        blocks = len / LIBC_BLOCK_SIZE;
+        if (blocks) {
+            libc_copy_blocks((uint64_t *)d, (const uint64_t *)s, blocks);
+            d += blocks * LIBC_BLOCK_SIZE;
+            s += blocks * LIBC_BLOCK_SIZE;
+            len -= blocks * LIBC_BLOCK_SIZE;
+        }
+
+        while (len >= LIBC_WORD_SIZE) {
+            *(uint64_t *)d = *(const uint64_t *)s;
+            d += LIBC_WORD_SIZE;
+            s += LIBC_WORD_SIZE;
+            len -= LIBC_WORD_SIZE;
+        }
+    }
 
     while (len--) {
         *d++ = *s++;
@@ -65,21 +204,94 @@ void *val_memcpy(void *dst, void *src, uint32_t len)
 /**
   @brief  Set memory with a byte value
 
+  Large buffers are filled in 64-byte STP blocks between bytewise head and
+  tail, so the buffer may be Device memory as long as 8-byte accesses are
+  allowed.
+
   @param  dst    Buffer to fill
   @param  value  Byte value to set
   @param  count  Number of bytes to set
 
   @return Pointer to destination buffer
 **/
-void val_memory_set(void *dst, uint32_t size, uint8_t value)
+void val_memory_set(void *dst, uint64_t size, uint8_t value)
 {
     unsigned char *ptr = dst;
+    uint64_t pattern;
+    uint64_t blocks;
+
+    if (size >= LIBC_WORD_THRESHOLD) {
+        while (!LIBC_IS_WORD_ALIGNED(ptr)) {
+            *ptr++ = (unsigned char)value;
+            size--;
+        }
+
+        pattern = (uint64_t)value * 0x0101010101010101ull;
+        blocks = size / LIBC_BLOCK_SIZE;
+        if (blocks) {
+            libc_set_blocks((uint64_t *)ptr, pattern, blocks);
+            ptr += blocks * LIBC_BLOCK_SIZE;
+            size -= blocks * LIBC_BLOCK_SIZE;
+        }
+
+        while (size >= LIBC_WORD_SIZE) {
+            *(uint64_t *)ptr = pattern;
+            ptr += LIBC_WORD_SIZE;
+            size -= LIBC_WORD_SIZE;
+        }
+    }
+
     while (size--)
         *ptr++ = (unsigned char)value;
 
     return (void) dst;
 }
 
+/**
+  @brief  Zero a buffer in Normal memory
+
+  Whole cache-zeroing blocks are cleared with DC ZVA when DCZID_EL0 permits
+  it, the rest falls back to val_memory_set. DC ZVA faults on Device memory,
+  so use val_memory_set for buffers that might be mapped as Device.
+
+  @param  dst   Buffer to zero, in Normal memory
+  @param  size  Number of bytes to zero
+
+  @return None
+**/
+void val_memory_zero(void *dst, uint64_t size)
+{
+#ifdef __aarch64__
+    unsigned char *ptr = dst;
+    uint64_t dczid;
+    uint64_t zva_size;
+    uint64_t head;
+
+    __asm__ volatile ("mrs %0, dczid_el0" : "=r" (dczid));
+    zva_size = 4ull << (dczid & LIBC_DCZID_BS_MASK);
+
+    if ((dczid & LIBC_DCZID_DZP) || (size < 2 * zva_size)) {
+        val_memory_set(dst, size, 0);
+        return;
+    }
+
+    head = (zva_size - ((uintptr_t)ptr & (zva_size - 1))) & (zva_size - 1);
+    val_memory_set(ptr, head, 0);
+    ptr += head;
+    size -= head;
+
+    while (size >= zva_size) {
+        __asm__ volatile ("dc zva, %0" : : "r" (ptr) : "memory");
+        ptr += zva_size;
+        size -= zva_size;
+    }
+
+    val_memory_set(ptr, size, 0);
+#else
+    val_memory_set(dst, size, 0);
+#endif
+}
+
 /**
   @brief  Compare two strings up to given length
 
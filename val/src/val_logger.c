@@ -7,6 +7,10 @@
 
 #include "val_logger.h"
 #include "acs_execution_policy.h"
+#ifdef ACS_PRINT_DEFERRED
+#include "acs_pe.h"
+#include "val_interface.h"
+#endif
 
 enum { LOG_MAX_STRING_LENGTH = 90 };
 enum { LOG_MSG_INDENT = 7 };
@@ -16,6 +20,51 @@ static bool collect_log_output;
 static char collected_log[LOG_MAX_STRING_LENGTH * 2];
 static size_t collected_log_len;
 
+/*
+ * UEFI builds write each record to the console and to the -f log file. File
+ * output is staged in log_sink_buf and written in large blocks, at the
+ * high-water mark, at test boundaries and from the exception path.
+ */
+#if !defined(TARGET_LINUX) && !defined(TARGET_BAREMETAL)
+#define LOG_FILE_SINK
+
+enum { LOG_SINK_SIZE = 16384 };
+enum { LOG_SINK_HIGH_WATER = LOG_SINK_SIZE - sizeof(collected_log) };
+
+static char log_sink_buf[LOG_SINK_SIZE];
+static size_t log_sink_len;
+#endif
+
+/*
+ * ACS_PRINT_DEFERRED builds keep unformatted records: a header word holding
+ * verbosity, argument count, record size and log indent, the format string
+ * address, the raw arguments, then copies of the format string and of every
+ * %s argument. The copies keep records valid after the caller's buffers are
+ * gone, and the string arguments are rewritten to point at them. Records are
+ * formatted in order by val_log_flush() or when the record buffer fills up.
+ * Only the primary PE defers, secondary PEs format their records directly.
+ */
+#ifdef ACS_PRINT_DEFERRED
+enum { LOG_DEFER_WORDS = 4096 };
+enum { LOG_DEFER_HDR_WORDS = 2 };
+
+#define LOG_DEFER_HDR(verbosity, nargs, words, indent)                        \
+    ((uint64_t)(verbosity) | ((uint64_t)(nargs) << 8) |                       \
+     ((uint64_t)(words) << 16) | ((uint64_t)(indent) << 32))
+#define LOG_DEFER_HDR_VERBOSITY(hdr) ((uint32_t)((hdr) & 0xFF))
+#define LOG_DEFER_HDR_NARGS(hdr)     ((uint32_t)(((hdr) >> 8) & 0xFF))
+#define LOG_DEFER_HDR_WORDS_USED(hdr) ((uint32_t)(((hdr) >> 16) & 0xFFFF))
+#define LOG_DEFER_HDR_INDENT(hdr)    ((uint32_t)((hdr) >> 32))
+
+/* Words taken by a copy of len characters and its terminator */
+#define LOG_DEFER_STR_WORDS(len)     ((uint32_t)(((len) + sizeof(uint64_t)) / sizeof(uint64_t)))
+
+extern uint64_t g_primary_mpidr;
+
+static uint64_t log_defer_buf[LOG_DEFER_WORDS];
+static uint32_t log_defer_len;
+#endif
+
 static void val_putc(char c)
 {
     if (collect_log_output) {
@@ -561,6 +610,7 @@ static int val_log(const char *fmt, va_list args)
                 break;
             }
 
+            case 'a':   /* UEFI Print() spelling of an ASCII string */
             case 's': {
                 char *str = va_arg(args, char *);
                 if (str == NULL)
@@ -705,6 +755,235 @@ out:
     return chars_written;
 }
 
+/**
+ *   @brief    - Write out the log records staged for the log file
+ *   @return   - None
+ **/
+
+static void log_sink_write(void)
+{
+#ifdef LOG_FILE_SINK
+    uint32_t status;
+
+    if (log_sink_len == 0)
+        return;
+
+    status = pal_log_file_write((uint64_t)(uintptr_t)log_sink_buf, (uint32_t)log_sink_len);
+    log_sink_len = 0;
+
+    if (status != 0)
+        pal_print_console((uint64_t)(uintptr_t)"\r\n       Error in writing to log file");
+#endif
+}
+
+#ifdef ACS_PRINT_DEFERRED
+/**
+ *   @brief    - Format all deferred records in the order they were logged
+ *   @return   - None
+ **/
+
+static void log_defer_drain(void)
+{
+    uint32_t pos = 0;
+    uint32_t nargs;
+    uint32_t i;
+    uint32_t saved_indent = val_log_get_indent();
+    uint64_t hdr;
+    uint64_t args[VAL_LOG_DEFER_MAX_ARGS];
+
+    while (pos < log_defer_len) {
+        hdr = log_defer_buf[pos];
+        nargs = LOG_DEFER_HDR_NARGS(hdr);
+
+        for (i = 0; i < VAL_LOG_DEFER_MAX_ARGS; i++)
+            args[i] = (i < nargs) ? log_defer_buf[pos + LOG_DEFER_HDR_WORDS + i] : 0;
+
+        /* Records are laid out with the indent that was active when logged */
+        val_log_set_indent(LOG_DEFER_HDR_INDENT(hdr));
+        val_printf((print_verbosity_t)LOG_DEFER_HDR_VERBOSITY(hdr),
+                   (const char *)(uintptr_t)log_defer_buf[pos + 1],
+                   args[0], args[1], args[2], args[3],
+                   args[4], args[5], args[6], args[7]);
+
+        pos += LOG_DEFER_HDR_WORDS_USED(hdr);
+    }
+
+    log_defer_len = 0;
+    val_log_set_indent(saved_indent);
+}
+
+/**
+ *   @brief    - Find the arguments consumed by %s (or %a) conversions of fmt
+ *   @param    - fmt        : Format string
+ *             - len        : Number of characters of fmt to scan
+ *   @return   - Bit n set if argument n is a string
+ **/
+
+static uint32_t log_defer_string_args(const char *fmt, size_t len)
+{
+    const char *end = fmt + len;
+    uint32_t mask = 0;
+    uint32_t arg = 0;
+
+    while ((fmt < end) && (arg < VAL_LOG_DEFER_MAX_ARGS)) {
+        if (*fmt++ != '%')
+            continue;
+
+        while ((fmt < end) && ((*fmt == '-') || (*fmt == '+') || (*fmt == ' ') ||
+                               (*fmt == '#') || (*fmt == '0')))
+            fmt++;
+        if ((fmt < end) && (*fmt == '*')) {
+            arg++;
+            fmt++;
+        }
+        while ((fmt < end) && (*fmt >= '0') && (*fmt <= '9'))
+            fmt++;
+        while ((fmt < end) && ((*fmt == 'h') || (*fmt == 'l') || (*fmt == 'j') ||
+                               (*fmt == 'z') || (*fmt == 't')))
+            fmt++;
+        if ((fmt >= end) || (arg >= VAL_LOG_DEFER_MAX_ARGS))
+            break;
+
+        if ((*fmt == 's') || (*fmt == 'a'))
+            mask |= (1U << arg);
+        if (*fmt != '%')
+            arg++;
+        fmt++;
+    }
+
+    return mask;
+}
+
+/**
+ *   @brief    - Copy len characters of str and a terminator to the record
+ *               buffer at log_defer_len
+ *   @return   - Address of the copy
+ **/
+
+static uint64_t log_defer_copy_string(const char *str, size_t len)
+{
+    char *dst = (char *)&log_defer_buf[log_defer_len];
+
+    val_mem_copy(dst, str, len);
+    dst[len] = '\0';
+    log_defer_len += LOG_DEFER_STR_WORDS(len);
+
+    return (uint64_t)(uintptr_t)dst;
+}
+
+/**
+ *   @brief    - Record a print for formatting at the next flush
+ *   @param    - verbosity  : Print Verbosity level
+ *             - fmt        : Format string, copied into the record
+ *             - nargs      : Number of raw arguments
+ *             - args       : Arguments widened to 64 bits, %s strings are
+ *                            copied into the record
+ *   @return   - None
+ **/
+
+void val_log_defer(uint32_t verbosity, const char *fmt, uint32_t nargs, const uint64_t *args)
+{
+    uint64_t raw[VAL_LOG_DEFER_MAX_ARGS] = {0};
+    size_t str_len[VAL_LOG_DEFER_MAX_ARGS] = {0};
+    size_t fmt_len;
+    uint32_t strings;
+    uint32_t words;
+    uint32_t start;
+    uint32_t i;
+
+    if (fmt == NULL)
+        return;
+
+    if (nargs > VAL_LOG_DEFER_MAX_ARGS)
+        nargs = VAL_LOG_DEFER_MAX_ARGS;
+
+    for (i = 0; i < nargs; i++)
+        raw[i] = args[i];
+
+    /* The record buffer has no lock, so only the primary PE appends to it */
+    if ((g_primary_mpidr != PAL_INVALID_MPID) && (val_pe_get_mpid() != g_primary_mpidr)) {
+        val_printf((print_verbosity_t)verbosity, fmt, raw[0], raw[1], raw[2], raw[3],
+                   raw[4], raw[5], raw[6], raw[7]);
+        return;
+    }
+
+    /* val_printf does not look past LOG_MAX_STRING_LENGTH characters of fmt */
+    fmt_len = log_strnlen_s(fmt, LOG_MAX_STRING_LENGTH);
+    strings = log_defer_string_args(fmt, fmt_len);
+
+    words = LOG_DEFER_HDR_WORDS + nargs + LOG_DEFER_STR_WORDS(fmt_len);
+    for (i = 0; i < nargs; i++) {
+        if ((strings & (1U << i)) && (raw[i] != 0)) {
+            str_len[i] = log_strnlen_s((const char *)(uintptr_t)raw[i],
+                                       sizeof(collected_log) - 1);
+            words += LOG_DEFER_STR_WORDS(str_len[i]);
+        }
+    }
+
+    if (log_defer_len + words > LOG_DEFER_WORDS)
+        log_defer_drain();
+
+    start = log_defer_len;
+    log_defer_len += LOG_DEFER_HDR_WORDS + nargs;
+
+    log_defer_buf[start] = LOG_DEFER_HDR(verbosity, nargs, words, val_log_get_indent());
+    log_defer_buf[start + 1] = log_defer_copy_string(fmt, fmt_len);
+    for (i = 0; i < nargs; i++) {
+        if ((strings & (1U << i)) && (raw[i] != 0))
+            raw[i] = log_defer_copy_string((const char *)(uintptr_t)raw[i], str_len[i]);
+        log_defer_buf[start + LOG_DEFER_HDR_WORDS + i] = raw[i];
+    }
+
+    /* Do not hold back errors behind a possible hang */
+    if (verbosity >= ERROR)
+        val_log_flush();
+}
+#endif
+
+/**
+ *   @brief    - Format any deferred records and write out the log records
+ *               staged for the log file
+ *   @return   - None
+ **/
+
+void val_log_flush(void)
+{
+#ifdef ACS_PRINT_DEFERRED
+    log_defer_drain();
+#endif
+    log_sink_write();
+}
+
+/**
+ *   @brief    - Hand one formatted record to the console and log file sinks
+ *   @param    - verbosity  : Print Verbosity level of the record
+ *   @return   - None
+ **/
+
+static void log_emit_record(print_verbosity_t verbosity)
+{
+#ifdef LOG_FILE_SINK
+    /* Without a log file the console is the only sink and gets every record */
+    if (!pal_log_file_present()) {
+        log_sink_len = 0;
+        pal_print_console((uint64_t)(uintptr_t)collected_log);
+        return;
+    }
+
+    if ((uint32_t)verbosity >= acs_policy_get_console_print_level())
+        pal_print_console((uint64_t)(uintptr_t)collected_log);
+
+    val_mem_copy(log_sink_buf + log_sink_len, collected_log, collected_log_len);
+    log_sink_len += collected_log_len;
+
+    if (log_sink_len >= LOG_SINK_HIGH_WATER || verbosity == FATAL)
+        log_sink_write();
+#else
+    (void)verbosity;
+    pal_print((uint64_t)(uintptr_t)collected_log);
+#endif
+}
+
 /**
  *   @brief    - This function prints the given string and data onto the uart
  *   @param    - verbosity  : Print Verbosity level
@@ -746,7 +1025,7 @@ uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...)
     if (*msg == '\0') {
         collect_log_output = false;
         if (collected_log_len > 0)
-            pal_print((uint64_t)(uintptr_t)collected_log);
+            log_emit_record(verbosity);
         return 0;
     }
 
@@ -847,7 +1126,7 @@ uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...)
     return 0;
 
     if (collected_log_len > 0)
-        pal_print((uint64_t)(uintptr_t)collected_log);
+        log_emit_record(verbosity);
 
     return (uint32_t)chars_written;
 }
@@ -16,6 +16,7 @@
 
 #include "include/val_interface.h"
 #include "include/val_status.h"
+#include "include/acs_common.h"
 #include "val_logger.h"
 
 /* Map shared memory as an array of status records */
@@ -46,6 +47,10 @@ void val_set_status(uint32_t index, uint32_t test_res)
     mem[index].state = (uint8_t)GET_STATE(test_res);
     mem[index].status_code = (uint16_t)GET_CODE(test_res);
     val_data_cache_ops_by_va((addr_t)&mem[index], CLEAN_AND_INVALIDATE);
+
+    /* Wake the primary PE once this slot holds a final result */
+    if (!IS_RESULT_PENDING(test_res))
+        val_pe_completion_signal(index);
 }
 
 /**